@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "arena.h"
+#include <cstdint>
+#include <cstdlib>
+
+thread_local Arena* Arena::active = nullptr;
+
+Arena::Arena(size_t block_size)
+    : block_size(block_size), next(nullptr), end(nullptr), used(0) {}
+
+Arena::~Arena() {
+    reset();
+    for (char* block : blocks) {
+        free(block);
+    }
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    uintptr_t p = ((uintptr_t)next + (align - 1)) & ~(uintptr_t)(align - 1);
+    if (next == nullptr || p + size > (uintptr_t)end) {
+        // Start a new block; oversized requests get a block of their own
+        size_t n = size + align > block_size ? size + align : block_size;
+        char* block = (char*)malloc(n);
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        blocks.push_back(block);
+        next = block;
+        end = block + n;
+        p = ((uintptr_t)next + (align - 1)) & ~(uintptr_t)(align - 1);
+    }
+    next = (char*)(p + size);
+    used += size;
+    return (void*)p;
+}
+
+void Arena::reset() {
+    // Destroy in reverse order of construction
+    for (size_t i = dtors.size(); i > 0; i--) {
+        dtors[i - 1].destroy(dtors[i - 1].obj);
+    }
+    dtors.clear();
+
+    // Keep the first block for reuse
+    for (size_t i = 1; i < blocks.size(); i++) {
+        free(blocks[i]);
+    }
+    if (!blocks.empty()) {
+        blocks.resize(1);
+        next = blocks[0];
+        end = blocks[0] + block_size;
+    }
+    used = 0;
+}
+
+size_t Arena::bytes_used() const {
+    return used;
+}
+
+Arena& Arena::current() {
+    static thread_local Arena fallback;
+    return active ? *active : fallback;
+}
+
+ArenaScope::ArenaScope() : saved(Arena::active) {
+    Arena::active = &own;
+}
+
+ArenaScope::~ArenaScope() {
+    Arena::active = saved;
+}
+
+Arena& ArenaScope::arena() {
+    return own;
+}
@@ -0,0 +1,136 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @class Arena
+ * @brief A bump allocator that frees everything it allocated at once.
+ *
+ * Used by the USE_ARENA_POINTERS mode of pointer.h: NEW(T) places the object
+ * in the current arena and PTR(T) is a plain pointer, so building a tree costs
+ * a pointer bump per node and no reference counting. Destructors of objects
+ * that need one (strings, vectors) run when the arena is reset or destroyed.
+ */
+class Arena {
+public:
+    /**
+     * @brief Creates an empty arena.
+     * @param block_size Size of each block requested from the system allocator.
+     */
+    explicit Arena(size_t block_size = 64 * 1024);
+
+    /**
+     * @brief Destroys every object in the arena and releases its memory.
+     */
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * @brief Returns uninitialized memory from the arena.
+     * @param size Number of bytes needed.
+     * @param align Required alignment (a power of two).
+     */
+    void* allocate(size_t size, size_t align);
+
+    /**
+     * @brief Constructs a T in the arena.
+     *
+     * If T is not trivially destructible, its destructor is remembered
+     * and run by reset().
+     */
+    template<class T, class... Args>
+    T* create(Args&&... args) {
+        T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            dtors.push_back(Dtor{obj, [](void* p) { static_cast<T*>(p)->~T(); }});
+        }
+        return obj;
+    }
+
+    /**
+     * @brief Destroys every object in the arena and frees all but the first block.
+     */
+    void reset();
+
+    /**
+     * @brief Number of bytes handed out since the last reset.
+     */
+    size_t bytes_used() const;
+
+    /**
+     * @brief The arena NEW(T) allocates from on this thread.
+     *
+     * That is the innermost live ArenaScope, or a per-thread default arena
+     * that lives until the thread exits.
+     */
+    static Arena& current();
+
+private:
+    friend class ArenaScope;
+
+    struct Dtor {
+        void* obj;
+        void (*destroy)(void*);
+    };
+
+    size_t block_size;
+    std::vector<char*> blocks;
+    char* next;
+    char* end;
+    size_t used;
+    std::vector<Dtor> dtors;
+
+    static thread_local Arena* active;
+};
+
+/**
+ * @class ArenaScope
+ * @brief Makes a fresh arena current for the lifetime of the scope.
+ *
+ * Everything created with NEW(T) inside the scope (in arena mode) is
+ * freed in one shot when the scope ends.
+ */
+class ArenaScope {
+public:
+    ArenaScope();
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    /**
+     * @brief The arena owned by this scope.
+     */
+    Arena& arena();
+
+private:
+    Arena own;
+    Arena* saved;
+};
+
+/**
+ * @brief Constructs a T in the current arena (NEW(T) in arena mode).
+ */
+template<class T, class... Args>
+T* arena_new(Args&&... args) {
+    return Arena::current().create<T>(std::forward<Args>(args)...);
+}
+
+#endif // ARENA_H
@@ -0,0 +1,116 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "batch.h"
+#include "parse.hpp"
+#include "env.h"
+#include "pointer.h"
+#include "thread_pool.h"
+#if USE_ARENA_POINTERS
+#include "arena.h"
+#endif
+#include <stdexcept>
+#include <vector>
+
+// Lines read per chunk and thread in parallel mode
+static const size_t lines_per_job = 1024;
+
+static bool is_blank(std::string_view s) {
+    return s.find_first_not_of(" \t\n\v\f\r") == std::string_view::npos;
+}
+
+// Splits a line into its ';'-separated, non-blank expressions
+static void split(std::string_view line, std::vector<std::string_view>& exprs) {
+    while (true) {
+        size_t end = line.find(';');
+        std::string_view expr = line.substr(0, end);
+        if (!is_blank(expr)) {
+            exprs.push_back(expr);
+        }
+        if (end == std::string_view::npos) {
+            return;
+        }
+        line.remove_prefix(end + 1);
+    }
+}
+
+bool batch_eval(std::string_view src, std::string& out) {
+#if USE_ARENA_POINTERS
+    ArenaScope scope; // Free each expression's tree and values before the next one
+#endif
+    try {
+        out += parse(src)->interp(Env::empty)->to_string();
+        out += '\n';
+        return true;
+    } catch (const std::exception& e) {
+        out += "Error: ";
+        out += e.what();
+        out += '\n';
+        return false;
+    }
+}
+
+static int run_serial(std::istream& in, std::ostream& out) {
+    int failures = 0;
+    std::string line;
+    std::string result;
+    std::vector<std::string_view> exprs;
+    while (std::getline(in, line)) {
+        exprs.clear();
+        split(line, exprs);
+        for (std::string_view expr : exprs) {
+            result.clear();
+            if (!batch_eval(expr, result)) {
+                failures++;
+            }
+            out << result;
+        }
+    }
+    return failures;
+}
+
+static int run_parallel(std::istream& in, std::ostream& out, int jobs) {
+    ThreadPool pool(jobs);
+    const size_t chunk = lines_per_job * pool.size();
+
+    int failures = 0;
+    std::vector<std::string> lines(chunk);
+    std::vector<std::string_view> exprs;
+    std::vector<std::string> results;
+    std::vector<char> ok;
+
+    while (in) {
+        size_t n = 0;
+        while (n < chunk && std::getline(in, lines[n])) {
+            n++;
+        }
+
+        exprs.clear();
+        for (size_t i = 0; i < n; i++) {
+            split(lines[i], exprs);
+        }
+        results.assign(exprs.size(), std::string());
+        ok.assign(exprs.size(), 0);
+
+        pool.parallel_for(exprs.size(), [&](size_t i) {
+            ok[i] = batch_eval(exprs[i], results[i]);
+        });
+
+        for (size_t i = 0; i < exprs.size(); i++) {
+            out << results[i];
+            failures += !ok[i];
+        }
+    }
+    return failures;
+}
+
+int run_batch(std::istream& in, std::ostream& out, int jobs) {
+    return jobs > 1 ? run_parallel(in, out, jobs) : run_serial(in, out);
+}
@@ -0,0 +1,50 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Parses and interprets one expression and appends its result line.
+ *
+ * Appends the value's to_string(), or "Error: " followed by the message if
+ * parsing or interpretation throws, and a newline. Safe to call from
+ * several threads at once.
+ *
+ * @param src The expression's source text.
+ * @param out The string the result line is appended to.
+ * @return true if the expression produced a value.
+ */
+bool batch_eval(std::string_view src, std::string& out);
+
+/**
+ * @brief Evaluates every expression in a stream, in order (--batch).
+ *
+ * Expressions are separated by newlines or by ';'. Blank expressions are
+ * skipped. Input is read one line at a time into a reused buffer, so
+ * memory use does not grow with the size of the input.
+ *
+ * With more than one job, input is read in chunks whose expressions are
+ * parsed and interpreted on a ThreadPool; results are still written in
+ * input order.
+ *
+ * @param in The expressions.
+ * @param out Receives one result or error line per expression.
+ * @param jobs Number of threads to evaluate with (--jobs).
+ * @return The number of expressions that failed.
+ */
+int run_batch(std::istream& in, std::ostream& out, int jobs = 1);
+
+#endif // BATCH_H
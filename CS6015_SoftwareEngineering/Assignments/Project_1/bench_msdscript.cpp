@@ -0,0 +1,579 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "expr.h"
+#include "val.h"
+#include "env.h"
+#include "parse.hpp"
+#include "pointer.h"
+#include "vm.h"
+#include "resolve.h"
+#include "lexer.h"
+#include "hashcons.h"
+#include "memo.h"
+#include "bignum.h"
+#include "program.h"
+#include "encode.h"
+#include "optimize.h"
+#include "exec.h"
+#include "exec_pool.h"
+#if USE_ARENA_POINTERS
+#include "arena.h"
+#endif
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h> // For access()
+
+// Runs `body` `reps` times and prints the average time per run in microseconds.
+static double time_it(const std::string& label, int reps, const std::function<void()>& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) {
+        body();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / reps;
+    std::cout << "  " << label << ": " << us << " us/run\n";
+    return us;
+}
+
+// _let f = _fun (x) x * 2 + 1 _in f(f(f(...f(0)...))) with `n` calls
+static PTR(Expr) call_chain(int n) {
+    PTR(Expr) body = NEW(NumExpr)(0);
+    for (int i = 0; i < n; i++) {
+        body = NEW(CallExpr)(NEW(VarExpr)("f"), body);
+    }
+    PTR(Expr) f = NEW(FunExpr)("x", NEW(AddExpr)(NEW(MultExpr)(NEW(VarExpr)("x"), NEW(NumExpr)(2)),
+                                                 NEW(NumExpr)(1)));
+    return NEW(LetExpr)("f", f, body);
+}
+
+// a * b + a * b + ... + c (`n` products) under a few _let bindings
+static PTR(Expr) arithmetic(int n) {
+    PTR(Expr) e = NEW(VarExpr)("c");
+    for (int i = 0; i < n; i++) {
+        e = NEW(AddExpr)(NEW(MultExpr)(NEW(VarExpr)("a"), NEW(VarExpr)("b")), e);
+    }
+    return NEW(LetExpr)("a", NEW(NumExpr)(1),
+           NEW(LetExpr)("b", NEW(NumExpr)(1),
+           NEW(LetExpr)("c", NEW(NumExpr)(0), e)));
+}
+
+// Compares tree-walking Expr::interp against the bytecode VM
+static void bench_vm() {
+    std::cout << "interp vs. bytecode VM\n";
+
+    struct { const char* name; PTR(Expr) e; } cases[] = {
+        { "arithmetic (10000 terms)", arithmetic(10000) },
+        { "call chain (20 calls)",    call_chain(20) },
+    };
+
+    for (auto& c : cases) {
+        std::cout << " " << c.name << "\n";
+        const int reps = 200;
+        PTR(Expr) e = c.e;
+        double tree = time_it("interp        ", reps, [&] { e->interp(Env::empty); });
+        double vm = time_it("compile + VM  ", reps, [&] { vm_interp(e); });
+        PTR(Bytecode) code = Compiler::compile(e);
+        double run = time_it("VM only       ", reps, [&] { VM::run(code); });
+        std::cout << "  speedup: " << tree / vm << "x (" << tree / run << "x precompiled)\n";
+    }
+}
+
+// _let x0 = 1 _in _let x1 = x0 + x0 _in _let x2 = x1 + x0 _in ... _in x<n-1>
+// Every binding reaches back to x0, so lookup by name is quadratic in n.
+static PTR(Expr) let_chain(int n) {
+    PTR(Expr) e = NEW(VarExpr)("x" + std::to_string(n - 1));
+    for (int i = n - 1; i >= 1; i--) {
+        e = NEW(LetExpr)("x" + std::to_string(i),
+                         NEW(AddExpr)(NEW(VarExpr)("x" + std::to_string(i - 1)), NEW(VarExpr)("x0")), e);
+    }
+    return NEW(LetExpr)("x0", NEW(NumExpr)(1), e);
+}
+
+// Compares name lookup through ExtendedEnv chains against resolved frames
+static void bench_frames() {
+    std::cout << "ExtendedEnv name lookup vs. resolved frames\n";
+
+    for (int n : {100, 1000, 5000}) {
+        std::cout << " _let chain of " << n << "\n";
+        const int reps = 20;
+        PTR(Expr) plain = let_chain(n);
+        PTR(Expr) resolved = let_chain(n);
+        Resolver::resolve(resolved);
+        double by_name = time_it("by name       ", reps, [&] { plain->interp(Env::empty); });
+        double by_slot = time_it("by slot       ", reps, [&] { resolved->interp(Env::empty); });
+        std::cout << "  speedup: " << by_name / by_slot << "x\n";
+    }
+}
+
+#if USE_ARENA_POINTERS
+static const char* pointer_mode = "arena";
+typedef ArenaScope PointerScope; // Frees everything allocated inside it at once
+#elif USE_PLAIN_POINTERS
+static const char* pointer_mode = "plain";
+struct PointerScope {};          // Plain pointers are never freed
+#else
+static const char* pointer_mode = "shared_ptr";
+struct PointerScope {};          // shared_ptr frees trees by reference count
+#endif
+
+// A balanced tree of additions over (x*1) leaves with 2^(depth+1) - 1 nodes
+static std::string balanced(int depth) {
+    if (depth <= 1) {
+        return "(x*1)";
+    }
+    std::string half = balanced(depth - 1);
+    return "(" + half + "+" + half + ")";
+}
+
+// Parse and interp throughput for the pointer mode this binary was built with
+static void bench_pointers() {
+    std::cout << "parse/interp with " << pointer_mode << " pointers\n";
+
+    const int depth = 19;
+    const double nodes = (double)((1 << (depth + 1)) - 1) + 3; // Plus the _let and its rhs
+    const std::string src = "_let x = 1 _in " + balanced(depth);
+    const int reps = 3;
+
+    double parse_us = time_it("parse + free  ", reps, [&] {
+        PointerScope scope;
+        (void)scope;
+        parse_str(src);
+    });
+
+    PointerScope tree_scope;
+    (void)tree_scope;
+    PTR(Expr) e = parse_str(src);
+    double interp_us = time_it("interp        ", reps, [&] {
+        PointerScope scope;
+        (void)scope;
+        e->interp(Env::empty);
+    });
+
+    std::cout << "  parse:  " << nodes / parse_us << " Mnodes/s\n";
+    std::cout << "  interp: " << nodes / interp_us << " Mnodes/s\n";
+}
+
+// A balanced tree of `op` nodes over (x * 3 + leaf_add) leaves, with x bound to 1
+static PTR(Expr) value_tree(int depth, bool mult, int leaf_add) {
+    if (depth <= 1) {
+        return NEW(AddExpr)(NEW(MultExpr)(NEW(VarExpr)("x"), NEW(NumExpr)(3)), NEW(NumExpr)(leaf_add));
+    }
+    PTR(Expr) half = value_tree(depth - 1, mult, leaf_add);
+    if (mult) {
+        return NEW(MultExpr)(half, value_tree(depth - 1, mult, leaf_add));
+    }
+    return NEW(AddExpr)(half, value_tree(depth - 1, mult, leaf_add));
+}
+
+// Arithmetic whose intermediate values stay inside the NumVal::make table
+// versus arithmetic whose values are all outside it
+static void bench_values() {
+    std::cout << "preallocated vs. allocated NumVals\n";
+
+    const int depth = 16;
+    const int reps = 20;
+    PTR(Expr) small = NEW(LetExpr)("x", NEW(NumExpr)(1), value_tree(depth, true, -2));
+    PTR(Expr) large = NEW(LetExpr)("x", NEW(NumExpr)(1), value_tree(depth, false, 1997));
+    Resolver::resolve(small);
+    Resolver::resolve(large);
+    double small_us = time_it("small values  ", reps, [&] { small->interp(Env::empty); });
+    double large_us = time_it("large values  ", reps, [&] { large->interp(Env::empty); });
+    std::cout << "  allocation-free speedup: " << large_us / small_us << "x\n";
+}
+
+// A machine-generated script: a balanced tree of additions whose leaves use
+// every kind of token, about 2^depth * 23 bytes long
+static std::string script(int depth, int leaf) {
+    if (depth <= 1) {
+        std::string n = std::to_string(leaf);
+        return leaf % 2 ? "(_let y = x * " + n + " _in y + -1)"
+                        : "(_if x == " + n + " _then _fun (z) z _else _false)(y)";
+    }
+    return "(" + script(depth - 1, 2 * leaf) + "\n+ " + script(depth - 1, 2 * leaf + 1) + ")";
+}
+
+// Parse throughput in MB/s on a multi-megabyte script
+static void bench_parse() {
+    std::cout << "parse throughput\n";
+
+    const std::string src = "_let x = 1 _in _let y = 2 _in " + script(17, 1);
+    const double mb = src.size() / 1e6;
+    const int reps = 5;
+    std::cout << " script of " << mb << " MB\n";
+
+    double lex_us = time_it("tokenize only ", reps, [&] {
+        Lexer lex(src);
+        while (lex.peek().kind != tok_eof) {
+            lex.next();
+        }
+    });
+    double view_us = time_it("parse(buffer) ", reps, [&] {
+        PointerScope scope;
+        (void)scope;
+        parse(std::string_view(src));
+    });
+    double stream_us = time_it("parse(istream)", reps, [&] {
+        PointerScope scope;
+        (void)scope;
+        std::stringstream ss(src);
+        parse(ss);
+    });
+
+    std::cout << "  tokenize:       " << mb / lex_us * 1e6 << " MB/s\n";
+    std::cout << "  parse(buffer):  " << mb / view_us * 1e6 << " MB/s\n";
+    std::cout << "  parse(istream): " << mb / stream_us * 1e6 << " MB/s\n";
+}
+
+// Calls per second for deep recursion: a tail-recursive countdown and a
+// non-tail recursive sum, on the VM and (within its depth limit) the tree-walker
+static void bench_recursion() {
+    std::cout << "deep recursion\n";
+
+    const std::string countdown = "_let loop = _fun (f) _fun (n) _if n == 0 _then 0 _else f(f)(n + -1)"
+                                  " _in loop(loop)(";
+    const std::string sum = "_let sum = _fun (f) _fun (n) _if n == 0 _then 0 _else n + f(f)(n + -1)"
+                            " _in sum(sum)(";
+
+    // Each level makes two calls: f(f) and the call it returns
+    struct { const char* name; std::string program; int levels; bool tree; } cases[] = {
+        { "VM, tail calls, depth 1000000", countdown + "1000000)", 1000000, false },
+        { "VM, non-tail, depth 60000",     sum + "60000)",         60000,   false },
+        { "interp, non-tail, depth 4000",  sum + "4000)",          4000,    true },
+        { "VM, non-tail, depth 4000",      sum + "4000)",          4000,    false },
+    };
+
+    for (auto& c : cases) {
+        std::cout << " " << c.name << "\n";
+        PTR(Expr) e = parse_str(c.program);
+        const int reps = 5;
+        double us = c.tree ? time_it("run           ", reps, [&] { e->interp(Env::empty); })
+                           : time_it("run           ", reps, [&] { vm_interp(e); });
+        std::cout << "  " << 2.0 * c.levels / us << " Mcalls/s\n";
+    }
+}
+
+// equals() on two copies of a large, repetitive tree, with and without hash-consing
+static void bench_hashcons() {
+    std::cout << "structural vs. hash-consed equals\n";
+
+    const int depth = 18;
+    const std::string src = "_let x = 1 _in " + balanced(depth);
+    const double nodes = (double)((1 << (depth + 1)) - 1) + 3;
+    PTR(Expr) a = parse_str(src);
+    PTR(Expr) b = parse_str(src);
+    const int reps = 5;
+
+    double structural = time_it("structural    ", reps, [&] { a->equals(b); });
+    ExprInterner in;
+    PTR(Expr) ia;
+    PTR(Expr) ib;
+    time_it("intern        ", 1, [&] { ia = in.intern(a); ib = in.intern(b); });
+    double interned = time_it("interned      ", reps, [&] { ia->equals(ib); });
+    std::cout << "  speedup: " << structural / interned << "x\n";
+    std::cout << "  nodes: " << nodes << " per tree, " << in.size() << " interned for both\n";
+}
+
+// Printing throughput in MB/s for --print and --pretty-print on multi-megabyte output.
+// Pretty-printed indentation grows with nesting, so that tree is smaller.
+static void bench_print() {
+    std::cout << "print throughput\n";
+
+    PTR(Expr) flat_tree = parse_str("_let x = 1 _in _let y = 2 _in " + script(17, 1));
+    PTR(Expr) pretty_tree = parse_str("_let x = 1 _in _let y = 2 _in " + script(11, 1));
+    const int reps = 5;
+
+    size_t flat = 0, pretty = 0;
+    double flat_us = time_it("to_string       ", reps, [&] { flat = flat_tree->to_string().size(); });
+    double pretty_us = time_it("to_pretty_string", reps, [&] { pretty = pretty_tree->to_pretty_string().size(); });
+
+    std::cout << "  to_string:        " << flat / flat_us << " MB/s (" << flat / 1e6 << " MB)\n";
+    std::cout << "  to_pretty_string: " << pretty / pretty_us << " MB/s (" << pretty / 1e6 << " MB)\n";
+}
+
+// Naive recursive fib with and without --memoize: exponential vs. linear calls
+static void bench_memoize() {
+    std::cout << "memoized calls\n";
+
+    const std::string fib = "_let fib = _fun (f) _fun (n) _if n == 0 _then 0 _else _if n == 1 _then 1"
+                            " _else f(f)(n + -1) + f(f)(n + -2) _in fib(fib)(";
+    PTR(Expr) small = parse_str(fib + "22)");
+    PTR(Expr) large = parse_str(fib + "40)");
+    const int reps = 5;
+
+    double plain = time_it("fib(22)       ", reps, [&] { small->interp(Env::empty); });
+    CallCache::enable(true);
+    double memo = time_it("fib(22) memo  ", reps, [&] { CallCache::enable(true); small->interp(Env::empty); });
+    time_it("fib(40) memo  ", reps, [&] { CallCache::enable(true); large->interp(Env::empty); });
+    CallCache* cache = CallCache::current();
+    std::cout << "  speedup at 22: " << plain / memo << "x\n";
+    std::cout << "  fib(40): " << cache->hits() << " hits, " << cache->misses() << " misses\n";
+    CallCache::enable(false);
+}
+
+// --bignum: the cost of its overflow checks on int arithmetic, a factorial that
+// outgrows every machine integer, and schoolbook vs. Karatsuba multiplication
+static void bench_bignum() {
+    std::cout << "big numbers\n";
+
+    PTR(Expr) ints = NEW(LetExpr)("x", NEW(NumExpr)(1), value_tree(16, false, 1997));
+    Resolver::resolve(ints);
+    const int reps = 20;
+    double off = time_it("ints          ", reps, [&] { ints->interp(Env::empty); });
+    BigInt::enabled = true;
+    double on = time_it("ints --bignum ", reps, [&] { ints->interp(Env::empty); });
+    std::cout << "  --bignum overhead on ints: " << (on / off - 1) * 100 << "%\n";
+
+    PTR(Expr) factorial = parse_str("_let f = _fun (f) _fun (n) _if n == 0 _then 1 _else n * f(f)(n + -1)"
+                                    " _in f(f)(2000)");
+    size_t digits = 0;
+    time_it("2000!         ", 5, [&] { digits = factorial->interp(Env::empty)->to_string().size(); });
+    std::cout << "  2000! has " << digits << " digits\n";
+    BigInt::enabled = false;
+
+    const size_t karatsuba = BigInt::karatsuba_limbs;
+    for (int n : {30, 300, 3000, 30000}) {
+        // n-digit operands, about n / 9.6 limbs each
+        BigInt a = BigInt::parse(std::string(n, '7'));
+        BigInt b = BigInt::parse("-" + std::string(n, '3'));
+        int times = n >= 30000 ? 1 : 20;
+        std::cout << " " << n << " digits (" << a.limbs() << " limbs)\n";
+        BigInt::karatsuba_limbs = SIZE_MAX;
+        double school = time_it("schoolbook    ", times, [&] { a * b; });
+        BigInt::karatsuba_limbs = karatsuba;
+        double kara = time_it("karatsuba     ", times, [&] { a * b; });
+        std::cout << "  speedup: " << school / kara << "x\n";
+    }
+}
+
+// One program evaluated many times in-process through Program, versus spawning
+// ./msdscript --interp for every evaluation as a service forking it would
+static void bench_embed() {
+    std::cout << "embedded Program vs. exec_program\n";
+
+    const std::string source = "_let sq = _fun (v) v * v _in sq(x) + sq(y)";
+    Program program(source, {"x", "y"});
+    int i = 0;
+    double in_process = time_it("Program::run  ", 100000, [&] {
+        program.run_to_string({i, i + 1});
+        i = (i + 1) % 1000;
+    });
+
+    if (access("./msdscript", X_OK) != 0) {
+        std::cout << "  (build ./msdscript to compare with spawning it)\n";
+        return;
+    }
+    const char* const command[] = {"./msdscript", "--interp"};
+    double spawned = time_it("exec_program  ", 100, [&] {
+        exec_program(2, command, "_let x = 3 _in _let y = 4 _in " + source);
+    });
+    std::cout << "  in-process speedup: " << spawned / in_process << "x\n";
+}
+
+// Per-call latency of running ./msdscript through exec_program (a fork and
+// exec per call) and through an ExecPool of workers
+static void bench_pool() {
+    std::cout << "exec_program vs. ExecPool\n";
+
+    if (access("./msdscript", X_OK) != 0) {
+        std::cout << "  (build ./msdscript to time running it)\n";
+        return;
+    }
+    const std::string source = "_let sq = _fun (v) v * v _in sq(3) + sq(4)";
+    const char* const interp[] = {"./msdscript", "--interp"};
+    const char* const print[] = {"./msdscript", "--pretty-print"};
+    const int reps = 200;
+    double spawned = time_it("exec_program  ", reps, [&] { exec_program(2, interp, source); });
+    ExecPool pool("./msdscript", 2);
+    double pooled = time_it("ExecPool::run ", reps, [&] { pool.run(2, interp, source); });
+    std::cout << "  per-call speedup: " << spawned / pooled << "x\n";
+
+    // test_msdscript's comparison runs three modes of two executables per expression
+    double spawned6 = time_it("6 spawned     ", reps / 4, [&] {
+        for (int i = 0; i < 3; i++) {
+            exec_program(2, interp, source);
+            exec_program(2, print, source);
+        }
+    });
+    double pooled6 = time_it("6 pooled      ", reps / 4, [&] {
+        for (int i = 0; i < 3; i++) {
+            pool.run(2, interp, source);
+            pool.run(2, print, source);
+        }
+    });
+    std::cout << "  per-expression speedup: " << spawned6 / pooled6 << "x\n";
+}
+
+// Loading a program written by --compile (--run) versus parsing and
+// optimizing its source (--interp)
+static void bench_compile() {
+    std::cout << "compiled programs\n";
+
+    // x and y are unknown, so optimizing leaves most of the script in place
+    const std::string src = "_fun (x) _fun (y) " + script(17, 1);
+    std::string bytes;
+    {
+        PointerScope scope;
+        (void)scope;
+        bytes = Encoder::encode(Optimizer::optimize(parse(std::string_view(src))));
+    }
+    std::cout << " script of " << src.size() / 1e6 << " MB, compiled to " << bytes.size() / 1e6 << " MB\n";
+
+    const int reps = 5;
+    double parse_us = time_it("parse + optimize", reps, [&] {
+        PointerScope scope;
+        (void)scope;
+        Optimizer::optimize(parse(std::string_view(src)));
+    });
+    double decode_us = time_it("decode          ", reps, [&] {
+        PointerScope scope;
+        (void)scope;
+        Decoder(bytes).decode();
+    });
+    std::cout << "  load speedup: " << parse_us / decode_us << "x\n";
+}
+
+// The tree-walker on scripts dominated by checking the type of a value or
+// a subexpression: arithmetic, conditionals, and equals() on values and trees
+static void bench_dispatch() {
+    std::cout << "type dispatch\n";
+
+    const int reps = 20;
+    PTR(Expr) sums = NEW(LetExpr)("x", NEW(NumExpr)(1), value_tree(16, true, -2));
+    Resolver::resolve(sums);
+    time_it("arithmetic    ", reps, [&] { sums->interp(Env::empty); });
+
+    PTR(Expr) countdown = parse_str("_let loop = _fun (f) _fun (n) _if n == 0 _then 0 _else f(f)(n + -1)"
+                                    " _in loop(loop)(1000)");
+    time_it("conditionals  ", reps * 50, [&] { countdown->interp(Env::empty); });
+
+    PTR(Val) a = NumVal::make(7);
+    PTR(Val) b = NumVal::make(7);
+    PTR(Val) t = BoolVal::make(true);
+    time_it("Val::equals   ", reps, [&] {
+        for (int i = 0; i < 1000000; i++) {
+            a->equals(b);
+            a->equals(t);
+        }
+    });
+
+    PTR(Expr) x = parse_str("_let x = 1 _in " + balanced(17));
+    PTR(Expr) y = parse_str("_let x = 1 _in " + balanced(17));
+    time_it("Expr::equals  ", 5, [&] { x->equals(y); });
+}
+
+// Calls of a closure created five functions deep whose body mostly reads
+// variables bound outside all of them, and the cost of creating closures
+static void bench_closures() {
+    std::cout << "closures\n";
+
+    std::string sum = "t";
+    for (int i = 0; i < 100; i++) {
+        sum = "a + b + " + sum;
+    }
+    PTR(Expr) make = parse_str("_let a = 1 _in _let b = 2 _in _let k = _fun (p) _fun (q) _fun (r) _fun (s) _fun (t) "
+                               + sum + " _in k(1)(2)(3)(4)");
+    PTR(Val) inner = make->interp(Env::empty);
+    PTR(Val) arg = NumVal::make(1);
+    const int calls = 20000;
+    double us = time_it("outer reads   ", 5, [&] {
+        for (int i = 0; i < calls; i++) {
+            inner->call(arg);
+        }
+    });
+    std::cout << "  " << calls * 201.0 / us << " Mreads/s\n";
+
+    PTR(Expr) adders = parse_str("_let n = 5 _in _let add = _fun (x) _fun (y) x + y + n"
+                                 " _in _let loop = _fun (f) _fun (i) _if i == 0 _then 0"
+                                 " _else add(i)(1) + f(f)(i + -1) _in loop(loop)(1000)");
+    time_it("create        ", 200, [&] { adders->interp(Env::empty); });
+}
+
+// Scripts dominated by variables with long names: looking them up by name,
+// parsing them, and comparing trees full of them
+static void bench_symbols() {
+    std::cout << "symbols\n";
+
+    const int n = 200;
+    // Names may only hold letters, so the number is spelled in letters too
+    auto letters = [](int i) {
+        std::string s;
+        do {
+            s += (char)('a' + i % 26);
+            i /= 26;
+        } while (i > 0);
+        return s;
+    };
+    std::string names;
+    std::string sum = "0";
+    for (int i = 0; i < n; i++) {
+        std::string name = "variablenumber" + letters(i);
+        names += "_let " + name + " = " + std::to_string(i) + " _in ";
+        sum = name + " + " + sum;
+    }
+    std::string src = names + sum;
+    for (int i = 0; i < 5; i++) {
+        src = "_let outer" + letters(i) + " = 1 _in " + src;
+    }
+
+    const int reps = 200;
+    std::stringstream in(src);
+    PTR(Expr) by_name = parse_expr(in); // Not resolved, so every variable is looked up by name
+    double lookup_us = time_it("name lookup   ", reps, [&] { by_name->interp(Env::empty); });
+    std::cout << "  " << n * reps / lookup_us << " Mlookups/s\n";
+
+    time_it("parse         ", reps, [&] {
+        PointerScope scope;
+        (void)scope;
+        parse_str(src);
+    });
+
+    PTR(Expr) other = parse_str(src);
+    Resolver::resolve(by_name);
+    time_it("Expr::equals  ", reps * 10, [&] { by_name->equals(other); });
+
+    std::cout << "  sizeof VarExpr " << sizeof(VarExpr) << ", LetExpr " << sizeof(LetExpr)
+              << ", ExtendedEnv " << sizeof(ExtendedEnv) << " bytes\n";
+}
+
+int main(int argc, char* argv[]) {
+    // With no arguments every benchmark runs; otherwise only the named ones.
+    auto wanted = [&](const char* name) {
+        if (argc < 2) return true;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], name) == 0) return true;
+        }
+        return false;
+    };
+
+    if (wanted("vm")) bench_vm();
+    if (wanted("frames")) bench_frames();
+    if (wanted("pointers")) bench_pointers();
+    if (wanted("values")) bench_values();
+    if (wanted("parse")) bench_parse();
+    if (wanted("recursion")) bench_recursion();
+    if (wanted("hashcons")) bench_hashcons();
+    if (wanted("print")) bench_print();
+    if (wanted("memoize")) bench_memoize();
+    if (wanted("bignum")) bench_bignum();
+    if (wanted("embed")) bench_embed();
+    if (wanted("pool")) bench_pool();
+    if (wanted("compile")) bench_compile();
+    if (wanted("dispatch")) bench_dispatch();
+    if (wanted("closures")) bench_closures();
+    if (wanted("symbols")) bench_symbols();
+
+    return 0;
+}
@@ -0,0 +1,312 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "bignum.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <stdexcept>
+
+bool BigInt::enabled = false;
+
+size_t BigInt::karatsuba_limbs = 48;
+
+// ====================== Magnitudes ======================
+// Unsigned limb arrays, least significant limb first, without leading zero limbs.
+
+typedef std::vector<uint32_t> Mag;
+
+static void trim(Mag& a) {
+    while (!a.empty() && a.back() == 0) {
+        a.pop_back();
+    }
+}
+
+static int compare(const Mag& a, const Mag& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i > 0; i--) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+static Mag add(const Mag& a, const Mag& b) {
+    const Mag& longer = a.size() >= b.size() ? a : b;
+    const Mag& shorter = a.size() >= b.size() ? b : a;
+    Mag sum(longer.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < longer.size(); i++) {
+        carry += (uint64_t)longer[i] + (i < shorter.size() ? shorter[i] : 0);
+        sum[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    sum[longer.size()] = (uint32_t)carry;
+    trim(sum);
+    return sum;
+}
+
+// a -= b, where a >= b
+static void subtract(Mag& a, const Mag& b) {
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        int64_t d = (int64_t)a[i] - (i < b.size() ? b[i] : 0) - borrow;
+        borrow = d < 0;
+        a[i] = (uint32_t)(d + (borrow << 32));
+        if (i >= b.size() && !borrow) {
+            break;
+        }
+    }
+    trim(a);
+}
+
+// r += x * base^shift; r must have room for the sum
+static void add_shifted(Mag& r, const Mag& x, size_t shift) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < x.size(); i++) {
+        carry += (uint64_t)r[shift + i] + x[i];
+        r[shift + i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    for (size_t k = shift + i; carry; k++) {
+        carry += r[k];
+        r[k] = (uint32_t)carry;
+        carry >>= 32;
+    }
+}
+
+static Mag schoolbook(const Mag& a, const Mag& b) {
+    Mag r(a.size() + b.size());
+    for (size_t i = 0; i < a.size(); i++) {
+        uint64_t carry = 0;
+        uint64_t ai = a[i];
+        for (size_t j = 0; j < b.size(); j++) {
+            carry += ai * b[j] + r[i + j];
+            r[i + j] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        r[i + b.size()] = (uint32_t)carry;
+    }
+    trim(r);
+    return r;
+}
+
+static Mag slice(const Mag& a, size_t from, size_t to) {
+    to = std::min(to, a.size());
+    Mag s(a.begin() + std::min(from, to), a.begin() + to);
+    trim(s);
+    return s;
+}
+
+static Mag multiply(const Mag& a, const Mag& b) {
+    if (a.empty() || b.empty()) {
+        return Mag();
+    }
+    if (a.size() < BigInt::karatsuba_limbs || b.size() < BigInt::karatsuba_limbs) {
+        return schoolbook(a, b);
+    }
+
+    Mag r(a.size() + b.size() + 1);
+    size_t m = std::max(a.size(), b.size()) / 2;
+    if (a.size() <= m || b.size() <= m) {
+        // Lopsided operands: multiply the short one by slices of the long one as long as it
+        const Mag& shorter = a.size() < b.size() ? a : b;
+        const Mag& longer = a.size() < b.size() ? b : a;
+        for (size_t i = 0; i < longer.size(); i += shorter.size()) {
+            add_shifted(r, multiply(shorter, slice(longer, i, i + shorter.size())), i);
+        }
+        trim(r);
+        return r;
+    }
+
+    // a*b = z2*base^2m + z1*base^m + z0, with three half-size products instead of four
+    Mag a0 = slice(a, 0, m), a1 = slice(a, m, a.size());
+    Mag b0 = slice(b, 0, m), b1 = slice(b, m, b.size());
+    Mag z0 = multiply(a0, b0);
+    Mag z2 = multiply(a1, b1);
+    Mag z1 = multiply(add(a0, a1), add(b0, b1));
+    subtract(z1, z0);
+    subtract(z1, z2);
+    add_shifted(r, z0, 0);
+    add_shifted(r, z1, m);
+    add_shifted(r, z2, 2 * m);
+    trim(r);
+    return r;
+}
+
+// ====================== BigInt ======================
+
+BigInt::BigInt(int64_t n) : small(n), negative(false) {}
+
+BigInt BigInt::from_mag(bool negative, Mag mag) {
+    trim(mag);
+    if (mag.size() <= 2) {
+        uint64_t u = mag.empty() ? 0 : mag[0];
+        if (mag.size() == 2) {
+            u |= (uint64_t)mag[1] << 32;
+        }
+        if (u <= (uint64_t)INT64_MAX) {
+            return BigInt(negative ? -(int64_t)u : (int64_t)u);
+        }
+        if (negative && u == (uint64_t)INT64_MAX + 1) {
+            return BigInt(INT64_MIN);
+        }
+    }
+    BigInt b;
+    b.negative = negative;
+    b.mag = std::move(mag);
+    return b;
+}
+
+void BigInt::to_mag(bool& neg, Mag& out) const {
+    if (!mag.empty()) {
+        neg = negative;
+        out = mag;
+        return;
+    }
+    neg = small < 0;
+    uint64_t u = neg ? 0 - (uint64_t)small : (uint64_t)small;
+    out.clear();
+    if (u != 0) {
+        out.push_back((uint32_t)u);
+        if (u >> 32) {
+            out.push_back((uint32_t)(u >> 32));
+        }
+    }
+}
+
+BigInt BigInt::parse(std::string_view text) {
+    size_t i = 0;
+    bool neg = !text.empty() && text[0] == '-';
+    if (neg) {
+        i++;
+    }
+    if (i == text.size()) {
+        throw std::runtime_error("invalid input");
+    }
+    Mag m;
+    while (i < text.size()) {
+        // Nine digits at a time: m = m * 10^9 + chunk
+        uint32_t chunk = 0, scale = 1;
+        for (size_t k = 0; k < 9 && i < text.size(); k++, i++) {
+            if (text[i] < '0' || text[i] > '9') {
+                throw std::runtime_error("invalid input");
+            }
+            chunk = chunk * 10 + (text[i] - '0');
+            scale *= 10;
+        }
+        uint64_t carry = chunk;
+        for (uint32_t& limb : m) {
+            carry += (uint64_t)limb * scale;
+            limb = (uint32_t)carry;
+            carry >>= 32;
+        }
+        if (carry) {
+            m.push_back((uint32_t)carry);
+        }
+    }
+    return from_mag(neg, std::move(m));
+}
+
+BigInt BigInt::operator+(const BigInt& other) const {
+    int64_t r;
+    if (mag.empty() && other.mag.empty() && !__builtin_add_overflow(small, other.small, &r)) {
+        return BigInt(r);
+    }
+    bool na, nb;
+    Mag a, b;
+    to_mag(na, a);
+    other.to_mag(nb, b);
+    if (na == nb) {
+        return from_mag(na, add(a, b));
+    }
+    // Opposite signs: the larger magnitude wins
+    if (compare(a, b) >= 0) {
+        subtract(a, b);
+        return from_mag(na, std::move(a));
+    }
+    subtract(b, a);
+    return from_mag(nb, std::move(b));
+}
+
+BigInt BigInt::operator*(const BigInt& other) const {
+    int64_t r;
+    if (mag.empty() && other.mag.empty() && !__builtin_mul_overflow(small, other.small, &r)) {
+        return BigInt(r);
+    }
+    bool na, nb;
+    Mag a, b;
+    to_mag(na, a);
+    other.to_mag(nb, b);
+    return from_mag(na != nb, multiply(a, b));
+}
+
+bool BigInt::operator==(const BigInt& other) const {
+    // Both sides are normalized, so a value has only one representation
+    if (mag.empty() || other.mag.empty()) {
+        return mag.empty() && other.mag.empty() && small == other.small;
+    }
+    return negative == other.negative && mag == other.mag;
+}
+
+bool BigInt::operator!=(const BigInt& other) const {
+    return !(*this == other);
+}
+
+bool BigInt::fits_int() const {
+    return mag.empty() && small >= INT_MIN && small <= INT_MAX;
+}
+
+int BigInt::to_int() const {
+    return (int)small;
+}
+
+size_t BigInt::limbs() const {
+    return mag.size();
+}
+
+std::string BigInt::to_string() const {
+    if (mag.empty()) {
+        return std::to_string(small);
+    }
+    // Divide by 10^9 repeatedly, collecting nine digits at a time
+    Mag m = mag;
+    std::vector<uint32_t> chunks;
+    while (!m.empty()) {
+        uint64_t rem = 0;
+        for (size_t i = m.size(); i > 0; i--) {
+            uint64_t cur = (rem << 32) | m[i - 1];
+            m[i - 1] = (uint32_t)(cur / 1000000000);
+            rem = cur % 1000000000;
+        }
+        chunks.push_back((uint32_t)rem);
+        trim(m);
+    }
+    std::string s = negative ? "-" : "";
+    s += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i > 0; i--) {
+        std::string digits = std::to_string(chunks[i - 1]);
+        s.append(9 - digits.size(), '0');
+        s += digits;
+    }
+    return s;
+}
+
+size_t BigInt::hash() const {
+    size_t h = std::hash<int64_t>()(small) ^ (negative ? 0x9e3779b97f4a7c15ULL : 0);
+    for (uint32_t limb : mag) {
+        h = h * 1099511628211ULL ^ limb;
+    }
+    return h;
+}
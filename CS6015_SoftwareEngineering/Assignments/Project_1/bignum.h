@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class BigInt
+ * @brief An arbitrary-precision integer for the --bignum numeric mode.
+ *
+ * A value that fits in 64 bits is kept inline and added or multiplied with
+ * one overflow-checked machine instruction. Only a result that overflows is
+ * promoted to a sign and an array of 32-bit limbs, and a limb result that
+ * fits in 64 bits again is demoted, so each value has one representation.
+ *
+ * Limb arrays are multiplied by schoolbook multiplication, or by Karatsuba
+ * once both operands have at least karatsuba_limbs limbs.
+ */
+class BigInt {
+public:
+    /**
+     * @brief Creates an integer from a machine integer.
+     */
+    BigInt(int64_t n = 0);
+
+    /**
+     * @brief Reads a decimal literal.
+     * @param text Digits, optionally preceded by '-'.
+     * @throws std::runtime_error("invalid input") if text is not such a literal.
+     */
+    static BigInt parse(std::string_view text);
+
+    BigInt operator+(const BigInt& other) const;
+    BigInt operator*(const BigInt& other) const;
+    bool operator==(const BigInt& other) const;
+    bool operator!=(const BigInt& other) const;
+
+    /**
+     * @brief Checks whether the value fits in an int.
+     */
+    bool fits_int() const;
+
+    /**
+     * @brief The value as an int; only meaningful if fits_int().
+     */
+    int to_int() const;
+
+    /**
+     * @brief Number of 32-bit limbs, or 0 for a value held inline.
+     */
+    size_t limbs() const;
+
+    /**
+     * @brief The value in decimal, with a leading '-' if negative.
+     */
+    std::string to_string() const;
+
+    /**
+     * @brief A hash of the value, equal for equal values.
+     */
+    size_t hash() const;
+
+    /**
+     * @brief Whether numbers may grow past an int (--bignum).
+     *
+     * When false, the lexer rejects larger literals and arithmetic throws
+     * "arithmetic overflow", as before this mode existed. Set once by main
+     * before any thread starts, like FunVal::max_depth.
+     */
+    static bool enabled;
+
+    /**
+     * @brief Smallest operand size, in limbs, multiplied by Karatsuba.
+     *
+     * Below it schoolbook multiplication is faster; setting it very high
+     * turns Karatsuba off (used by the benchmarks to compare the two).
+     */
+    static size_t karatsuba_limbs;
+
+private:
+    typedef std::vector<uint32_t> Mag;
+
+    int64_t small;  // The value, when mag is empty
+    bool negative;  // Sign of a limb value
+    Mag mag;        // Magnitude, least significant limb first; empty when held inline
+
+    static BigInt from_mag(bool negative, Mag mag);
+    void to_mag(bool& neg, Mag& out) const;
+};
+
+#endif // BIGNUM_H
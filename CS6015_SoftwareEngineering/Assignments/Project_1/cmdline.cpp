@@ -12,33 +12,101 @@
 #include <iostream>
 #include <cstdlib> // For exit()
 
-run_mode_t use_arguments(int argc, char **argv) {
-    // Check if the number of arguments is not equal to 2.
-    // The program expects exactly 2 arguments: the program name and a flag.
-    if (argc != 2) {
-        // Print an error message to standard error if the number of arguments is incorrect.
-        std::cerr << "Usage: msdscript [--test | --interp | --print | --pretty-print]\n";
-        // Exit the program with a non-zero status code (1) to indicate an error.
-        exit(1);
+// Prints the usage message and exits with a non-zero status code.
+static void usage() {
+    // Print an error message to standard error if the arguments are incorrect.
+    std::cerr << "Usage: msdscript [--test | --interp | --interp-vm | --print | --pretty-print | --optimize | --compile | --run <file>"
+                 " | --batch [file] [--jobs N] | --serve <socket> [--jobs N] | --worker] [--max-depth N] [--memoize] [--bignum]"
+                 " [--profile | --profile-json]\n";
+    // Exit the program with a non-zero status code (1) to indicate an error.
+    exit(1);
+}
+
+options_t use_arguments(int argc, char **argv) {
+    // Check that a flag was given.
+    // The program expects at least 2 arguments: the program name and a flag.
+    // The interpreting modes may be followed by --max-depth N, --interp,
+    // --run, --batch and --serve by --memoize, every mode but --test and
+    // --interp-vm by --bignum, --batch and --serve by --jobs N, and --batch
+    // also by an input file. --serve needs the path of its socket and --run
+    // the compiled program's file. --interp and --run may be profiled.
+    // --worker takes nothing: each request carries its own arguments.
+    if (argc < 2) {
+        usage();
     }
 
     // Extract the second argument (the flag) from the argv array.
     // argv[0] is the program name, and argv[1] is the flag.
     std::string flag = argv[1];
 
-    // Check the value of the flag and return the corresponding run mode.
+    options_t options;
+    options.mode = do_nothing;
+    options.jobs = 1;
+    options.max_depth = 0;
+    options.memoize = false;
+    options.bignum = false;
+    options.profile = profile_off;
+
+    // Check the value of the flag and select the corresponding run mode.
     if (flag == "--test") {
-        return do_test; // If the flag is "--test", return do_test to indicate test mode.
+        options.mode = do_test; // If the flag is "--test", select do_test to indicate test mode.
     } else if (flag == "--interp") {
-        return do_interp; // If the flag is "--interp", return do_interp to indicate interpretation mode.
+        options.mode = do_interp; // If the flag is "--interp", select do_interp to indicate interpretation mode.
+    } else if (flag == "--interp-vm") {
+        options.mode = do_interp_vm; // If the flag is "--interp-vm", select do_interp_vm to interpret on the bytecode VM.
     } else if (flag == "--print") {
-        return do_print; // If the flag is "--print", return do_print to indicate print mode.
+        options.mode = do_print; // If the flag is "--print", select do_print to indicate print mode.
     } else if (flag == "--pretty-print") {
-        return do_pretty_print; // If the flag is "--pretty-print", return do_pretty_print to indicate pretty-print mode.
+        options.mode = do_pretty_print; // If the flag is "--pretty-print", select do_pretty_print to indicate pretty-print mode.
+    } else if (flag == "--optimize") {
+        options.mode = do_optimize; // If the flag is "--optimize", select do_optimize to print the constant-folded expression.
+    } else if (flag == "--batch") {
+        options.mode = do_batch; // If the flag is "--batch", select do_batch to evaluate many expressions.
+    } else if (flag == "--serve" && argc > 2) {
+        options.mode = do_serve; // If the flag is "--serve", select do_serve to evaluate expressions sent to a socket.
+        options.socket_path = argv[2];
+    } else if (flag == "--compile") {
+        options.mode = do_compile; // If the flag is "--compile", select do_compile to write the parsed program in binary.
+    } else if (flag == "--run" && argc > 2) {
+        options.mode = do_run; // If the flag is "--run", select do_run to interpret a program written by --compile.
+        options.program_file = argv[2];
+    } else if (flag == "--worker") {
+        options.mode = do_worker; // If the flag is "--worker", select do_worker to serve an ExecPool on standard input and output.
     } else {
         // If the flag is not recognized, print an error message to standard error.
-        std::cerr << "Invalid flag. Use --test, --interp, --print, or --pretty-print\n";
+        std::cerr << "Invalid flag. Use --test, --interp, --interp-vm, --print, --pretty-print, --optimize, --compile, --run <file>, --batch, or --serve <socket>\n";
         // Exit the program with a non-zero status code (1) to indicate an error.
         exit(1);
     }
+
+    // Check the arguments that follow the flag.
+    bool interprets = options.mode == do_interp || options.mode == do_interp_vm || options.mode == do_batch ||
+                      options.mode == do_serve || options.mode == do_run;
+    bool serves_many = options.mode == do_batch || options.mode == do_serve;
+    for (int i = options.mode == do_serve || options.mode == do_run ? 3 : 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--max-depth" && interprets && i + 1 < argc) {
+            options.max_depth = atoi(argv[++i]); // Allow this many nested calls.
+            if (options.max_depth < 1) {
+                usage();
+            }
+        } else if (arg == "--memoize" && (options.mode == do_interp || options.mode == do_run || serves_many)) {
+            options.memoize = true; // Cache calls of the tree-walking interpreter.
+        } else if (arg == "--bignum" && options.mode != do_test && options.mode != do_interp_vm && options.mode != do_worker) {
+            options.bignum = true; // Read and compute integers of any size.
+        } else if ((arg == "--profile" || arg == "--profile-json") && (options.mode == do_interp || options.mode == do_run)) {
+            options.profile = arg == "--profile" ? profile_text : profile_json; // Report where evaluation spent its time.
+        } else if (arg == "--jobs" && serves_many && i + 1 < argc) {
+            options.jobs = atoi(argv[++i]); // Evaluate on this many threads.
+            if (options.jobs < 1) {
+                usage();
+            }
+        } else if (options.mode == do_batch && options.batch_file.empty() && arg.compare(0, 2, "--") != 0) {
+            options.batch_file = arg; // Read the expressions from this file instead of standard input.
+        } else {
+            usage();
+        }
+    }
+
+    return options;
 }
\ No newline at end of file
@@ -21,10 +21,42 @@ typedef enum {
     do_nothing,
     do_test,
     do_interp,
+    do_interp_vm,
     do_print,
-    do_pretty_print
+    do_pretty_print,
+    do_optimize,
+    do_batch,
+    do_serve,
+    do_compile,
+    do_run,
+    do_worker
 } run_mode_t;
 
+/**
+ * @brief Whether and how --interp and --run report a profile (see profile.h).
+ */
+typedef enum {
+    profile_off,
+    profile_text, ///< --profile: a table on standard error.
+    profile_json  ///< --profile-json: a JSON object on standard error.
+} profile_t;
+
+/**
+ * @struct options_t
+ * @brief Everything selected on the command line.
+ */
+typedef struct {
+    run_mode_t mode;        ///< What to do.
+    std::string batch_file; ///< Input file for --batch; empty means standard input.
+    std::string socket_path; ///< Socket for --serve.
+    std::string program_file; ///< Compiled program for --run (written by --compile).
+    int jobs;               ///< Threads for --batch and --serve (--jobs N); 1 unless given.
+    int max_depth;          ///< Nested call limit (--max-depth N); 0 keeps the defaults.
+    bool memoize;           ///< Cache pure function calls (--memoize, with --interp, --run, --batch or --serve).
+    bool bignum;            ///< Let numbers grow past an int (--bignum, not with --interp-vm).
+    profile_t profile;      ///< Profile the evaluation (--profile or --profile-json, with --interp or --run).
+} options_t;
+
 /**
  * @brief Parses command-line arguments and returns the corresponding run mode.
  *
@@ -34,10 +66,12 @@ typedef enum {
  *
  * @param argc The number of command-line arguments.
  * @param argv An array of C-style strings representing the command-line arguments.
- * @return A run_mode_t value indicating the mode of operation (e.g., do_test, do_interp, etc.).
+ * @return The selected options: the mode of operation (e.g., do_test, do_interp, etc.),
+ *         --max-depth, --memoize, --bignum, --profile, for --batch the optional input file and number of jobs,
+ *         for --serve the socket path and number of jobs, and for --run the compiled program.
  *
  * @throws std::runtime_error If the number of arguments is incorrect or the flag is invalid.
  */
-run_mode_t use_arguments(int argc, char **argv);
+options_t use_arguments(int argc, char **argv);
 
 #endif // CMDLINE_H
\ No newline at end of file
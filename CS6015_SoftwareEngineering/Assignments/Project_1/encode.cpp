@@ -0,0 +1,293 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "encode.h"
+#include "bignum.h"
+#include "resolve.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char magic[4] = {'M', 'S', 'D', 'C'};
+static const uint8_t flag_bignum = 1;
+
+static std::runtime_error bad_program() {
+    return std::runtime_error("bad compiled program");
+}
+
+// ====================== Encoder ======================
+
+std::string Encoder::encode(PTR(Expr) const& e) {
+    Encoder en;
+    en.pending.push_back(&*e);
+    while (!en.pending.empty()) {
+        Expr* next = en.pending.back();
+        en.pending.pop_back();
+        size_t mark = en.pending.size();
+        next->encode(en);
+        // Scheduled in order, so the first subexpression must come off the stack first
+        std::reverse(en.pending.begin() + mark, en.pending.end());
+    }
+
+    std::string out(magic, sizeof magic);
+    out += (char)Decoder::version;
+    out += (char)(BigInt::enabled ? flag_bignum : 0);
+    put_varint(out, en.names.size());
+    for (Symbol s : en.names) {
+        const std::string& n = s.str();
+        put_varint(out, n.size());
+        out += n;
+    }
+    out += en.body;
+    return out;
+}
+
+void Encoder::kind(node_t k) {
+    put_varint(body, (uint64_t)k);
+}
+
+void Encoder::number(int n) {
+    // Zigzag, so small negative numbers stay short
+    uint32_t u = (uint32_t)n;
+    put_varint(body, (u << 1) ^ (n < 0 ? 0xffffffffu : 0u));
+}
+
+void Encoder::text(std::string_view s) {
+    put_varint(body, s.size());
+    body.append(s.data(), s.size());
+}
+
+void Encoder::name(Symbol s) {
+    auto found = index.emplace(s, names.size());
+    if (found.second) {
+        names.push_back(s);
+    }
+    put_varint(body, found.first->second);
+}
+
+void Encoder::visit(PTR(Expr) const& e) {
+    pending.push_back(&*e);
+}
+
+void Encoder::put_varint(std::string& out, uint64_t n) {
+    while (n >= 0x80) {
+        out += (char)(n | 0x80);
+        n >>= 7;
+    }
+    out += (char)n;
+}
+
+// ====================== Decoder ======================
+
+bool Decoder::is_compiled(std::string_view data) {
+    return data.size() >= sizeof magic && std::memcmp(data.data(), magic, sizeof magic) == 0;
+}
+
+Decoder::Decoder(std::string_view data) : data(data), pos(sizeof magic + 2), flags(0) {
+    if (!is_compiled(data) || data.size() < pos || (uint8_t)data[4] != version) {
+        throw bad_program();
+    }
+    flags = (uint8_t)data[5];
+    uint64_t count = varint();
+    if (count > data.size()) { // Each name takes at least its length byte
+        throw bad_program();
+    }
+    names.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        names.emplace_back(text());
+    }
+}
+
+bool Decoder::bignum() const {
+    return (flags & flag_bignum) != 0;
+}
+
+uint64_t Decoder::varint() {
+    uint64_t n = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos >= data.size()) {
+            throw bad_program();
+        }
+        uint8_t b = (uint8_t)data[pos++];
+        n |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return n;
+        }
+    }
+    throw bad_program();
+}
+
+int Decoder::number() {
+    uint64_t u = varint();
+    if (u > 0xffffffffu) {
+        throw bad_program();
+    }
+    return (int)((uint32_t)(u >> 1) ^ (u & 1 ? 0xffffffffu : 0u));
+}
+
+std::string_view Decoder::text() {
+    uint64_t n = varint();
+    if (n > data.size() - pos) {
+        throw bad_program();
+    }
+    std::string_view s = data.substr(pos, n);
+    pos += n;
+    return s;
+}
+
+Symbol Decoder::name() {
+    uint64_t i = varint();
+    if (i >= names.size()) {
+        throw bad_program();
+    }
+    return names[i];
+}
+
+PTR(Expr) Decoder::decode() {
+    // A node whose subexpressions are still being read
+    struct Pending {
+        node_t kind;
+        Symbol name;
+        int need;
+        int have;
+        PTR(Expr) sub[3];
+    };
+    std::vector<Pending> pending;
+    PTR(Expr) e;
+
+    while (true) {
+        uint64_t k = varint();
+        switch (k) {
+            case node_num:
+                e = NEW(NumExpr)(number());
+                break;
+            case node_big_num: {
+                std::string_view digits = text();
+                if (digits.empty()) {
+                    throw bad_program();
+                }
+                e = NEW(BigNumExpr)(BigInt::parse(digits));
+                break;
+            }
+            case node_var:
+                e = NEW(VarExpr)(name());
+                break;
+            case node_true:
+            case node_false:
+                e = NEW(BoolExpr)(k == node_true);
+                break;
+            case node_add:
+            case node_mult:
+            case node_eq:
+            case node_call:
+                pending.push_back(Pending{(node_t)k, Symbol(), 2, 0, {}});
+                continue;
+            case node_if:
+                pending.push_back(Pending{(node_t)k, Symbol(), 3, 0, {}});
+                continue;
+            case node_let:
+                pending.push_back(Pending{(node_t)k, name(), 2, 0, {}});
+                continue;
+            case node_fun:
+                pending.push_back(Pending{(node_t)k, name(), 1, 0, {}});
+                continue;
+            case node_fun_folded:
+                pending.push_back(Pending{(node_t)k, name(), 2, 0, {}});
+                continue;
+            default:
+                throw bad_program();
+        }
+
+        // e is complete: hand it to the node waiting for it, finishing every node it completes
+        while (!pending.empty()) {
+            Pending& p = pending.back();
+            p.sub[p.have++] = e;
+            if (p.have < p.need) {
+                break;
+            }
+            switch (p.kind) {
+                case node_add:
+                    e = NEW(AddExpr)(p.sub[0], p.sub[1]);
+                    break;
+                case node_mult:
+                    e = NEW(MultExpr)(p.sub[0], p.sub[1]);
+                    break;
+                case node_eq:
+                    e = NEW(EqExpr)(p.sub[0], p.sub[1]);
+                    break;
+                case node_call:
+                    e = NEW(CallExpr)(p.sub[0], p.sub[1]);
+                    break;
+                case node_if:
+                    e = NEW(IfExpr)(p.sub[0], p.sub[1], p.sub[2]);
+                    break;
+                case node_let:
+                    e = NEW(LetExpr)(p.name, p.sub[0], p.sub[1]);
+                    break;
+                case node_fun:
+                    e = NEW(FunExpr)(p.name, p.sub[0]);
+                    break;
+                default:
+                    e = NEW(FunExpr)(p.name, p.sub[0], 0, p.sub[1]);
+                    break;
+            }
+            pending.pop_back();
+        }
+        if (pending.empty()) {
+            break;
+        }
+    }
+
+    if (pos != data.size()) {
+        throw bad_program();
+    }
+    Resolver::resolve(e);
+    return e;
+}
+
+PTR(Expr) Decoder::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+        std::string why = std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error("cannot open " + path + ": " + why);
+    }
+    size_t size = (size_t)st.st_size;
+    if (size == 0) {
+        ::close(fd);
+        throw bad_program();
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping stays valid without the descriptor
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + path + ": " + std::strerror(errno));
+    }
+
+    try {
+        Decoder d(std::string_view((const char*)mapped, size));
+        if (d.bignum()) {
+            BigInt::enabled = true;
+        }
+        PTR(Expr) e = d.decode(); // Names and digits are copied out of the mapping
+        ::munmap(mapped, size);
+        return e;
+    } catch (...) {
+        ::munmap(mapped, size);
+        throw;
+    }
+}
@@ -0,0 +1,168 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ENCODE_H
+#define ENCODE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "pointer.h"
+#include "symbol.h"
+#include "expr.h"
+
+/**
+ * @brief Kinds of node in a compiled program, as written to the file.
+ */
+typedef enum {
+    node_num,
+    node_big_num,
+    node_add,
+    node_mult,
+    node_var,
+    node_let,
+    node_true,
+    node_false,
+    node_if,
+    node_eq,
+    node_fun,
+    node_fun_folded,
+    node_call
+} node_t;
+
+/**
+ * @class Encoder
+ * @brief Writes an expression as a compiled program (--compile).
+ *
+ * A compiled program is a header, a table of the variable names it uses,
+ * and its tree in prefix order. The header is "MSDC", a version byte and a
+ * flags byte (bit 0: compiled with --bignum). Each name appears once in the
+ * table, as a length and its bytes; a node refers to it by index. A node is
+ * its node_t and then its fields: a number for NumExpr, the digits for
+ * BigNumExpr, a name index for VarExpr, LetExpr and FunExpr, then its
+ * subexpressions. Lengths, indexes and kinds are unsigned LEB128 varints and
+ * numbers are zigzag varints, so most nodes take one or two bytes.
+ *
+ * Each expression's encode() writes its own fields and schedules its
+ * subexpressions with visit(); the Encoder writes them afterwards from an
+ * explicit stack, so tree depth is limited by memory, not the thread stack.
+ *
+ * --compile writes the optimized tree (see optimize.h), so --run skips the
+ * optimizer as well as the parser. A function whose body was changed by
+ * optimizing is written as node_fun_folded, with the body as written after
+ * the optimized one, since function values compare by the body as written.
+ */
+class Encoder {
+public:
+    /**
+     * @brief Encodes a whole program.
+     * @param e The expression; resolved or not.
+     * @return The compiled program's bytes.
+     */
+    static std::string encode(PTR(Expr) const& e);
+
+    /**
+     * @brief Writes a node's kind.
+     */
+    void kind(node_t k);
+
+    /**
+     * @brief Writes a number field.
+     */
+    void number(int n);
+
+    /**
+     * @brief Writes a text field, as its length and its bytes.
+     */
+    void text(std::string_view s);
+
+    /**
+     * @brief Writes a variable name field, as its index in the name table.
+     */
+    void name(Symbol s);
+
+    /**
+     * @brief Schedules a subexpression, to be written after the fields of this node.
+     */
+    void visit(PTR(Expr) const& e);
+
+    /**
+     * @brief Appends an unsigned LEB128 varint.
+     */
+    static void put_varint(std::string& out, uint64_t n);
+
+private:
+    std::string body;                           // Encoded nodes
+    std::vector<Symbol> names;                  // Name table, in index order
+    std::unordered_map<Symbol, uint64_t> index; // Index of each name in names
+    std::vector<Expr*> pending;                 // Scheduled subexpressions, next one last
+};
+
+/**
+ * @class Decoder
+ * @brief Rebuilds an expression from a compiled program (--run).
+ *
+ * The tree is rebuilt with an explicit stack, without the lexer or parser.
+ * Every read is bounds checked, so a truncated or corrupt file is reported
+ * rather than read past.
+ */
+class Decoder {
+public:
+    /**
+     * @brief Reads the header and name table of a compiled program.
+     * @param data The program's bytes; they must outlive the Decoder.
+     * @throws std::runtime_error "bad compiled program" if they are not one.
+     */
+    explicit Decoder(std::string_view data);
+
+    /**
+     * @brief Whether the program was compiled with --bignum.
+     */
+    bool bignum() const;
+
+    /**
+     * @brief Rebuilds the program's expression, resolved as parse() leaves it.
+     * @throws std::runtime_error "bad compiled program" if the tree is malformed.
+     */
+    PTR(Expr) decode();
+
+    /**
+     * @brief Maps a compiled program file into memory and rebuilds its expression.
+     *
+     * A program compiled with --bignum turns BigInt::enabled on, since its
+     * arithmetic depends on it.
+     *
+     * @param path The file written by --compile.
+     * @throws std::runtime_error if the file cannot be read or is not a compiled program.
+     */
+    static PTR(Expr) load(const std::string& path);
+
+    /**
+     * @brief Checks whether bytes start like a compiled program.
+     */
+    static bool is_compiled(std::string_view data);
+
+    static const uint8_t version = 1; ///< Format version written by Encoder.
+
+private:
+    std::string_view data;
+    size_t pos;
+    uint8_t flags;
+    std::vector<Symbol> names;
+
+    uint64_t varint();
+    int number();
+    std::string_view text();
+    Symbol name();
+};
+
+#endif // ENCODE_H
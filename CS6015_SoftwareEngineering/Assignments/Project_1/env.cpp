@@ -5,18 +5,67 @@
 #include "env.h"
 #include <stdexcept>
 
-PTR(Env) Env::empty = NEW(EmptyEnv)();
+// Every interp starts from Env::empty, so it is a static object without a
+// reference count; otherwise threads running --jobs would all contend on
+// the same shared_ptr control block.
+static EmptyEnv empty_env;
+PTR(Env) Env::empty = UNOWNED(Env)(&empty_env);
 
-PTR(Val) EmptyEnv::lookup(std::string find_name) {
-    throw std::runtime_error("Free variable: " + find_name);
+PTR(Val) Env::lookup_at(int depth, int slot, Symbol name) {
+    (void)depth;
+    (void)slot;
+    return lookup(name);
 }
 
-ExtendedEnv::ExtendedEnv(std::string name, PTR(Val) val, PTR(Env) rest)
+void Env::bind(int slot, PTR(Val) val) {
+    (void)slot;
+    (void)val;
+    throw std::runtime_error("_let binding outside of a frame");
+}
+
+PTR(Env) Env::by_name() {
+    return THIS;
+}
+
+PTR(Val) EmptyEnv::lookup(Symbol find_name) {
+    throw std::runtime_error("Free variable: " + find_name.str());
+}
+
+PTR(Env) EmptyEnv::by_name() {
+    return Env::empty; // Not created by NEW, so it has no owner for THIS
+}
+
+ExtendedEnv::ExtendedEnv(Symbol name, PTR(Val) val, PTR(Env) rest)
     : name(name), val(val), rest(rest) {}
 
-PTR(Val) ExtendedEnv::lookup(std::string find_name) {
+PTR(Val) ExtendedEnv::lookup(Symbol find_name) {
     if (find_name == name) {
         return val;
     }
     return rest->lookup(find_name);
-}
\ No newline at end of file
+}
+FrameEnv::FrameEnv(int size, PTR(Env) rest, PTR(Val) closure)
+    : slots(size), rest(rest), closure(closure) {}
+
+PTR(Val) FrameEnv::lookup(Symbol find_name) {
+    return rest->lookup(find_name);
+}
+
+PTR(Val) FrameEnv::lookup_at(int depth, int slot, Symbol name) {
+    if (depth == 0) {
+        return slots[slot];
+    }
+    PTR(Val) captured;
+    if (depth == 1 && closure && static_cast<FunVal*>(&*closure)->captured_at(slot, captured)) {
+        return captured;
+    }
+    return rest->lookup_at(depth - 1, slot, name);
+}
+
+void FrameEnv::bind(int slot, PTR(Val) val) {
+    slots[slot] = val;
+}
+
+PTR(Env) FrameEnv::by_name() {
+    return rest->by_name();
+}
@@ -6,9 +6,11 @@
 #define ENV_H
 
 #include <string>
+#include <vector>
 #include <stdexcept> // For std::runtime_error
 #include <sstream>   // For std::stringstream
 #include "pointer.h"
+#include "symbol.h"
 #include "val.h"
 #include "parse.hpp"
 #include "expr.h"
@@ -16,25 +18,67 @@
 CLASS(Env) {
     public:
     virtual ~Env() = default;
-    virtual PTR(Val) lookup(std::string find_name) = 0;
+    virtual PTR(Val) lookup(Symbol find_name) = 0;
+
+    /**
+     * @brief Looks up a variable that the Resolver mapped to a frame slot.
+     *
+     * Frames skip `depth` links and index `slot`; any other environment
+     * falls back to lookup(name).
+     */
+    virtual PTR(Val) lookup_at(int depth, int slot, Symbol name);
+
+    /**
+     * @brief Stores a value into a slot of this frame.
+     * @throws std::runtime_error if this environment is not a frame.
+     */
+    virtual void bind(int slot, PTR(Val) val);
+
+    /**
+     * @brief The environment that lookup() by name searches.
+     *
+     * Frames pass names straight through, so this skips them; it is what a
+     * resolved closure keeps for its unresolved variables.
+     */
+    virtual PTR(Env) by_name();
 
     static PTR(Env) empty;
 };
 
 class EmptyEnv : public Env {
 public:
-    PTR(Val) lookup(std::string find_name) override;
+    PTR(Val) lookup(Symbol find_name) override;
+    PTR(Env) by_name() override;
 };
 
 class ExtendedEnv : public Env {
-    std::string name;
+    Symbol name;
     PTR(Val) val;
     PTR(Env) rest;
 public:
-    ExtendedEnv(std::string name, PTR(Val) val, PTR(Env) rest);
-    PTR(Val) lookup(std::string find_name) override;
+    ExtendedEnv(Symbol name, PTR(Val) val, PTR(Env) rest);
+    PTR(Val) lookup(Symbol find_name) override;
 };
 
-
+/**
+ * @class FrameEnv
+ * @brief A flat frame of slots for one function call (or top-level _let).
+ *
+ * Slot values are only reachable through lookup_at; lookup by name passes
+ * straight through to the enclosing environment, because a name that the
+ * Resolver could not bind is free in every frame. In a call's frame,
+ * depth 1 is the called FunVal's captured variables (see Resolver).
+ */
+class FrameEnv : public Env {
+    std::vector<PTR(Val)> slots;
+    PTR(Env) rest;
+    PTR(Val) closure; // The FunVal being called, or null for a _let's frame
+public:
+    FrameEnv(int size, PTR(Env) rest, PTR(Val) closure = nullptr);
+    PTR(Val) lookup(Symbol find_name) override;
+    PTR(Val) lookup_at(int depth, int slot, Symbol name) override;
+    void bind(int slot, PTR(Val) val) override;
+    PTR(Env) by_name() override;
+};
 
 #endif //ENV_H
@@ -1,11 +1,15 @@
 #include <string>
 #include <iostream>
 #include <cassert>
+#include <csignal>    // signal, to ignore SIGPIPE
+#include <cstring>    // strlen
+#include <stdexcept>  // std::runtime_error
 
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <errno.h>
+#include <sys/wait.h> // waitpid
 
 #include "exec.h"
 
@@ -198,7 +202,7 @@ static void pump_from(int fd, std::string &str, bool &done) {
       } else {
         ssize_t old_len = str.length();
         str.insert(old_len, buffer, len);
-        assert(str.length() == old_len + len);
+        assert(str.length() == (size_t)(old_len + len));
       }
     }
   }
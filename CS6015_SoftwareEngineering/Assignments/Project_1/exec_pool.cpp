@@ -0,0 +1,315 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "exec_pool.h"
+#include <cerrno>
+#include <cstdint>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/mman.h> // For memfd_create
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+static const char* const hello = "msdscript-worker 1";
+static const int hello_timeout_ms = 2000; // How long a starting worker may take to answer
+
+// ====================== Frames ======================
+
+static bool write_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += w;
+        n -= w;
+    }
+    return true;
+}
+
+// Reads exactly n bytes; false on an error or if the other end closed first
+static bool read_all(int fd, char* p, size_t n) {
+    while (n > 0) {
+        ssize_t r = ::read(fd, p, n);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            return false;
+        }
+        p += r;
+        n -= r;
+    }
+    return true;
+}
+
+static bool write_frame(int fd, const std::string& payload) {
+    uint32_t n = (uint32_t)payload.size();
+    char header[4] = {(char)(n >> 24), (char)(n >> 16), (char)(n >> 8), (char)n};
+    return write_all(fd, header, 4) && write_all(fd, payload.data(), payload.size());
+}
+
+static bool read_frame(int fd, std::string& payload) {
+    unsigned char header[4];
+    if (!read_all(fd, (char*)header, 4)) {
+        return false;
+    }
+    payload.resize((uint32_t)header[0] << 24 | (uint32_t)header[1] << 16 | (uint32_t)header[2] << 8 | header[3]);
+    return payload.empty() || read_all(fd, &payload[0], payload.size());
+}
+
+// ====================== ExecPool ======================
+
+ExecPool::ExecPool(const std::string& program, int size) : path(program), live(0) {
+    signal(SIGPIPE, SIG_IGN); // A worker that dies shows up as a failed write, as in exec_program
+    for (int i = 0; i < size; i++) {
+        Worker w;
+        if (!start(w)) {
+            break; // It does not speak the protocol, so neither will the others
+        }
+        idle.push_back(w);
+        live++;
+    }
+}
+
+ExecPool::~ExecPool() {
+    // Every run() has returned by now, so every worker is idle
+    for (Worker& w : idle) {
+        stop(w, false);
+    }
+}
+
+bool ExecPool::pooled() const {
+    return live > 0;
+}
+
+const std::string& ExecPool::program() const {
+    return path;
+}
+
+bool ExecPool::start(Worker& w) {
+    int to[2];
+    int from[2];
+    if (pipe2(to, O_CLOEXEC) != 0) {
+        return false;
+    }
+    if (pipe2(from, O_CLOEXEC) != 0) {
+        close(to[0]);
+        close(to[1]);
+        return false;
+    }
+
+    // dup2 clears close-on-exec on the worker's copies; the pool's ends stay
+    // close-on-exec, so other workers never hold them open
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, to[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, from[1], STDOUT_FILENO);
+    const char* argv[] = {path.c_str(), "--worker", nullptr};
+    int failed = posix_spawn(&w.pid, path.c_str(), &actions, nullptr, (char* const*)argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(to[0]);
+    close(from[1]);
+    w.to = to[1];
+    w.from = from[0];
+    if (failed) {
+        close(w.to);
+        close(w.from);
+        return false;
+    }
+
+    // A program that is not a worker exits, writes something else, or waits
+    pollfd ready = {w.from, POLLIN, 0};
+    int polled;
+    do {
+        polled = poll(&ready, 1, hello_timeout_ms);
+    } while (polled < 0 && errno == EINTR);
+    std::string greeting;
+    if (polled != 1 || !read_frame(w.from, greeting) || greeting != hello) {
+        stop(w, true);
+        return false;
+    }
+    return true;
+}
+
+void ExecPool::stop(Worker& w, bool kill_it) {
+    close(w.to); // A worker exits when its input closes
+    close(w.from);
+    if (kill_it) {
+        kill(w.pid, SIGKILL);
+    }
+    int status;
+    while (waitpid(w.pid, &status, 0) < 0 && errno == EINTR) {
+    }
+}
+
+bool ExecPool::request(Worker& w, int argc, const char* const* argv, const std::string& input, ExecResult& r) {
+    std::string args;
+    for (int i = 1; i < argc; i++) {
+        args += argv[i];
+        args += '\0';
+    }
+    // The worker reads the whole request before it replies, so this cannot deadlock
+    std::string code;
+    if (!write_frame(w.to, args) || !write_frame(w.to, input) || !read_frame(w.from, code) ||
+        !read_frame(w.from, r.out) || !read_frame(w.from, r.err)) {
+        return false;
+    }
+    r.exit_code = atoi(code.c_str());
+    return true;
+}
+
+ExecResult ExecPool::run(int argc, const char* const* argv, const std::string& input) {
+    if (argc < 1 || path != argv[0]) {
+        return exec_program(argc, argv, input);
+    }
+
+    Worker w;
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        available.wait(guard, [this] { return !idle.empty() || live == 0; });
+        if (live == 0) {
+            guard.unlock();
+            return exec_program(argc, argv, input);
+        }
+        w = idle.back();
+        idle.pop_back();
+    }
+
+    ExecResult r;
+    bool answered = request(w, argc, argv, input, r);
+    bool usable = answered;
+    if (!answered) {
+        stop(w, true);
+        usable = start(w);
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (usable) {
+            idle.push_back(w);
+        } else {
+            live--;
+        }
+    }
+    available.notify_all(); // Waiters may now have a worker, or none left to wait for
+    return answered ? r : exec_program(argc, argv, input);
+}
+
+// ====================== Worker ======================
+
+// An unnamed file holding `text`, positioned at its start
+static int scratch_file(const std::string& text) {
+#ifdef MFD_CLOEXEC
+    int fd = memfd_create("msdscript", 0);
+#else
+    FILE* f = tmpfile();
+    int fd = f ? dup(fileno(f)) : -1;
+    if (f) {
+        fclose(f);
+    }
+#endif
+    if (fd < 0 || !write_all(fd, text.data(), text.size()) || lseek(fd, 0, SEEK_SET) != 0) {
+        throw std::runtime_error("cannot create a scratch file");
+    }
+    return fd;
+}
+
+static std::string read_file(int fd) {
+    std::string text;
+    char buffer[4096];
+    lseek(fd, 0, SEEK_SET);
+    ssize_t n;
+    while ((n = ::read(fd, buffer, sizeof buffer)) > 0 || (n < 0 && errno == EINTR)) {
+        if (n > 0) {
+            text.append(buffer, n);
+        }
+    }
+    return text;
+}
+
+// Runs one command in a child process whose standard streams are scratch files
+static ExecResult run_forked(int (*run)(int argc, char* argv[]), const std::string& args, const std::string& input) {
+    std::vector<std::string> list = {"msdscript"};
+    for (size_t start = 0; start < args.size();) {
+        size_t end = args.find('\0', start);
+        list.push_back(args.substr(start, end - start));
+        start = end + 1;
+    }
+
+    int in = scratch_file(input);
+    int out = scratch_file("");
+    int err = scratch_file("");
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("fork failed");
+    }
+    if (pid == 0) {
+        dup2(in, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        dup2(err, STDERR_FILENO);
+        std::vector<char*> argv;
+        for (std::string& a : list) {
+            argv.push_back(&a[0]);
+        }
+        argv.push_back(nullptr);
+        int code = run((int)list.size(), argv.data());
+        std::cout.flush();
+        std::cerr.flush();
+        fflush(nullptr);
+        _exit(code);
+    }
+
+    ExecResult r;
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            throw std::runtime_error("waitpid failed");
+        }
+    }
+    // The same convention as exec_program: the signal number if it was killed
+    r.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status);
+    r.out = read_file(out);
+    r.err = read_file(err);
+    close(in);
+    close(out);
+    close(err);
+    return r;
+}
+
+int run_worker(int (*run)(int argc, char* argv[])) {
+    signal(SIGPIPE, SIG_IGN);
+    if (!write_frame(STDOUT_FILENO, hello)) {
+        return 1;
+    }
+    std::string args;
+    std::string input;
+    while (read_frame(STDIN_FILENO, args)) {
+        if (!read_frame(STDIN_FILENO, input)) {
+            return 1;
+        }
+        ExecResult r = run_forked(run, args, input);
+        if (!write_frame(STDOUT_FILENO, std::to_string(r.exit_code)) || !write_frame(STDOUT_FILENO, r.out) ||
+            !write_frame(STDOUT_FILENO, r.err)) {
+            return 1;
+        }
+    }
+    return 0;
+}
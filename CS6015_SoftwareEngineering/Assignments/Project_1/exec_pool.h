@@ -0,0 +1,111 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef EXEC_POOL_H
+#define EXEC_POOL_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "exec.h"
+
+/**
+ * @class ExecPool
+ * @brief Runs commands of one msdscript executable on long-running workers.
+ *
+ * exec_program creates three pipes, forks, execs and waits for every call.
+ * A pool instead starts `size` copies of `program --worker` once, with
+ * posix_spawn, and sends each call to an idle one over its standard input
+ * and output:
+ *
+ *   request: a frame with the arguments after argv[0], each ending in a
+ *            NUL, then a frame with the standard input text;
+ *   reply:   frames with the exit code in decimal, standard output and
+ *            standard error.
+ *
+ * A frame is its length as a 4-byte big-endian integer, then its bytes (as
+ * for --serve). A worker answers with a hello frame when it starts, and
+ * runs each request in a fork of itself with its standard streams on
+ * scratch files, so every call starts from a fresh process image and a
+ * crash only ends that call; only the execv and the program's startup are
+ * saved, and the reply matches what exec_program would return.
+ *
+ * run() may be called from several threads; a call waits while every
+ * worker is busy. If the program does not answer the hello (it is another
+ * msdscript implementation without --worker, or not msdscript at all),
+ * every call goes through exec_program instead. So does a call whose worker
+ * dies; the worker is replaced if it can be.
+ */
+class ExecPool {
+public:
+    /**
+     * @brief Starts the workers.
+     * @param program Path of the msdscript executable.
+     * @param size Number of workers (at least 1).
+     */
+    ExecPool(const std::string& program, int size);
+
+    /**
+     * @brief Closes the workers' input, which ends them, and waits for them.
+     */
+    ~ExecPool();
+
+    ExecPool(const ExecPool&) = delete;
+    ExecPool& operator=(const ExecPool&) = delete;
+
+    /**
+     * @brief Runs one command, as exec_program would.
+     * @param argc Number of entries in argv.
+     * @param argv The command; argv[0] must be this pool's program, or the
+     *        command is passed on to exec_program.
+     * @param input Text for the command's standard input.
+     * @return Its exit code (the signal number if it was killed), standard output and standard error.
+     */
+    ExecResult run(int argc, const char* const* argv, const std::string& input);
+
+    /**
+     * @brief Whether the program runs on workers, rather than through exec_program.
+     */
+    bool pooled() const;
+
+    /**
+     * @brief Path of the executable this pool runs.
+     */
+    const std::string& program() const;
+
+private:
+    struct Worker {
+        pid_t pid;
+        int to;   // The worker's standard input
+        int from; // The worker's standard output
+    };
+
+    std::string path;
+    std::mutex lock;
+    std::condition_variable available;
+    std::vector<Worker> idle;
+    int live; // Workers running, idle or not
+
+    bool start(Worker& w);
+    static void stop(Worker& w, bool kill_it);
+    static bool request(Worker& w, int argc, const char* const* argv, const std::string& input, ExecResult& r);
+};
+
+/**
+ * @brief Serves ExecPool requests on standard input and output until the pool closes it (--worker).
+ * @param run Runs one command as main does, given its argc and argv (argv[0] is
+ *        "msdscript"), and returns its exit code. It runs in a child process.
+ * @return 0 once the pool has closed standard input, 1 if a request was cut short.
+ */
+int run_worker(int (*run)(int argc, char* argv[]));
+
+#endif // EXEC_POOL_H
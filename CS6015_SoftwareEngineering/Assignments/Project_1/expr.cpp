@@ -10,47 +10,160 @@
 
 #include "expr.h"       // Include the header file for expression classes
 #include <stdexcept>    // For std::runtime_error
-#include <sstream>      // For std::stringstream
+#include <vector>
 #include "val.h"        // Include val.h for Val and NumVal
 #include "parse.hpp"
 #include "pointer.h"
+#include "vm.h"
+#include "resolve.h"
+#include "optimize.h"
+#include "hashcons.h"
+#include "printer.h"
+#include "encode.h"
+#include "profile.h"
 
 // ====================== Expr ======================
 
+// Refuses to evaluate or compare a subexpression when too little native stack is left
+static void check_nesting() {
+    StackGuard::check(StackGuard::expr_reserve, "expression nested too deeply");
+}
+
 std::string Expr::to_string() {
-    std::stringstream st(""); // Create a string stream
-    THIS->printExp(st);       // Print the expression to the stream
-    return st.str();          // Return the string representation
+    Writer out;            // Collect the output in memory
+    THIS->printExp(out);   // Print the expression to the writer
+    return out.take();     // Return the string representation
 }
 
 std::string Expr::to_pretty_string() {
-    std::stringstream st; // Create a string stream
-    THIS->pretty_print(st, prec_none); // Pretty-print the expression to the stream
-    return st.str();      // Return the pretty-printed string
+    Writer out;           // Collect the output in memory
+    THIS->pretty_print(out, prec_none); // Pretty-print the expression to the writer
+    return out.take();    // Return the pretty-printed string
+}
+
+void Expr::printExp(Writer& ot) {
+    Printer::print(ot, THIS); // Print with an explicit stack, however deep the tree is
 }
 
-void Expr::pretty_print(std::ostream& ot, precedence_t prec) {
-    std::streampos last_newline_pos = ot.tellp(); // Get the current position in the stream
-    pretty_print_at(ot, prec, last_newline_pos);  // Delegate to pretty_print_at
+void Expr::pretty_print(Writer& ot, precedence_t prec) {
+    Printer::pretty_print(ot, THIS, prec); // Columns count from the current position
 }
 
-void Expr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) {
+void Expr::pretty_print_at(Printer& p, precedence_t prec, size_t line) {
     (void)prec; // Mark as unused
-    (void)last_newline_pos; // Mark as unused
-    printExp(ot); // Default implementation: just call printExp
+    (void)line; // Mark as unused
+    print(p); // Default implementation: just print
+}
+
+Expr* Expr::tail(PTR(Env)& env) {
+    (void)env; // Mark as unused
+    return this; // Default implementation: the whole expression is the tail
+}
+
+bool Expr::is_interned() const {
+    return interner_id != 0;
+}
+
+size_t Expr::hash() const {
+    return hash_code;
+}
+
+bool Expr::interned_equals(const Expr& e, bool& result) const {
+    if (interner_id == 0 || e.interner_id == 0) {
+        return false;
+    }
+    if (interner_id == e.interner_id) {
+        result = &e == this; // One node per distinct tree
+        return true;
+    }
+    if (hash_code != e.hash_code) {
+        result = false;
+        return true;
+    }
+    return false;
+}
+
+void Expr::release(PTR(Expr)& child) {
+#if USE_PLAIN_POINTERS || USE_ARENA_POINTERS
+    (void)child; // Children are never freed by their parent's destructor
+#else
+    static thread_local int depth = 0;                          // Nested releases on this thread
+    static thread_local std::vector<PTR(Expr)>* deferred = nullptr; // Owned by the outermost one
+    if (depth >= max_release_depth) {
+        deferred->push_back(std::move(child)); // Too deep: the outermost release destroys it
+        return;
+    }
+    if (depth > 0) {
+        depth++;
+        child.reset();
+        depth--;
+        return;
+    }
+    std::vector<PTR(Expr)> queue;
+    deferred = &queue;
+    depth = 1;
+    child.reset();
+    while (!queue.empty()) {
+        PTR(Expr) e = std::move(queue.back());
+        queue.pop_back();
+        e.reset(); // May defer more of the tree, one max_release_depth at a time
+    }
+    depth = 0;
+    deferred = nullptr;
+#endif
 }
 
 // ====================== NumExpr ======================
 
-NumExpr::NumExpr(int value) : value(value) {}
+NumExpr::NumExpr(int value) : Expr(expr_num), value(value) {}
 
 PTR(Val) NumExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_num); // Does nothing unless --profile
     (void)env;
-    return NEW(NumVal)(value);
+    return NumVal::make(value);
+}
+
+void NumExpr::compile(Compiler& c) {
+    c.emit(op_num, value);
+}
+
+void NumExpr::resolve(Resolver& r) {
+    (void)r; // Numbers do not contain variables
+}
+
+void NumExpr::optimize(Optimizer& o, int stage) {
+    (void)stage;
+    o.push(THIS); // Literals are immutable, so they can be shared
+}
+
+void NumExpr::intern(ExprInterner& in, int stage) {
+    (void)stage;
+    if (in.owns(*this)) {
+        in.push(THIS);
+        return;
+    }
+    size_t h = ExprInterner::combine('#', std::hash<int>()(value));
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        NumExpr* n = expr_cast<NumExpr>(c);
+        if (n && n->value == value) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(NumExpr)(value)));
+}
+
+void NumExpr::encode(Encoder& out) {
+    out.kind(node_num);
+    out.number(value);
 }
 
 bool NumExpr::equals(const PTR(Expr) e) {
-    PTR(const NumExpr) numExpr = CAST(const NumExpr)(e); // Cast to NumExpr
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    const NumExpr* numExpr = expr_cast<const NumExpr>(e); // Cast to NumExpr
     return numExpr && value == numExpr->value; // Compare values
 }
 
@@ -60,148 +173,360 @@ bool NumExpr::equals(const PTR(Expr) e) {
 //    return THIS; // Numbers do not contain variables, so return the same expression
 //}
 
-void NumExpr::printExp(std::ostream& ot) {
-    ot << value; // Print the number
+void NumExpr::print(Printer& p) {
+    p.number(value); // Print the number
+}
+
+// ====================== BigNumExpr ======================
+
+BigNumExpr::BigNumExpr(const BigInt& value) : Expr(expr_big_num), value(value), digits(value.to_string()) {}
+
+PTR(Val) BigNumExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_big_num);
+    (void)env;
+    return BigNumVal::make(value);
+}
+
+void BigNumExpr::compile(Compiler& c) {
+    (void)c;
+    throw std::runtime_error("number too large for the VM");
+}
+
+void BigNumExpr::resolve(Resolver& r) {
+    (void)r; // Numbers do not contain variables
+}
+
+void BigNumExpr::optimize(Optimizer& o, int stage) {
+    (void)stage;
+    o.push(THIS); // Literals are immutable, so they can be shared
+}
+
+void BigNumExpr::intern(ExprInterner& in, int stage) {
+    (void)stage;
+    if (in.owns(*this)) {
+        in.push(THIS);
+        return;
+    }
+    size_t h = ExprInterner::combine('#', value.hash());
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        BigNumExpr* n = expr_cast<BigNumExpr>(c);
+        if (n && n->value == value) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(BigNumExpr)(value)));
+}
+
+void BigNumExpr::encode(Encoder& out) {
+    out.kind(node_big_num);
+    out.text(digits);
+}
+
+bool BigNumExpr::equals(const PTR(Expr) e) {
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    const BigNumExpr* bigExpr = expr_cast<const BigNumExpr>(e);
+    return bigExpr && value == bigExpr->value;
+}
+
+void BigNumExpr::print(Printer& p) {
+    p.text(digits);
 }
 
 // ====================== AddExpr ======================
 
-AddExpr::AddExpr(PTR(Expr) lhs, PTR(Expr) rhs) : lhs(lhs), rhs(rhs) {}
+AddExpr::AddExpr(PTR(Expr) lhs, PTR(Expr) rhs) : Expr(expr_add), lhs(lhs), rhs(rhs) {}
+
+AddExpr::~AddExpr() {
+    release(lhs);
+    release(rhs);
+}
 
 bool AddExpr::equals(const PTR(Expr) e) {
-    PTR(const AddExpr) addExpr = CAST(const AddExpr)(e); // Cast to AddExpr
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    check_nesting();
+    const AddExpr* addExpr = expr_cast<const AddExpr>(e); // Cast to AddExpr
     return addExpr && lhs->equals(addExpr->lhs) && rhs->equals(addExpr->rhs); // Compare sub-expressions
 }
 
 PTR(Val) AddExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_add);
+    check_nesting();
     PTR(Val) lhsVal = lhs->interp(env);
     PTR(Val) rhsVal = rhs->interp(env);
-    PTR(NumVal) lhsNum = CAST(NumVal)(lhsVal);
-    PTR(NumVal) rhsNum = CAST(NumVal)(rhsVal);
+    NumVal* lhsNum = val_cast<NumVal>(lhsVal);
+    NumVal* rhsNum = val_cast<NumVal>(rhsVal);
+
+    if (lhsNum && rhsNum) {
+        return NumVal::add(lhsNum->value, rhsNum->value);
+    }
 
-    if (!lhsNum || !rhsNum) {
+    BigInt a, b; // With --bignum, either side may be a BigNumVal
+    if (!BigNumVal::to_big(lhsVal, a) || !BigNumVal::to_big(rhsVal, b)) {
         throw std::runtime_error("Cannot add non-numeric values");
     }
+    return BigNumVal::make(a + b);
+}
+
+void AddExpr::compile(Compiler& c) {
+    lhs->compile(c);
+    rhs->compile(c);
+    c.emit(op_add);
+}
+
+void AddExpr::resolve(Resolver& r) {
+    r.visit(lhs);
+    r.visit(rhs);
+}
 
-    int a = lhsNum->value;
-    int b = rhsNum->value;
+void AddExpr::optimize(Optimizer& o, int stage) {
+    if (stage == 0) {
+        o.visit(lhs);
+        o.visit(rhs);
+        o.resume(this, 1);
+        return;
+    }
+    PTR(Expr) r = o.pop();
+    PTR(Expr) l = o.pop();
+    PTR(Expr) e = NEW(AddExpr)(l, r);
+    o.push(Optimizer::is_literal(l) && Optimizer::is_literal(r) ? Optimizer::fold(e) : e);
+}
 
-    // Check for overflow in addition
-    if (b > 0 && a > INT_MAX - b) {
-        throw std::runtime_error("arithmetic overflow");
+void AddExpr::intern(ExprInterner& in, int stage) {
+    if (stage == 0) {
+        if (in.owns(*this)) {
+            in.push(THIS);
+            return;
+        }
+        in.visit(lhs);
+        in.visit(rhs);
+        in.resume(this, 1);
+        return;
     }
-    if (b < 0 && a < INT_MIN - b) {
-        throw std::runtime_error("arithmetic overflow");
+    PTR(Expr) r = in.pop();
+    PTR(Expr) l = in.pop();
+    size_t h = ExprInterner::combine(ExprInterner::combine('+', l->hash()), r->hash());
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        AddExpr* n = expr_cast<AddExpr>(c);
+        if (n && n->lhs == l && n->rhs == r) {
+            in.push(c);
+            return;
+        }
     }
+    in.push(in.add(h, NEW(AddExpr)(l, r)));
+}
 
-    int result = a + b;
-    return NEW(NumVal)(result);
+void AddExpr::encode(Encoder& out) {
+    out.kind(node_add);
+    out.visit(lhs);
+    out.visit(rhs);
 }
 
 //PTR(Expr) AddExpr::subst(const std::string& var, PTR(Expr) replacement) {
 //    return NEW(AddExpr)(lhs->subst(var, replacement), rhs->subst(var, replacement));
 //}
 
-void AddExpr::printExp(std::ostream& ot) {
-    ot << "(";       // Print opening parenthesis
-    lhs->printExp(ot); // Print the left-hand side
-    ot << "+";       // Print the addition operator
-    rhs->printExp(ot); // Print the right-hand side
-    ot << ")";       // Print closing parenthesis
+void AddExpr::print(Printer& p) {
+    p.text("(");     // Print opening parenthesis
+    p.print(lhs);    // Print the left-hand side
+    p.text("+");     // Print the addition operator
+    p.print(rhs);    // Print the right-hand side
+    p.text(")");     // Print closing parenthesis
 }
 
-void AddExpr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) {
+void AddExpr::pretty_print_at(Printer& p, precedence_t prec, size_t line) {
     bool use_parentheses = (prec >= prec_add); // Determine if parentheses are needed
     if (use_parentheses) {
-        ot << "("; // Print opening parenthesis if needed
+        p.text("("); // Print opening parenthesis if needed
     }
-    lhs->pretty_print_at(ot, prec_add, last_newline_pos); // Pretty-print the left-hand side
-    ot << " + "; // Print the addition operator
-    rhs->pretty_print_at(ot, prec_none, last_newline_pos); // Pretty-print the right-hand side
+    p.pretty_print_at(lhs, prec_add, line); // Pretty-print the left-hand side
+    p.text(" + "); // Print the addition operator
+    p.pretty_print_at(rhs, prec_none, line); // Pretty-print the right-hand side
     if (use_parentheses) {
-        ot << ")"; // Print closing parenthesis if needed
+        p.text(")"); // Print closing parenthesis if needed
     }
 }
 
 // ====================== MultExpr ======================
 
-MultExpr::MultExpr(PTR(Expr) lhs, PTR(Expr) rhs) : lhs(lhs), rhs(rhs) {};
+MultExpr::MultExpr(PTR(Expr) lhs, PTR(Expr) rhs) : Expr(expr_mult), lhs(lhs), rhs(rhs) {};
+
+MultExpr::~MultExpr() {
+    release(lhs);
+    release(rhs);
+}
 
 bool MultExpr::equals(const PTR(Expr) e) {
-    PTR(const MultExpr) multExpr = CAST(const MultExpr)(e); // Cast to MultExpr
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    check_nesting();
+    const MultExpr* multExpr = expr_cast<const MultExpr>(e); // Cast to MultExpr
     return multExpr && lhs->equals(multExpr->lhs) && rhs->equals(multExpr->rhs); // Compare sub-expressions
 }
 
 PTR(Val) MultExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_mult);
+    check_nesting();
     PTR(Val) lhsVal = lhs->interp(env);
     PTR(Val) rhsVal = rhs->interp(env);
-    PTR(NumVal) lhsNum = CAST(NumVal)(lhsVal);
-    PTR(NumVal) rhsNum = CAST(NumVal)(rhsVal);
+    NumVal* lhsNum = val_cast<NumVal>(lhsVal);
+    NumVal* rhsNum = val_cast<NumVal>(rhsVal);
+
+    if (lhsNum && rhsNum) {
+        return NumVal::mult(lhsNum->value, rhsNum->value);
+    }
 
-    if (!lhsNum || !rhsNum) {
+    BigInt a, b; // With --bignum, either side may be a BigNumVal
+    if (!BigNumVal::to_big(lhsVal, a) || !BigNumVal::to_big(rhsVal, b)) {
         throw std::runtime_error("Cannot multiply non-numeric values");
     }
+    return BigNumVal::make(a * b);
+}
 
-    int a = lhsNum->value;
-    int b = rhsNum->value;
+void MultExpr::compile(Compiler& c) {
+    lhs->compile(c);
+    rhs->compile(c);
+    c.emit(op_mult);
+}
 
-    // Check for overflow in multiplication
-    if (a > 0) {
-        if (b > 0 && a > INT_MAX / b) {
-            throw std::runtime_error("arithmetic overflow");
-        }
-        if (b < 0 && b < INT_MIN / a) {
-            throw std::runtime_error("arithmetic overflow");
-        }
-    } else if (a < 0) {
-        if (b > 0 && a < INT_MIN / b) {
-            throw std::runtime_error("arithmetic overflow");
+void MultExpr::resolve(Resolver& r) {
+    r.visit(lhs);
+    r.visit(rhs);
+}
+
+void MultExpr::optimize(Optimizer& o, int stage) {
+    if (stage == 0) {
+        o.visit(lhs);
+        o.visit(rhs);
+        o.resume(this, 1);
+        return;
+    }
+    PTR(Expr) r = o.pop();
+    PTR(Expr) l = o.pop();
+    PTR(Expr) e = NEW(MultExpr)(l, r);
+    o.push(Optimizer::is_literal(l) && Optimizer::is_literal(r) ? Optimizer::fold(e) : e);
+}
+
+void MultExpr::intern(ExprInterner& in, int stage) {
+    if (stage == 0) {
+        if (in.owns(*this)) {
+            in.push(THIS);
+            return;
         }
-        if (b < 0 && b < INT_MAX / a) {
-            throw std::runtime_error("arithmetic overflow");
+        in.visit(lhs);
+        in.visit(rhs);
+        in.resume(this, 1);
+        return;
+    }
+    PTR(Expr) r = in.pop();
+    PTR(Expr) l = in.pop();
+    size_t h = ExprInterner::combine(ExprInterner::combine('*', l->hash()), r->hash());
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        MultExpr* n = expr_cast<MultExpr>(c);
+        if (n && n->lhs == l && n->rhs == r) {
+            in.push(c);
+            return;
         }
     }
+    in.push(in.add(h, NEW(MultExpr)(l, r)));
+}
 
-    int result = a * b;
-    return NEW(NumVal)(result);
+void MultExpr::encode(Encoder& out) {
+    out.kind(node_mult);
+    out.visit(lhs);
+    out.visit(rhs);
 }
 
 //PTR(Expr) MultExpr::subst(const std::string& var, PTR(Expr) replacement) {
 //    return NEW(MultExpr)(lhs->subst(var, replacement), rhs->subst(var, replacement));
 //}
 
-void MultExpr::printExp(std::ostream& ot) {
-    ot << "(";       // Print opening parenthesis
-    lhs->printExp(ot); // Print the left-hand side
-    ot << "*";       // Print the multiplication operator
-    rhs->printExp(ot); // Print the right-hand side
-    ot << ")";       // Print closing parenthesis
+void MultExpr::print(Printer& p) {
+    p.text("(");     // Print opening parenthesis
+    p.print(lhs);    // Print the left-hand side
+    p.text("*");     // Print the multiplication operator
+    p.print(rhs);    // Print the right-hand side
+    p.text(")");     // Print closing parenthesis
 }
 
-void MultExpr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) {
+void MultExpr::pretty_print_at(Printer& p, precedence_t prec, size_t line) {
     bool use_parentheses = (prec >= prec_mult); // Determine if parentheses are needed
     if (use_parentheses) {
-        ot << "("; // Print opening parenthesis if needed
+        p.text("("); // Print opening parenthesis if needed
     }
-    lhs->pretty_print_at(ot, prec_mult, last_newline_pos); // Pretty-print the left-hand side
-    ot << " * "; // Print the multiplication operator
-    rhs->pretty_print_at(ot, prec_add, last_newline_pos); // Pretty-print the right-hand side
+    p.pretty_print_at(lhs, prec_mult, line); // Pretty-print the left-hand side
+    p.text(" * "); // Print the multiplication operator
+    p.pretty_print_at(rhs, prec_add, line); // Pretty-print the right-hand side
     if (use_parentheses) {
-        ot << ")"; // Print closing parenthesis if needed
+        p.text(")"); // Print closing parenthesis if needed
     }
 }
 
 // ====================== VarExpr ======================
 
-VarExpr::VarExpr(const std::string& name) : name(name) {}
+VarExpr::VarExpr(Symbol name) : Expr(expr_var), name(name) {}
 
 bool VarExpr::equals(const PTR(Expr) e) {
-    PTR(const VarExpr) varExpr = CAST(const VarExpr)(e); // Cast to VarExpr
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    const VarExpr* varExpr = expr_cast<const VarExpr>(e); // Cast to VarExpr
     return varExpr && name == varExpr->name; // Compare variable names
 }
 
 PTR(Val) VarExpr::interp(PTR(Env) env) {
-    return env->lookup(name);  // Look up variable in environment
+    ProfileScope profile(prof_var);
+    if (slot < 0) {
+        return env->lookup(name);  // Look up variable in environment
+    }
+    return env->lookup_at(depth, slot, name); // Index the frame found by the Resolver
+}
+
+void VarExpr::compile(Compiler& c) {
+    c.emit_var(name);
+}
+
+void VarExpr::resolve(Resolver& r) {
+    if (!r.lookup(name, depth, slot)) {
+        depth = slot = -1; // Free variable: left for lookup by name to report
+    }
+}
+
+void VarExpr::optimize(Optimizer& o, int stage) {
+    (void)stage;
+    PTR(Expr) value = o.lookup(name);
+    o.push(value ? value : NEW(VarExpr)(name));
+}
+
+void VarExpr::intern(ExprInterner& in, int stage) {
+    (void)stage;
+    if (in.owns(*this)) {
+        in.push(THIS);
+        return;
+    }
+    size_t h = ExprInterner::combine('$', std::hash<Symbol>()(name));
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        VarExpr* n = expr_cast<VarExpr>(c);
+        if (n && n->name == name) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(VarExpr)(name)));
+}
+
+void VarExpr::encode(Encoder& out) {
+    out.kind(node_var);
+    out.name(name);
 }
 
 //PTR(Expr) VarExpr::subst(const std::string& var, PTR(Expr) replacement) {
@@ -211,32 +536,137 @@ PTR(Val) VarExpr::interp(PTR(Env) env) {
 //    return THIS; // Otherwise, return the current expression
 //}
 
-void VarExpr::printExp(std::ostream& ot) {
-    ot << name; // Print the variable name
+void VarExpr::print(Printer& p) {
+    p.text(name.str()); // Print the variable name
 }
 
 // ====================== LetExpr ======================
 
-LetExpr::LetExpr(const std::string& var, PTR(Expr) rhs, PTR(Expr) body)
-    : var(var), rhs(rhs), body(body) {}
+LetExpr::LetExpr(Symbol var, PTR(Expr) rhs, PTR(Expr) body)
+    : Expr(expr_let), var(var), rhs(rhs), body(body) {}
+
+LetExpr::~LetExpr() {
+    release(rhs);
+    release(body);
+}
 
 bool LetExpr::equals(const PTR(Expr) e) {
-    PTR(const LetExpr) letExpr = CAST(const LetExpr)(e); // Cast to LetExpr
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    check_nesting();
+    const LetExpr* letExpr = expr_cast<const LetExpr>(e); // Cast to LetExpr
     return letExpr && var == letExpr->var && // Compare variables
            rhs->equals(letExpr->rhs) && // Compare right-hand sides
            body->equals(letExpr->body); // Compare bodies
 }
 
 PTR(Val) LetExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_let);
+    check_nesting();
+    Expr* next = tail(env);
+    return next->interp(env);
+}
+
+Expr* LetExpr::tail(PTR(Env)& env) {
     // 1. Evaluate the right-hand side in the current environment
     PTR(Val) rhs_val = rhs->interp(env);
 
-    // 2. Create a new environment that extends the current one
-    //    with the new variable binding
-    PTR(Env) new_env = NEW(ExtendedEnv)(var, rhs_val, env);
+    if (frame_size > 0) {
+        // Outermost _let of a resolved tree: open a frame for it and its nested _lets
+        PTR(Env) frame = NEW(FrameEnv)(frame_size, env);
+        frame->bind(slot, rhs_val);
+        env = frame;
+    } else if (slot >= 0) {
+        // Resolved: bind into the current frame
+        env->bind(slot, rhs_val);
+    } else {
+        // 2. Create a new environment that extends the current one
+        //    with the new variable binding
+        env = NEW(ExtendedEnv)(var, rhs_val, env);
+    }
+
+    // 3. The body is evaluated in that environment
+    return &*body;
+}
+
+void LetExpr::compile(Compiler& c) {
+    rhs->compile(c);    // The right-hand side cannot see the new binding
+    c.begin_let(var);
+    body->compile(c);
+    c.end_let();
+}
+
+void LetExpr::resolve(Resolver& r) {
+    r.visit(rhs);    // The right-hand side cannot see the new binding
+    if (r.in_frame()) {
+        frame_size = 0;
+        r.bind(var, slot);
+        r.visit(body);
+        r.unbind();
+    } else {
+        slot = 0;
+        r.open_frame(var);
+        r.visit(body);
+        r.close_frame(frame_size);
+    }
+}
+
+void LetExpr::optimize(Optimizer& o, int stage) {
+    switch (stage) {
+        case 0:
+            o.visit(rhs);
+            o.resume(this, 1);
+            break;
+        case 1: {
+            // A constant is substituted, and its binding dropped in stage 2
+            PTR(Expr) r = o.pop();
+            o.bind(var, Optimizer::is_literal(r) ? r : nullptr);
+            o.push(r); // Kept for stage 2
+            o.visit(body);
+            o.resume(this, 2);
+            break;
+        }
+        default: {
+            PTR(Expr) b = o.pop();
+            PTR(Expr) r = o.pop();
+            o.unbind();
+            o.push(Optimizer::is_literal(r) ? b : NEW(LetExpr)(var, r, b));
+        }
+    }
+}
+
+void LetExpr::intern(ExprInterner& in, int stage) {
+    if (stage == 0) {
+        if (in.owns(*this)) {
+            in.push(THIS);
+            return;
+        }
+        in.visit(rhs);
+        in.visit(body);
+        in.resume(this, 1);
+        return;
+    }
+    PTR(Expr) b = in.pop();
+    PTR(Expr) r = in.pop();
+    size_t h = ExprInterner::combine('l', std::hash<Symbol>()(var));
+    h = ExprInterner::combine(ExprInterner::combine(h, r->hash()), b->hash());
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        LetExpr* n = expr_cast<LetExpr>(c);
+        if (n && n->var == var && n->rhs == r && n->body == b) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(LetExpr)(var, r, b)));
+}
 
-    // 3. Evaluate the body in the extended environment
-    return body->interp(new_env);
+void LetExpr::encode(Encoder& out) {
+    out.kind(node_let);
+    out.name(var);
+    out.visit(rhs);
+    out.visit(body);
 }
 
 //PTR(Expr) LetExpr::subst(const std::string& var, PTR(Expr) replacement) {
@@ -248,64 +678,95 @@ PTR(Val) LetExpr::interp(PTR(Env) env) {
 //    return NEW(LetExpr)(var, rhs->subst(var, replacement), body->subst(var, replacement));
 //}
 
-void LetExpr::printExp(std::ostream& ot) {
-    ot << "(_let " << var << "="; // Print the let keyword and variable
-    rhs->printExp(ot); // Print the right-hand side
-    ot << " _in "; // Print the in keyword
-    body->printExp(ot); // Print the body
-    ot << ")"; // Print closing parenthesis
-}
-
-void LetExpr::pretty_print(std::ostream& ot, precedence_t prec) {
-    std::streampos last_newline_pos = ot.tellp(); // Get the current position in the stream
-    pretty_print_at(ot, prec, last_newline_pos); // Delegate to pretty_print_at
+void LetExpr::print(Printer& p) {
+    p.text("(_let "); // Print the let keyword and variable
+    p.text(var.str());
+    p.text("=");
+    p.print(rhs); // Print the right-hand side
+    p.text(" _in "); // Print the in keyword
+    p.print(body); // Print the body
+    p.text(")"); // Print closing parenthesis
 }
 
-void LetExpr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) {
+void LetExpr::pretty_print_at(Printer& p, precedence_t prec, size_t line) {
     bool needs_parentheses = (prec != prec_none); // Determine if parentheses are needed
     if (needs_parentheses) {
-        ot << "("; // Print opening parenthesis if needed
+        p.text("("); // Print opening parenthesis if needed
     }
 
-    std::streampos position1 = last_newline_pos; // Save the position of the last newline
-    std::streampos current_pos = ot.tellp(); // Get the current position in the stream
+    size_t indent = p.column(line); // _in lines up under _let
 
     // Print the _let part
-    ot << "_let " << var << " = "; // Print the let keyword and variable
-    rhs->pretty_print(ot, prec_none); // Pretty-print the right-hand side
-
-    // Track the position after the newline
-    ot << "\n"; // Print a newline
-    last_newline_pos = ot.tellp(); // Update the position of the last newline
+    p.text("_let "); // Print the let keyword and variable
+    p.text(var.str());
+    p.text(" = ");
+    p.pretty_print(rhs, prec_none); // Pretty-print the right-hand side
 
-    // Calculate the indentation for _in
-    for (int i = position1; i < current_pos; i++) {
-        ot << " "; // Print spaces for indentation
-    }
+    // Start a new line, indented to the _let
+    p.newline(line, indent);
 
     // Print the _in part with proper indentation
-    ot << "_in  "; // Print the in keyword
+    p.text("_in  "); // Print the in keyword
 
     // Print the body with proper context
-    body->pretty_print_at(ot, prec_none, last_newline_pos); // Pretty-print the body
+    p.pretty_print_at(body, prec_none, line); // Pretty-print the body
 
     if (needs_parentheses) {
-        ot << ")"; // Print closing parenthesis if needed
+        p.text(")"); // Print closing parenthesis if needed
     }
 }
 
 // ====================== BoolExpr ======================
 
-BoolExpr::BoolExpr(bool value) : value(value) {}
+BoolExpr::BoolExpr(bool value) : Expr(expr_bool), value(value) {}
 
 bool BoolExpr::equals(const PTR(Expr) e) {
-    PTR(const BoolExpr) boolExpr = CAST(const BoolExpr)(e);
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    const BoolExpr* boolExpr = expr_cast<const BoolExpr>(e);
     return boolExpr && value == boolExpr->value;
 }
 
 PTR(Val) BoolExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_bool);
     (void)env;
-    return NEW(BoolVal)(value);
+    return BoolVal::make(value);
+}
+
+void BoolExpr::compile(Compiler& c) {
+    c.emit(op_bool, value);
+}
+
+void BoolExpr::resolve(Resolver& r) {
+    (void)r; // Booleans do not contain variables
+}
+
+void BoolExpr::optimize(Optimizer& o, int stage) {
+    (void)stage;
+    o.push(THIS); // Literals are immutable, so they can be shared
+}
+
+void BoolExpr::intern(ExprInterner& in, int stage) {
+    (void)stage;
+    if (in.owns(*this)) {
+        in.push(THIS);
+        return;
+    }
+    size_t h = ExprInterner::combine('b', value);
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        BoolExpr* n = expr_cast<BoolExpr>(c);
+        if (n && n->value == value) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(BoolExpr)(value)));
+}
+
+void BoolExpr::encode(Encoder& out) {
+    out.kind(value ? node_true : node_false);
 }
 
 //PTR(Expr) BoolExpr::subst(const std::string& var, PTR(Expr) replacement) {
@@ -314,109 +775,183 @@ PTR(Val) BoolExpr::interp(PTR(Env) env) {
 //    return THIS;
 //}
 
-void BoolExpr::printExp(std::ostream& ot) {
-    ot << (value ? "_true" : "_false");
+void BoolExpr::print(Printer& p) {
+    p.text(value ? "_true" : "_false");
 }
 
-void BoolExpr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) {
+void BoolExpr::pretty_print_at(Printer& p, precedence_t prec, size_t line) {
   	(void)prec;
-    (void)last_newline_pos;
-    ot << (value ? "_true" : "_false");
+    (void)line;
+    p.text(value ? "_true" : "_false");
 }
 
 // ====================== IfExpr ======================
 
 IfExpr::IfExpr(PTR(Expr) condition, PTR(Expr) then_branch, PTR(Expr) else_branch)
-    : condition(condition), then_branch(then_branch), else_branch(else_branch) {}
+    : Expr(expr_if), condition(condition), then_branch(then_branch), else_branch(else_branch) {}
+
+IfExpr::~IfExpr() {
+    release(condition);
+    release(then_branch);
+    release(else_branch);
+}
 
 
 bool IfExpr::equals(const PTR(Expr) e) {
-    PTR(const IfExpr) ifExpr = CAST(const IfExpr)(e);
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    check_nesting();
+    const IfExpr* ifExpr = expr_cast<const IfExpr>(e);
     return ifExpr && condition->equals(ifExpr->condition) &&
            then_branch->equals(ifExpr->then_branch) &&
            else_branch->equals(ifExpr->else_branch);
 }
 
 PTR(Val) IfExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_if);
+    check_nesting();
+    Expr* next = tail(env);
+    return next->interp(env);
+}
+
+Expr* IfExpr::tail(PTR(Env)& env) {
     // 1. Evaluate the condition in the current environment
     PTR(Val) condVal = condition->interp(env);
-    PTR(BoolVal) boolVal = CAST(BoolVal)(condVal);
+    BoolVal* boolVal = val_cast<BoolVal>(condVal);
 
     // 2. Verify it's a boolean value
     if (!boolVal) {
         throw std::runtime_error("Condition must be a boolean");
     }
 
-    // 3. Evaluate the appropriate branch in the same environment
+    // 3. The appropriate branch is evaluated in the same environment
     if (boolVal->is_true()) {
-        return then_branch->interp(env);
+        return &*then_branch;
     } else {
-        return else_branch->interp(env);
+        return &*else_branch;
+    }
+}
+
+void IfExpr::compile(Compiler& c) {
+    condition->compile(c);
+    int to_else = c.emit(op_jump_if_false);
+    then_branch->compile(c);
+    int to_end = c.emit(op_jump);
+    c.patch_to_here(to_else);
+    else_branch->compile(c);
+    c.patch_to_here(to_end);
+}
+
+void IfExpr::resolve(Resolver& r) {
+    r.visit(condition);
+    r.visit(then_branch);
+    r.visit(else_branch);
+}
+
+void IfExpr::optimize(Optimizer& o, int stage) {
+    switch (stage) {
+        case 0:
+            o.visit(condition);
+            o.resume(this, 1);
+            break;
+        case 1: {
+            PTR(Expr) c = o.pop();
+            if (expr_cast<BoolExpr>(c)) {
+                // Only the branch that would run is kept; its result is this one's
+                o.visit(c->interp(Env::empty)->is_true() ? then_branch : else_branch);
+                break;
+            }
+            o.push(c); // Kept for stage 2
+            o.visit(then_branch);
+            o.visit(else_branch);
+            o.resume(this, 2);
+            break;
+        }
+        default: {
+            PTR(Expr) e = o.pop();
+            PTR(Expr) t = o.pop();
+            PTR(Expr) c = o.pop();
+            o.push(NEW(IfExpr)(c, t, e));
+        }
     }
 }
 
+void IfExpr::intern(ExprInterner& in, int stage) {
+    if (stage == 0) {
+        if (in.owns(*this)) {
+            in.push(THIS);
+            return;
+        }
+        in.visit(condition);
+        in.visit(then_branch);
+        in.visit(else_branch);
+        in.resume(this, 1);
+        return;
+    }
+    PTR(Expr) e = in.pop();
+    PTR(Expr) t = in.pop();
+    PTR(Expr) c = in.pop();
+    size_t h = ExprInterner::combine(ExprInterner::combine('i', c->hash()), t->hash());
+    h = ExprInterner::combine(h, e->hash());
+    for (PTR(Expr) const& other : in.candidates(h)) {
+        IfExpr* n = expr_cast<IfExpr>(other);
+        if (n && n->condition == c && n->then_branch == t && n->else_branch == e) {
+            in.push(other);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(IfExpr)(c, t, e)));
+}
+
+void IfExpr::encode(Encoder& out) {
+    out.kind(node_if);
+    out.visit(condition);
+    out.visit(then_branch);
+    out.visit(else_branch);
+}
+
 //PTR(Expr) IfExpr::subst(const std::string& var, PTR(Expr) replacement) {
 //    return NEW(IfExpr)(condition->subst(var, replacement),
 //                      then_branch->subst(var, replacement),
 //                      else_branch->subst(var, replacement));
 //}
 
-void IfExpr::printExp(std::ostream& ot) {
-    ot << "(_if ";
-    condition->printExp(ot);
-    ot << " _then ";
-    then_branch->printExp(ot);
-    ot << " _else ";
-    else_branch->printExp(ot);
-    ot << ")";
+void IfExpr::print(Printer& p) {
+    p.text("(_if ");
+    p.print(condition);
+    p.text(" _then ");
+    p.print(then_branch);
+    p.text(" _else ");
+    p.print(else_branch);
+    p.text(")");
 }
 
-void IfExpr::pretty_print(std::ostream& ot, precedence_t prec) {
-    std::streampos last_newline_pos = ot.tellp(); // Get the current position in the stream
-    pretty_print_at(ot, prec, last_newline_pos); // Delegate to pretty_print_at
-}
-
-void IfExpr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) {
+void IfExpr::pretty_print_at(Printer& p, precedence_t prec, size_t line) {
     bool needs_parentheses = (prec != prec_none); // Determine if parentheses are needed
     if (needs_parentheses) {
-        ot << "("; // Print opening parenthesis if needed
+        p.text("("); // Print opening parenthesis if needed
     }
 
-    std::streampos position1 = last_newline_pos; // Save the position of the last newline
-    std::streampos current_pos = ot.tellp(); // Get the current position in the stream
+    size_t indent = p.column(line); // _then and _else line up under _if
 
     // Print the _if part
-    ot << "_if "; // Print the if keyword
-    condition->pretty_print(ot, prec_none); // Pretty-print the condition
-
-    // Track the position after the newline
-    ot << "\n"; // Print a newline
-    last_newline_pos = ot.tellp(); // Update the position of the last newline
-
-    // Calculate the indentation for _in
-    for (int i = position1; i < current_pos; i++) {
-        ot << " "; // Print spaces for indentation
-    }
-
-    // Print the _then part with proper indentation
-    ot << "_then "; // Print the then keyword
-    then_branch->pretty_print_at(ot, prec_none, last_newline_pos); // Pretty-print the then branch
+    p.text("_if "); // Print the if keyword
+    p.pretty_print(condition, prec_none); // Pretty-print the condition
 
-    // Track the position after the newline
-    ot << "\n"; // Print a newline
-    last_newline_pos = ot.tellp(); // Update the position of the last newline
-
-    // Calculate the indentation for _else
-    for (int i = position1; i < current_pos; i++) {
-        ot << " "; // Print spaces for indentation
-    }
+    // Print the _then part on a new line with proper indentation
+    p.newline(line, indent);
+    p.text("_then "); // Print the then keyword
+    p.pretty_print_at(then_branch, prec_none, line); // Pretty-print the then branch
 
-    // Print the _else part with proper indentation
-    ot << "_else "; // Print the else keyword
-    else_branch->pretty_print_at(ot, prec_none, last_newline_pos); // Pretty-print the else branch
+    // Print the _else part on a new line with proper indentation
+    p.newline(line, indent);
+    p.text("_else "); // Print the else keyword
+    p.pretty_print_at(else_branch, prec_none, line); // Pretty-print the else branch
 
     if (needs_parentheses) {
-        ot << ")"; // Print closing parenthesis if needed
+        p.text(")"); // Print closing parenthesis if needed
     }
 }
 
@@ -424,86 +959,340 @@ void IfExpr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos
 // ====================== EqExpr ======================
 
 
-EqExpr::EqExpr(PTR(Expr) lhs, PTR(Expr) rhs) : lhs(lhs), rhs(rhs) {}
+EqExpr::EqExpr(PTR(Expr) lhs, PTR(Expr) rhs) : Expr(expr_eq), lhs(lhs), rhs(rhs) {}
+
+EqExpr::~EqExpr() {
+    release(lhs);
+    release(rhs);
+}
 
 bool EqExpr::equals(const PTR(Expr) e) {
-    PTR(const EqExpr) eqExpr = CAST(const EqExpr)(e);
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    check_nesting();
+    const EqExpr* eqExpr = expr_cast<const EqExpr>(e);
     return eqExpr && lhs->equals(eqExpr->lhs) && rhs->equals(eqExpr->rhs);
 }
 
 PTR(Val) EqExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_eq);
+    check_nesting();
     PTR(Val) lhsVal = lhs->interp(env);
     PTR(Val) rhsVal = rhs->interp(env);
-    return NEW(BoolVal)(lhsVal->equals(rhsVal));
+    return BoolVal::make(lhsVal->equals(rhsVal));
+}
+
+void EqExpr::compile(Compiler& c) {
+    lhs->compile(c);
+    rhs->compile(c);
+    c.emit(op_eq);
+}
+
+void EqExpr::resolve(Resolver& r) {
+    r.visit(lhs);
+    r.visit(rhs);
+}
+
+void EqExpr::optimize(Optimizer& o, int stage) {
+    if (stage == 0) {
+        o.visit(lhs);
+        o.visit(rhs);
+        o.resume(this, 1);
+        return;
+    }
+    PTR(Expr) r = o.pop();
+    PTR(Expr) l = o.pop();
+    PTR(Expr) e = NEW(EqExpr)(l, r);
+    o.push(Optimizer::is_literal(l) && Optimizer::is_literal(r) ? Optimizer::fold(e) : e);
+}
+
+void EqExpr::intern(ExprInterner& in, int stage) {
+    if (stage == 0) {
+        if (in.owns(*this)) {
+            in.push(THIS);
+            return;
+        }
+        in.visit(lhs);
+        in.visit(rhs);
+        in.resume(this, 1);
+        return;
+    }
+    PTR(Expr) r = in.pop();
+    PTR(Expr) l = in.pop();
+    size_t h = ExprInterner::combine(ExprInterner::combine('=', l->hash()), r->hash());
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        EqExpr* n = expr_cast<EqExpr>(c);
+        if (n && n->lhs == l && n->rhs == r) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(EqExpr)(l, r)));
+}
+
+void EqExpr::encode(Encoder& out) {
+    out.kind(node_eq);
+    out.visit(lhs);
+    out.visit(rhs);
 }
 
 //PTR(Expr) EqExpr::subst(const std::string& var, PTR(Expr) replacement) {
 //    return NEW(EqExpr)(lhs->subst(var, replacement), rhs->subst(var, replacement));
 //}
 
-void EqExpr::printExp(std::ostream& ot) {
-    ot << "(";
-    lhs->printExp(ot);
-    ot << "==";
-    rhs->printExp(ot);
-    ot << ")";
+void EqExpr::print(Printer& p) {
+    p.text("(");
+    p.print(lhs);
+    p.text("==");
+    p.print(rhs);
+    p.text(")");
 }
 
-void EqExpr::pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) {
+void EqExpr::pretty_print_at(Printer& p, precedence_t prec, size_t line) {
     bool needs_parentheses = (prec >= prec_eq);
-    if (needs_parentheses) ot << "(";
-    lhs->pretty_print_at(ot, prec_eq, last_newline_pos);
-    ot << " == ";
-    rhs->pretty_print_at(ot, prec_none, last_newline_pos);
-    if (needs_parentheses) ot << ")";
+    if (needs_parentheses) p.text("(");
+    p.pretty_print_at(lhs, prec_add, line); // + and == share a level and group to the right, so a + on the left needs parentheses
+    p.text(" == ");
+    p.pretty_print_at(rhs, prec_none, line);
+    if (needs_parentheses) p.text(")");
 }
 
 // ====================== FunExpr ======================
 
-FunExpr::FunExpr(const std::string& formal_arg, PTR(Expr) body)
-    : formal_arg(formal_arg), body(body) {}
+FunExpr::FunExpr(Symbol formal_arg, PTR(Expr) body, int frame_size, PTR(Expr) source, int position)
+    : Expr(expr_fun), formal_arg(formal_arg), body(body), frame_size(frame_size), source(source ? source : body), position(position) {}
+
+FunExpr::~FunExpr() {
+    release(body);
+    release(source);
+}
 
 bool FunExpr::equals(const PTR(Expr) e) {
-    PTR(const FunExpr) f = CAST(const FunExpr)(e);
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    check_nesting();
+    const FunExpr* f = expr_cast<const FunExpr>(e);
     return f && formal_arg == f->formal_arg && body->equals(f->body);
 }
 
 PTR(Val) FunExpr::interp(PTR(Env) env) {
-    // Create a closure that captures the current environment
-    return NEW(FunVal)(formal_arg, body, env);
+    ProfileScope profile(prof_fun);
+    if (Profiler::active) {
+        Profiler::active->define_function(&*body, position, formal_arg.str());
+    }
+    if (frame_size == 0) {
+        // Unresolved: the closure captures the whole current environment
+        return NEW(FunVal)(formal_arg, body, env, frame_size, source);
+    }
+
+    // Resolved: the closure copies only the variables its body uses
+    PTR(FunVal) f = NEW(FunVal)(formal_arg, body, env->by_name(), frame_size, source);
+    for (const FreeVar& v : captures) {
+        f->capture(env->lookup_at(v.depth, v.slot, v.name));
+    }
+    return f;
+}
+
+void FunExpr::compile(Compiler& c) {
+    c.emit_fun(formal_arg, body, frame_size, source);
 }
 
-void FunExpr::printExp(std::ostream& ot) {
-    ot << "(_fun (" << formal_arg << ") ";
-    body->printExp(ot);
-    ot << ")";
+void FunExpr::resolve(Resolver& r) {
+    r.open_frame(formal_arg, &captures);
+    r.visit(body);
+    r.close_frame(frame_size);
+}
+
+void FunExpr::optimize(Optimizer& o, int stage) {
+    if (stage == 0) {
+        o.bind(formal_arg, nullptr); // The argument hides any constant of the same name
+        o.visit(body);
+        o.resume(this, 1);
+        return;
+    }
+    o.unbind();
+    o.push(NEW(FunExpr)(formal_arg, o.pop(), 0, source, position));
+}
+
+void FunExpr::intern(ExprInterner& in, int stage) {
+    if (stage == 0) {
+        if (in.owns(*this)) {
+            in.push(THIS);
+            return;
+        }
+        in.visit(body);
+        if (source != body) {
+            in.visit(source);
+        }
+        in.resume(this, 1);
+        return;
+    }
+    PTR(Expr) src = source != body ? in.pop() : nullptr;
+    PTR(Expr) b = in.pop();
+    if (!src) {
+        src = b;
+    }
+    size_t h = ExprInterner::combine('f', std::hash<Symbol>()(formal_arg));
+    h = ExprInterner::combine(ExprInterner::combine(h, b->hash()), src->hash());
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        FunExpr* n = expr_cast<FunExpr>(c);
+        if (n && n->formal_arg == formal_arg && n->body == b && n->source == src) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(FunExpr)(formal_arg, b, 0, src)));
+}
+
+void FunExpr::encode(Encoder& out) {
+    bool unchanged = source == body;
+    if (!unchanged) {
+        try {
+            unchanged = source->equals(body);
+        } catch (const std::runtime_error&) {
+            // Too deep to compare here; writing both bodies is always correct
+        }
+    }
+    if (unchanged) {
+        out.kind(node_fun);
+        out.name(formal_arg);
+        out.visit(body);
+        return;
+    }
+    out.kind(node_fun_folded); // Keep the body as written for FunVal::equals
+    out.name(formal_arg);
+    out.visit(body);
+    out.visit(source);
+}
+
+void FunExpr::print(Printer& p) {
+    p.text("(_fun (");
+    p.text(formal_arg.str());
+    p.text(") ");
+    p.print(body);
+    p.text(")");
 }
 
 // ====================== CallExpr ======================
 
 CallExpr::CallExpr(PTR(Expr) to_be_called, PTR(Expr) actual_arg)
-    : to_be_called(to_be_called), actual_arg(actual_arg) {}
+    : Expr(expr_call), to_be_called(to_be_called), actual_arg(actual_arg) {}
+
+CallExpr::~CallExpr() {
+    release(to_be_called);
+    release(actual_arg);
+}
 
 bool CallExpr::equals(const PTR(Expr) e) {
-    PTR(const CallExpr) c = CAST(const CallExpr)(e);
+    bool same;
+    if (interned_equals(*e, same)) {
+        return same;
+    }
+    check_nesting();
+    const CallExpr* c = expr_cast<const CallExpr>(e);
     return c && to_be_called->equals(c->to_be_called)
            && actual_arg->equals(c->actual_arg);
 }
 
 PTR(Val) CallExpr::interp(PTR(Env) env) {
+    ProfileScope profile(prof_call);
+    check_nesting();
     // 1. Evaluate the function expression in the current environment
     PTR(Val) fun_val = to_be_called->interp(env);
 
     // 2. Evaluate the argument expression in the same environment
     PTR(Val) arg_val = actual_arg->interp(env);
 
-    // 3. Call the function with the argument
-    return fun_val->call(arg_val);
+    // 3. Call the function with the argument. Its body runs here rather than
+    //    in FunVal::call, so that a call in tail position of the body (through
+    //    any _ifs and _lets) can take the body's place instead of recursing:
+    //    tail recursion runs in constant native stack
+    FunVal* f = val_cast<FunVal>(fun_val);
+    Expr* body = f ? f->enter(arg_val, env) : nullptr;
+    if (!body) {
+        return fun_val->call(arg_val);
+    }
+    CallDepth depth; // One for the whole chain of tail calls
+    for (;;) {
+        Expr* e = body;
+        for (Expr* next = e->tail(env); next != e; next = e->tail(env)) {
+            e = next;
+        }
+        CallExpr* call = expr_cast<CallExpr>(e);
+        if (!call) {
+            return e->interp(env);
+        }
+        PTR(Val) tail_fun = call->to_be_called->interp(env);
+        PTR(Val) tail_arg = call->actual_arg->interp(env);
+        f = val_cast<FunVal>(tail_fun);
+        body = f ? f->enter(tail_arg, env) : nullptr;
+        if (!body) {
+            return tail_fun->call(tail_arg);
+        }
+        fun_val = tail_fun; // Keeps the body being evaluated alive
+    }
+}
+
+void CallExpr::compile(Compiler& c) {
+    to_be_called->compile(c);
+    actual_arg->compile(c);
+    c.emit(op_call);
+}
+
+void CallExpr::resolve(Resolver& r) {
+    r.visit(to_be_called);
+    r.visit(actual_arg);
+}
+
+void CallExpr::optimize(Optimizer& o, int stage) {
+    if (stage == 0) {
+        o.visit(to_be_called);
+        o.visit(actual_arg);
+        o.resume(this, 1);
+        return;
+    }
+    PTR(Expr) a = o.pop();
+    PTR(Expr) f = o.pop();
+    o.push(NEW(CallExpr)(f, a));
+}
+
+void CallExpr::intern(ExprInterner& in, int stage) {
+    if (stage == 0) {
+        if (in.owns(*this)) {
+            in.push(THIS);
+            return;
+        }
+        in.visit(to_be_called);
+        in.visit(actual_arg);
+        in.resume(this, 1);
+        return;
+    }
+    PTR(Expr) a = in.pop();
+    PTR(Expr) f = in.pop();
+    size_t h = ExprInterner::combine(ExprInterner::combine('c', f->hash()), a->hash());
+    for (PTR(Expr) const& c : in.candidates(h)) {
+        CallExpr* n = expr_cast<CallExpr>(c);
+        if (n && n->to_be_called == f && n->actual_arg == a) {
+            in.push(c);
+            return;
+        }
+    }
+    in.push(in.add(h, NEW(CallExpr)(f, a)));
+}
+
+void CallExpr::encode(Encoder& out) {
+    out.kind(node_call);
+    out.visit(to_be_called);
+    out.visit(actual_arg);
 }
 
-void CallExpr::printExp(std::ostream& ot) {
-    to_be_called->printExp(ot);
-    ot << "(";
-    actual_arg->printExp(ot);
-    ot << ")";
+void CallExpr::print(Printer& p) {
+    p.print(to_be_called);
+    p.text("(");
+    p.print(actual_arg);
+    p.text(")");
 }
\ No newline at end of file
@@ -12,13 +12,23 @@
 #define EXPR_H
 
 #include <string>
+#include <vector>
 #include <stdexcept> // For std::runtime_error
-#include <sstream>   // For std::stringstream
+#include "writer.h"   // For Writer
+#include "bignum.h"   // For BigInt
 #include "pointer.h"
+#include "symbol.h"   // For Symbol
 #include "val.h"
 #include "parse.hpp"
 #include "env.h"
 
+class Compiler;
+class Resolver;
+class Printer;
+class Optimizer;
+class ExprInterner;
+class Encoder;
+
 /**
  * @enum precedence_t
  * @brief Enumeration for precedence levels in pretty printing.
@@ -33,6 +43,23 @@ typedef enum {
     prec_mult       ///< Precedence level for multiplication (*).
 } precedence_t;
 
+/**
+ * @brief The concrete class of an Expr, stored in every node (see expr_cast).
+ */
+typedef enum {
+    expr_num,
+    expr_big_num,
+    expr_add,
+    expr_mult,
+    expr_var,
+    expr_let,
+    expr_bool,
+    expr_if,
+    expr_eq,
+    expr_fun,
+    expr_call
+} expr_t;
+
 /**
  * @class Expr
  * @brief Abstract base class for expressions.
@@ -42,12 +69,18 @@ typedef enum {
  */
 CLASS(Expr) {
 public:
+    const expr_t type; ///< Which subclass this is; each one's tag.
+
+    explicit Expr(expr_t type) : type(type) {}
+
     virtual ~Expr() = default;
 
     /**
      * @brief Checks if this expression is equal to another expression.
      * @param e The expression to compare with.
      * @return true if the expressions are equal, false otherwise.
+     * @throws std::runtime_error "expression nested too deeply" if comparing
+     *         would need more native stack than is left (see StackGuard).
      */
     virtual bool equals(const PTR(Expr) e) = 0;
 
@@ -57,6 +90,60 @@ public:
      */
     virtual PTR(Val) interp(PTR(Env) env) = 0;
 
+    /**
+     * @brief Evaluates the part of this expression that comes before its tail.
+     *
+     * An _if evaluates its condition and a _let its right-hand side; each
+     * returns the subexpression that gives its value, with `env` set to the
+     * environment to evaluate it in. Other expressions are their own tail and
+     * return this. CallExpr::interp uses it to find calls in tail position.
+     *
+     * @param env The environment; replaced by the tail's environment.
+     * @return The expression whose value is this expression's value.
+     */
+    virtual Expr* tail(PTR(Env)& env);
+
+    /**
+     * @brief Emits bytecode for this expression (see vm.h).
+     * @param c The compiler collecting the instructions.
+     */
+    virtual void compile(Compiler& c) = 0;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots (see resolve.h).
+     * @param r The resolver tracking the bindings in scope.
+     */
+    virtual void resolve(Resolver& r) = 0;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression (see optimize.h).
+     *
+     * Stage 0 runs when the optimizer reaches the expression; it schedules
+     * subexpressions with o.visit() and a later stage with o.resume(). The
+     * last stage pushes a new, unresolved expression with the same meaning.
+     *
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    virtual void optimize(Optimizer& o, int stage) = 0;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression (see hashcons.h).
+     *
+     * Scheduled in stages like optimize(); the last stage pushes the one
+     * node in `in` structurally equal to this expression.
+     *
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    virtual void intern(ExprInterner& in, int stage) = 0;
+
+    /**
+     * @brief Writes this expression as part of a compiled program (see encode.h).
+     * @param out The encoder; subexpressions are scheduled on it with visit().
+     */
+    virtual void encode(Encoder& out) = 0;
+
     /**
      * @brief Substitutes a variable with another expression.
      * @param var The variable to substitute.
@@ -66,10 +153,16 @@ public:
 //    virtual PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) = 0;
 
     /**
-     * @brief Prints the expression to an output stream.
-     * @param ot The output stream to print to.
+     * @brief Prints the expression to a writer.
+     * @param ot The writer to print to.
      */
-    virtual void printExp(std::ostream& ot) = 0;
+    void printExp(Writer& ot);
+
+    /**
+     * @brief Schedules the expression's parts on a Printer (see printer.h).
+     * @param p The printer.
+     */
+    virtual void print(Printer& p) = 0;
 
     /**
      * @ brief Coverts the expression to a string.
@@ -84,21 +177,84 @@ public:
     std::string to_pretty_string();
 
     /**
-     * @brief Pretty-prints the expression to an output stream with proper precedence handling.
-     * @param ot The output stream to print to.
+     * @brief Pretty-prints the expression to a writer with proper precedence handling.
+     * @param ot The writer to print to.
      * @param prec The precedence level of the parent expression.
      */
-    virtual void pretty_print(std::ostream& ot, precedence_t prec);
+    void pretty_print(Writer& ot, precedence_t prec);
 
 	/**
- 	 * @brief Pretty-prints the expression at a specific precedence level.
- 	 * @param ot The output stream to print to.
+ 	 * @brief Schedules the expression's pretty-printed parts at a specific precedence level.
+ 	 * @param p The printer.
  	 * @param prec The precedence level of the parent expression.
-	 * @param last_newline_pos The position of the last newline in the output stream.
+	 * @param line The printer's record of where the current line starts.
  	 */
-    virtual void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos);
+    virtual void pretty_print_at(Printer& p, precedence_t prec, size_t line);
+
+    /**
+     * @brief Checks whether this node is owned by an ExprInterner.
+     *
+     * Interned nodes are shared between every place the same subtree occurs,
+     * so they are never resolved and look their variables up by name.
+     */
+    bool is_interned() const;
+
+    /**
+     * @brief Structural hash of an interned expression (0 if not interned).
+     */
+    size_t hash() const;
+
+protected:
+    friend class ExprInterner;
+
+    size_t hash_code = 0;   ///< Structural hash, set when interned.
+    size_t interner_id = 0; ///< Id of the ExprInterner owning this node, or 0.
+
+    /**
+     * @brief The O(1) part of equals() for interned expressions.
+     *
+     * Two nodes of the same interner are equal exactly when they are the
+     * same node, and interned nodes with different hashes are never equal.
+     *
+     * @param e The expression being compared with this one.
+     * @param result Set to the answer when no structural walk is needed.
+     * @return true if result was set.
+     */
+    bool interned_equals(const Expr& e, bool& result) const;
+
+    /**
+     * @brief Drops a reference to a subexpression with bounded recursion.
+     *
+     * Destroying a deep tree through nested shared_ptr destructors needs
+     * native stack for every level. Up to max_release_depth nested
+     * releases destroy their subexpression at once; deeper ones are queued
+     * and destroyed by the outermost release on the thread. Nothing to do
+     * in the plain and arena pointer modes, whose node destructors never
+     * free children.
+     *
+     * @param child The subexpression; left null.
+     */
+    static void release(PTR(Expr)& child);
+
+    static const int max_release_depth = 1000; ///< Most nested releases before queueing.
 };
 
+/**
+ * @brief Downcasts an expression by comparing its type tag, without RTTI.
+ *
+ * Unlike CAST, the result is a plain pointer, so in shared_ptr mode no
+ * reference count is touched; it stays valid as long as e does.
+ *
+ * @tparam T An Expr subclass; const when e points to a const Expr.
+ * @param e Any pointer to an expression (equals() takes a `const PTR(Expr)`,
+ *          which is a pointer to const in the raw pointer modes), or null.
+ * @return e as a T, or nullptr if e is null or not a T.
+ */
+template <class T, class P>
+T* expr_cast(const P& e) {
+    return e && e->type == T::tag ? static_cast<T*>(&*e) : nullptr;
+}
+
 /**
  * @class NumExpr
  * @brief Represents a numeric expression.
@@ -108,6 +264,8 @@ public:
 class NumExpr : public Expr {
     int value; ///< The numeric value of this expression.
 public:
+    static constexpr expr_t tag = expr_num; ///< This class's Expr::type.
+
     /**
      * @brief Constructs a numeric expression.
      * @param value The numeric value.
@@ -127,6 +285,38 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression.
      * @param var The variable to substitute.
@@ -136,10 +326,76 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the number expression to an output stream.
-     * @param ot The output stream to print to.
+     * @brief Schedules the number expression's parts on a printer.
+     * @param p The printer.
+     */
+    void print(Printer& p) override;
+};
+
+/**
+ * @class BigNumExpr
+ * @brief Represents an integer literal too large for an int (--bignum).
+ *
+ * The parser only creates one for a literal outside the range of an int,
+ * so a number has a single representation, as with BigNumVal.
+ */
+class BigNumExpr : public Expr {
+    BigInt value;       ///< The numeric value of this expression.
+    std::string digits; ///< The value in decimal, kept for printing.
+public:
+    static constexpr expr_t tag = expr_big_num; ///< This class's Expr::type.
+
+    /**
+     * @brief Constructs a large numeric literal.
+     * @param value The numeric value.
+     */
+    BigNumExpr(const BigInt& value);
+
+    /**
+     * @brief Checks if this expression is a big number literal with the same value.
+     */
+    bool equals(const PTR(Expr) e) override;
+
+    /**
+     * @brief Interprets the literal by returning its value.
+     * @return A BigNumVal object representing the number.
+     */
+    PTR(Val) interp(PTR(Env) env) override;
+
+    /**
+     * @brief The bytecode VM only has int numbers.
+     * @throws std::runtime_error Always.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Does nothing; numbers contain no variables.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Pushes this literal, which is already folded.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
+    /**
+     * @brief Schedules the literal's digits on a printer.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 };
 
 /**
@@ -153,6 +409,8 @@ class AddExpr : public Expr {
     PTR(Expr) rhs; ///< The right-hand side expression.
 
 public:
+    static constexpr expr_t tag = expr_add; ///< This class's Expr::type.
+
     /**
      * @brief Constructs an addition expression.
      *
@@ -161,6 +419,11 @@ public:
      */
     AddExpr(PTR(Expr) lhs, PTR(Expr) rhs);
 
+    /**
+     * @brief Releases the subexpressions without recursing (see Expr::release).
+     */
+    ~AddExpr() override;
+
     /**
      * @brief Checks if this addition expression is equal to another expression.
      * @param e The expression to compare with.
@@ -174,6 +437,38 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in both sub-expressions.
      * @param var The variable to substitute.
@@ -183,18 +478,18 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the addition expression to an output stream.
-     * @param ot The output stream to print to.
+     * @brief Schedules the addition expression's parts on a printer.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 
     /**
-     * @brief Pretty-prints the addition expression with proper precedence handling.
-     * @param ot The output stream to print to.
+     * @brief Schedules the addition expression's pretty-printed parts with proper precedence handling.
+     * @param p The printer.
      * @param prec The precedence level of the parent expression.
-     * @param last_newline_pos The position of the last newline in the output stream.
+     * @param line The printer's record of where the current line starts.
      */
-    void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+    void pretty_print_at(Printer& p, precedence_t prec, size_t line) override;
 
 };
 
@@ -209,6 +504,8 @@ class MultExpr : public Expr {
     PTR(Expr) rhs; ///< The right-hand side expression.
 
 public:
+    static constexpr expr_t tag = expr_mult; ///< This class's Expr::type.
+
     /**
      * @brief Constructs a multiplication expression.
      *
@@ -217,6 +514,11 @@ public:
      */
     MultExpr(PTR(Expr) lhs, PTR(Expr) rhs);
 
+    /**
+     * @brief Releases the subexpressions without recursing (see Expr::release).
+     */
+    ~MultExpr() override;
+
     /**
      * @brief Checks if this multiplication expression is equal to another expression.
      * @param e The expression to compare with.
@@ -230,6 +532,38 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in both sub-expressions.
      * @param var The variable to substitute.
@@ -239,18 +573,18 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the multiplication expression to an output stream.
-     * @param ot The output stream to print to.
+     * @brief Schedules the multiplication expression's parts on a printer.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 
     /**
-     * @brief Pretty-prints the multiplication expression with proper precedence handling.
-     * @param ot The output stream to print to.
+     * @brief Schedules the multiplication expression's pretty-printed parts with proper precedence handling.
+     * @param p The printer.
      * @param prec The precedence level of the parent expression.
-     * @param last_newline_pos The position of the last newline in the output stream.
+     * @param line The printer's record of where the current line starts.
      */
-    void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+    void pretty_print_at(Printer& p, precedence_t prec, size_t line) override;
 };
 
 /**
@@ -260,15 +594,19 @@ public:
  * This class represents an expression that consists of a variable.
  */
 class VarExpr : public Expr {
-    std::string name; ///< The name of the variable.
+    Symbol name;    ///< The name of the variable.
+    int depth = -1; ///< Frames between this use and its binding (-1: unresolved).
+    int slot = -1;  ///< Slot of the binding in that frame (-1: unresolved).
 
 public:
+    static constexpr expr_t tag = expr_var; ///< This class's Expr::type.
+
     /**
      * @brief Constructs a variable expression.
      *
      * @param name The name of the variable.
      */
-    VarExpr(const std::string& name);
+    VarExpr(Symbol name);
 
     /**
      * @brief Checks if this variable expression is equal to another expression.
@@ -283,6 +621,38 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes the variable with a replacement expression if it matches the variable name.
      * @param var The variable to substitute.
@@ -292,18 +662,22 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the variable expression to an output stream.
-     * @param ot The output stream to print to.
+     * @brief Schedules the variable expression's parts on a printer.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 };
 
 class LetExpr : public Expr {
-    std::string var;       // The variable to bind
+    Symbol var;                // The variable to bind
     PTR(Expr) rhs;             // The right-hand side expression
     PTR(Expr) body;            // The body expression
+    int slot = -1;             // Frame slot for var (-1: unresolved, use ExtendedEnv)
+    int frame_size = 0;        // Non-zero if this _let opens its own frame
 
 public:
+    static constexpr expr_t tag = expr_let; ///< This class's Expr::type.
+
     /**
      * @brief Constructs a let expression.
      *
@@ -311,7 +685,12 @@ public:
      * @param rhs The right-hand side expression.
      * @param body The body expression.
      */
-    LetExpr(const std::string& var, PTR(Expr) rhs, PTR(Expr) body);
+    LetExpr(Symbol var, PTR(Expr) rhs, PTR(Expr) body);
+
+    /**
+     * @brief Releases the subexpressions without recursing (see Expr::release).
+     */
+    ~LetExpr() override;
 
     /**
      * @brief Checks if this let expression is equal to another expression.
@@ -326,6 +705,44 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Evaluates the right-hand side and returns the body.
+     * @param env The environment; replaced by the one binding the variable.
+     */
+    Expr* tail(PTR(Env)& env) override;
+
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in the let expression.
      * @param var The variable to substitute.
@@ -335,25 +752,18 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the let expression to an output stream.
-     * @param ot The output stream to print to.
-     */
-    void printExp(std::ostream& ot) override;
-
-    /**
-     * @brief Pretty-prints the let expression with proper indentation.
-     * @param ot The output stream to print to.
-     * @param prec The precedence level of the parent expression.
+     * @brief Schedules the let expression's parts on a printer.
+     * @param p The printer.
      */
-    void pretty_print(std::ostream& ot, precedence_t prec) override;
+    void print(Printer& p) override;
 
     /**
-     * @brief Pretty-prints the let expression with proper indentation and precedence handling.
-     * @param ot The output stream to print to.
+     * @brief Schedules the let expression's pretty-printed parts with proper indentation and precedence handling.
+     * @param p The printer.
      * @param prec The precedence level of the parent expression.
-     * @param last_newline_pos The position of the last newline in the output stream.
+     * @param line The printer's record of where the current line starts.
      */
-    void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+    void pretty_print_at(Printer& p, precedence_t prec, size_t line) override;
 };
 
 /**
@@ -364,6 +774,8 @@ public:
  */
 class BoolExpr : public Expr {
 public:
+    static constexpr expr_t tag = expr_bool; ///< This class's Expr::type.
+
     /**
      * @brief Constructs a boolean expression.
      *
@@ -386,6 +798,38 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in the boolean expression.
      *
@@ -396,20 +840,20 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the boolean expression to an output stream.
+     * @brief Schedules the boolean expression's parts on a printer.
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 
     /**
-     * @brief Pretty-prints the boolean expression with proper indentation and precedence handling.
+     * @brief Schedules the boolean expression's pretty-printed parts with proper indentation and precedence handling.
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      * @param prec The precedence level of the parent expression.
-     * @param last_newline_pos The position of the last newline in the output stream.
+     * @param line The printer's record of where the current line starts.
      */
-    void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+    void pretty_print_at(Printer& p, precedence_t prec, size_t line) override;
 
 private:
     bool value; // The boolean value (true or false).
@@ -423,6 +867,8 @@ private:
  */
 class IfExpr : public Expr {
 public:
+    static constexpr expr_t tag = expr_if; ///< This class's Expr::type.
+
     /**
      * @brief Constructs an if-then-else expression.
      *
@@ -432,6 +878,11 @@ public:
      */
     IfExpr(PTR(Expr) condition, PTR(Expr) then_branch, PTR(Expr) else_branch);
 
+    /**
+     * @brief Releases the subexpressions without recursing (see Expr::release).
+     */
+    ~IfExpr() override;
+
     /**
      * @brief Checks if this if-then-else expression is equal to another expression.
      *
@@ -447,6 +898,44 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Evaluates the condition and returns the branch it selects.
+     * @param env The environment, which the branch shares.
+     */
+    Expr* tail(PTR(Env)& env) override;
+
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in the if-then-else expression.
      *
@@ -457,28 +946,20 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the if-then-else expression to an output stream.
+     * @brief Schedules the if-then-else expression's parts on a printer.
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 
     /**
-     * @brief Pretty-prints the if-then-else expression with proper indentation.
+     * @brief Schedules the if-then-else expression's pretty-printed parts with proper indentation and precedence handling.
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      * @param prec The precedence level of the parent expression.
+     * @param line The printer's record of where the current line starts.
      */
-    void pretty_print(std::ostream& ot, precedence_t prec) override;
-
-    /**
-     * @brief Pretty-prints the if-then-else expression with proper indentation and precedence handling.
-     *
-     * @param ot The output stream to print to.
-     * @param prec The precedence level of the parent expression.
-     * @param last_newline_pos The position of the last newline in the output stream.
-     */
-    void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+    void pretty_print_at(Printer& p, precedence_t prec, size_t line) override;
 
 private:
     PTR(Expr) condition;    // The condition expression.
@@ -494,6 +975,8 @@ private:
  */
 class EqExpr : public Expr {
 public:
+    static constexpr expr_t tag = expr_eq; ///< This class's Expr::type.
+
     /**
      * @brief Constructs an equality expression.
      *
@@ -502,6 +985,11 @@ public:
      */
     EqExpr(PTR(Expr) lhs, PTR(Expr) rhs);
 
+    /**
+     * @brief Releases the subexpressions without recursing (see Expr::release).
+     */
+    ~EqExpr() override;
+
     /**
      * @brief Checks if this equality expression is equal to another expression.
      *
@@ -517,6 +1005,38 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in the equality expression.
      *
@@ -527,26 +1047,36 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the equality expression to an output stream.
+     * @brief Schedules the equality expression's parts on a printer.
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 
     /**
-     * @brief Pretty-prints the equality expression with proper indentation and precedence handling.
+     * @brief Schedules the equality expression's pretty-printed parts with proper indentation and precedence handling.
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      * @param prec The precedence level of the parent expression.
-     * @param last_newline_pos The position of the last newline in the output stream.
+     * @param line The printer's record of where the current line starts.
      */
-    void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+    void pretty_print_at(Printer& p, precedence_t prec, size_t line) override;
 
 private:
     PTR(Expr) lhs; // The left-hand side expression.
     PTR(Expr) rhs; // The right-hand side expression.
 };
 
+/**
+ * @struct FreeVar
+ * @brief A variable that a resolved function's body uses from an enclosing scope.
+ */
+struct FreeVar {
+    Symbol name; ///< The variable's name.
+    int depth;   ///< Where the scope creating the closure finds it,
+    int slot;    ///< as a VarExpr's depth and slot (see Env::lookup_at).
+};
+
 /**
  * @class FunExpr
  * @brief Represents a function definition expression.
@@ -555,17 +1085,34 @@ private:
  * Functions are first-class values that can be passed as arguments and returned from other functions.
  */
 class FunExpr : public Expr {
-    std::string formal_arg; ///< The formal argument name of the function
+    Symbol formal_arg;          ///< The formal argument name of the function
     PTR(Expr) body;             ///< The body expression of the function
+    int frame_size;             ///< Slots in a call's frame, or 0 if the body is unresolved
+    PTR(Expr) source;           ///< The body as written; function values compare by it
+    int position;               ///< Byte offset of the _fun in the source, or -1 (for --profile)
+    std::vector<FreeVar> captures; ///< What a closure copies from its scope, set by the Resolver
 
 public:
+    static constexpr expr_t tag = expr_fun; ///< This class's Expr::type.
+
     /**
      * @brief Constructs a function expression.
      *
      * @param formal_arg The name of the formal argument.
      * @param body The body expression of the function.
+     * @param frame_size Frame size of an already resolved body (0 if unresolved).
+     * @param source The body as originally written, if body is an optimized
+     *        copy of it (nullptr: body itself). FunVal::equals compares sources,
+     *        so optimizing a function never changes what it is equal to.
+     * @param position Byte offset of the _fun in the source, if known; --profile reports functions by it.
+     */
+    FunExpr(Symbol formal_arg, PTR(Expr) body, int frame_size = 0,
+            PTR(Expr) source = nullptr, int position = -1);
+
+    /**
+     * @brief Releases the subexpressions without recursing (see Expr::release).
      */
-    FunExpr(const std::string& formal_arg, PTR(Expr) body);
+    ~FunExpr() override;
 
     /**
      * @brief Checks if this function expression is equal to another expression.
@@ -578,10 +1125,45 @@ public:
     /**
      * @brief Interprets the function expression by creating a function value.
      *
+     * A resolved function value copies just the variables in captures; an
+     * unresolved one keeps the whole environment.
+     *
      * @return A FunVal object representing the function.
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in the function body.
      *
@@ -594,13 +1176,13 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the function expression to an output stream.
+     * @brief Schedules the function expression's parts on a printer.
      *
      * Follows the format: (_fun (formal_arg) body)
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 };
 
 /**
@@ -614,6 +1196,8 @@ class CallExpr : public Expr {
     PTR(Expr) actual_arg;   ///< The argument expression to pass to the function
 
 public:
+    static constexpr expr_t tag = expr_call; ///< This class's Expr::type.
+
     /**
      * @brief Constructs a function call expression.
      *
@@ -622,6 +1206,11 @@ public:
      */
     CallExpr(PTR(Expr) to_be_called, PTR(Expr) actual_arg);
 
+    /**
+     * @brief Releases the subexpressions without recursing (see Expr::release).
+     */
+    ~CallExpr() override;
+
     /**
      * @brief Checks if this call expression is equal to another expression.
      *
@@ -639,6 +1228,38 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Emits bytecode for this expression.
+     * @param c The compiler collecting the instructions.
+     */
+    void compile(Compiler& c) override;
+
+    /**
+     * @brief Resolves the variables in this expression to frame slots.
+     * @param r The resolver tracking the bindings in scope.
+     */
+    void resolve(Resolver& r) override;
+
+    /**
+     * @brief Takes one step of building a constant-folded copy of this expression.
+     * @param o The optimizer tracking the constants in scope.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void optimize(Optimizer& o, int stage) override;
+
+    /**
+     * @brief Takes one step of finding or creating the interned node for this expression.
+     * @param in The interner that owns the result.
+     * @param stage 0, or a stage this expression scheduled.
+     */
+    void intern(ExprInterner& in, int stage) override;
+
+    /**
+     * @brief Writes this expression as part of a compiled program.
+     * @param out The encoder.
+     */
+    void encode(Encoder& out) override;
+
     /**
      * @brief Substitutes a variable with a replacement expression in both
      *        the function and argument expressions.
@@ -650,13 +1271,13 @@ public:
 //    PTR(Expr) subst(const std::string& var, PTR(Expr) replacement) override;
 
     /**
-     * @brief Prints the function call expression to an output stream.
+     * @brief Schedules the function call expression's parts on a printer.
      *
      * Follows the format: function(arg)
      *
-     * @param ot The output stream to print to.
+     * @param p The printer.
      */
-    void printExp(std::ostream& ot) override;
+    void print(Printer& p) override;
 };
 
 #endif // EXPR_H
\ No newline at end of file
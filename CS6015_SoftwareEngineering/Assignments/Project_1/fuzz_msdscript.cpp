@@ -0,0 +1,513 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+// A differential fuzzer that runs every evaluator in this process.
+//
+//   fuzz_msdscript [-runs=N] [-max_total_time=S] [-seed=N] [-max_len=N] [-workers=N]
+//       Generates random programs of _let, _fun, _if, calls, arithmetic and
+//       comparisons, and checks that every way of running each one agrees
+//       with the tree-walker looking variables up by name: resolved frames,
+//       the bytecode VM, the optimizer, a compiled program decoded again,
+//       hash-consing and memoization, and that printing and pretty printing
+//       parse back to the same program. Stops at the first disagreement,
+//       shrinks it, prints it and saves its input as crash-<seed>-<run>.
+//       Reports executions per second as it goes. With -workers, that many
+//       processes fuzz at once (seeds seed, seed + 1, ...), splitting -runs.
+//
+//   fuzz_msdscript file...
+//       Checks saved inputs again.
+//
+// A program is built from a string of bytes, each byte choosing the next
+// production, so the checker is also a libFuzzer target: compiled with
+// -DMSDSCRIPT_LIBFUZZER and clang's -fsanitize=fuzzer (make
+// fuzz_msdscript_libfuzzer), main is left out and libFuzzer drives it.
+//
+// Generated programs are typed apart from deliberate errors, and function
+// arguments are always numbers, so no function can ever be applied to
+// itself: every program terminates.
+
+#include "expr.h"
+#include "val.h"
+#include "env.h"
+#include "parse.hpp"
+#include "lexer.h"
+#include "vm.h"
+#include "optimize.h"
+#include "hashcons.h"
+#include "encode.h"
+#include "memo.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// The choices that build a program. Past the end of the input every choice
+// is 0, which always picks the smallest production, so any input builds a
+// program and a shorter input builds a smaller one.
+class Choices {
+public:
+    Choices(const uint8_t* data, size_t size) : data(data), size(size), pos(0) {}
+
+    int pick(int n) {
+        return pos < size ? data[pos++] % n : 0;
+    }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+};
+
+// Types of generated expressions: fun1 takes a number to a number, fun2 a
+// number to a fun1, which makes closures over arguments of enclosing calls
+typedef enum { ty_int, ty_bool, ty_fun1, ty_fun2, ty_count } type_t;
+
+class Generator {
+public:
+    explicit Generator(Choices& in) : in(in) {}
+
+    std::string gen(type_t t, int depth) {
+        if (depth >= max_depth) {
+            return leaf(t);
+        }
+        switch (t) {
+            case ty_int:
+                return gen_int(depth + 1);
+            case ty_bool:
+                return gen_bool(depth + 1);
+            default:
+                return gen_fun(t, depth + 1);
+        }
+    }
+
+private:
+    static const int max_depth = 7;
+
+    Choices& in;
+    std::vector<std::pair<std::string, type_t>> scope; // Bindings, innermost last
+
+    std::string number() {
+        static const char* const edges[] = {"2147483647", "-2147483647", "65536", "46341", "-1"};
+        switch (in.pick(8)) {
+            case 0:
+                return "0";
+            case 6:
+                return "-" + std::to_string(1 + in.pick(10));
+            case 7:
+                return edges[in.pick(5)];
+            default:
+                return std::to_string(in.pick(10));
+        }
+    }
+
+    // A variable whose innermost binding has type t, or "" if there is none
+    std::string var(type_t t) {
+        std::vector<std::string> visible;
+        for (size_t i = 0; i < scope.size(); i++) {
+            bool shadowed = false;
+            for (size_t j = i + 1; j < scope.size() && !shadowed; j++) {
+                shadowed = scope[j].first == scope[i].first;
+            }
+            if (!shadowed && scope[i].second == t) {
+                visible.push_back(scope[i].first);
+            }
+        }
+        return visible.empty() ? "" : visible[in.pick((int)visible.size())];
+    }
+
+    std::string name() {
+        static const char* const names[] = {"x", "y", "z", "f", "g"};
+        return names[in.pick(5)];
+    }
+
+    std::string leaf(type_t t) {
+        std::string v = in.pick(2) ? var(t) : "";
+        if (!v.empty()) {
+            return v;
+        }
+        switch (t) {
+            case ty_int:
+                return number();
+            case ty_bool:
+                return in.pick(2) ? "_true" : "_false";
+            case ty_fun1:
+                return "(_fun (" + name() + ") " + number() + ")";
+            default:
+                return "(_fun (" + name() + ") _fun (" + name() + ") " + number() + ")";
+        }
+    }
+
+    std::string let(type_t t, int depth) {
+        type_t bound = (type_t)in.pick(ty_count);
+        std::string v = name();
+        std::string rhs = gen(bound, depth);
+        scope.push_back({v, bound});
+        std::string body = gen(t, depth);
+        scope.pop_back();
+        return "(_let " + v + " = " + rhs + " _in " + body + ")";
+    }
+
+    std::string branch(type_t t, int depth) {
+        std::string test = gen(ty_bool, depth);
+        std::string yes = gen(t, depth);
+        return "(_if " + test + " _then " + yes + " _else " + gen(t, depth) + ")";
+    }
+
+    std::string call(type_t fun, int depth) {
+        std::string f = gen(fun, depth);
+        return "(" + f + ")(" + gen(ty_int, depth) + ")";
+    }
+
+    std::string binary(const char* op, type_t t, int depth) {
+        std::string lhs = gen(t, depth);
+        return "(" + lhs + " " + op + " " + gen(t, depth) + ")";
+    }
+
+    std::string gen_int(int depth) {
+        switch (in.pick(16)) {
+            case 0:
+            case 1:
+                return leaf(ty_int);
+            case 2:
+            case 3:
+            case 4:
+                return binary("+", ty_int, depth);
+            case 5:
+            case 6:
+                return binary("*", ty_int, depth);
+            case 7:
+            case 8:
+                return let(ty_int, depth);
+            case 9:
+            case 10:
+                return branch(ty_int, depth);
+            case 11:
+            case 12:
+                return call(ty_fun1, depth);
+            case 13:
+                return gen((type_t)(1 + in.pick(ty_count - 1)), depth); // A type error
+            case 14:
+                return "w"; // Never bound: a free variable
+            default:
+                return call(ty_int, depth); // Calling a number
+        }
+    }
+
+    std::string gen_bool(int depth) {
+        switch (in.pick(7)) {
+            case 0:
+                return leaf(ty_bool);
+            case 1:
+            case 2:
+                return binary("==", ty_int, depth);
+            case 3:
+                return binary("==", ty_bool, depth);
+            case 4:
+                return binary("==", (type_t)(ty_fun1 + in.pick(2)), depth);
+            case 5:
+                return branch(ty_bool, depth);
+            default:
+                return let(ty_bool, depth);
+        }
+    }
+
+    std::string gen_fun(type_t t, int depth) {
+        switch (in.pick(t == ty_fun1 ? 5 : 4)) {
+            case 0:
+                return leaf(t);
+            case 1: {
+                std::string v = name();
+                scope.push_back({v, ty_int});
+                std::string body = gen(t == ty_fun1 ? ty_int : ty_fun1, depth);
+                scope.pop_back();
+                return "(_fun (" + v + ") " + body + ")";
+            }
+            case 2:
+                return let(t, depth);
+            case 3:
+                return branch(t, depth);
+            default:
+                return call(ty_fun2, depth);
+        }
+    }
+};
+
+static std::string program(const uint8_t* data, size_t size) {
+    Choices in(data, size);
+    return Generator(in).gen(ty_int, 0);
+}
+
+// The printed value, or the error, so that results and failures compare alike
+static std::string outcome(const std::function<PTR(Val)()>& run) {
+    try {
+        return run()->to_string();
+    } catch (const std::exception& ex) {
+        return std::string("error: ") + ex.what();
+    }
+}
+
+// Runs a program every way there is; returns "" if they all agree, or a
+// description of the first that does not
+static std::string check(const std::string& src) {
+    PTR(Expr) by_name;
+    PTR(Expr) resolved;
+    try {
+        Lexer lex(src);
+        by_name = parse_expr(lex);
+        resolved = parse(std::string_view(src));
+    } catch (const std::exception& ex) {
+        return std::string("parse: ") + ex.what() + "\n";
+    }
+
+    std::string expected = outcome([&] { return by_name->interp(Env::empty); });
+    std::string failure;
+    auto compare = [&](const char* how, const std::function<PTR(Val)()>& run) {
+        if (failure.empty()) {
+            std::string got = outcome(run);
+            if (got != expected) {
+                failure = std::string(how) + ": " + got + "\n  by name: " + expected + "\n";
+            }
+        }
+    };
+
+    compare("resolved ", [&] { return resolved->interp(Env::empty); });
+    compare("vm       ", [&] { return vm_interp(resolved); });
+    compare("optimized", [&] { return Optimizer::optimize(resolved)->interp(Env::empty); });
+    compare("compiled ", [&] {
+        std::string bytes = Encoder::encode(resolved);
+        return Decoder(bytes).decode()->interp(Env::empty);
+    });
+    compare("interned ", [&] {
+        ExprInterner in;
+        return in.intern(by_name)->interp(Env::empty);
+    });
+    CallCache::enable(true);
+    compare("memoized ", [&] { return resolved->interp(Env::empty); });
+    CallCache::enable(false);
+    if (!failure.empty()) {
+        return failure;
+    }
+
+    std::string printed = by_name->to_string();
+    std::string pretty = by_name->to_pretty_string();
+    try {
+        if (parse_str(printed)->to_string() != printed) {
+            return "print: " + printed + " parses back differently\n";
+        }
+        if (parse_str(pretty)->to_string() != printed) {
+            return "pretty print: " + pretty + "\n  parses back as " + parse_str(pretty)->to_string() + "\n";
+        }
+    } catch (const std::exception& ex) {
+        return std::string("printed program does not parse: ") + ex.what() + "\n" + printed + "\n" + pretty + "\n";
+    }
+    return "";
+}
+
+static std::string check(const std::vector<uint8_t>& input) {
+    return check(program(input.data(), input.size()));
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string src = program(data, size);
+    std::string failure = check(src);
+    if (!failure.empty()) {
+        std::cerr << src << "\n" << failure;
+        abort(); // libFuzzer saves and minimizes the input
+    }
+    return 0;
+}
+
+#ifndef MSDSCRIPT_LIBFUZZER
+
+// A smallest input that still fails: deletes chunks, largest first, then
+// lowers single bytes, for as long as either makes progress
+static std::vector<uint8_t> shrink(std::vector<uint8_t> input) {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t chunk = input.size() / 2; chunk > 0; chunk /= 2) {
+            for (size_t at = 0; at + chunk <= input.size();) {
+                std::vector<uint8_t> smaller(input);
+                smaller.erase(smaller.begin() + at, smaller.begin() + at + chunk);
+                if (!check(smaller).empty()) {
+                    input = smaller;
+                    progress = true;
+                } else {
+                    at += chunk;
+                }
+            }
+        }
+        for (size_t i = 0; i < input.size(); i++) {
+            for (uint8_t lower : {(uint8_t)0, (uint8_t)(input[i] / 2), (uint8_t)(input[i] - 1)}) {
+                if (lower >= input[i]) {
+                    continue;
+                }
+                std::vector<uint8_t> smaller(input);
+                smaller[i] = lower;
+                if (!check(smaller).empty()) {
+                    input = smaller;
+                    progress = true;
+                    break;
+                }
+            }
+        }
+    }
+    return input;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void usage() {
+    std::cerr << "Usage: fuzz_msdscript [-runs=N] [-max_total_time=S] [-seed=N] [-max_len=N] [-workers=N] [file...]\n";
+    exit(1);
+}
+
+static int replay(const std::vector<std::string>& files) {
+    int failed = 0;
+    for (const std::string& path : files) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << path << ": cannot open\n";
+            return 1;
+        }
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string failure = check(input);
+        std::cout << path << ": " << program(input.data(), input.size()) << "\n"
+                  << (failure.empty() ? "  ok\n" : failure);
+        failed += !failure.empty();
+    }
+    return failed ? 1 : 0;
+}
+
+// Fuzzes until the limits are reached; returns the number of runs, or -1
+// after reporting a discrepancy. Prints progress if `report` is set.
+static int64_t fuzz(uint64_t seed, uint64_t runs, double seconds, size_t max_len, bool report) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint8_t> input;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t next_report = 1;
+    uint64_t n = 0;
+    while ((runs == 0 || n < runs) && (seconds == 0 || seconds_since(start) < seconds)) {
+        input.resize(1 + rng() % max_len);
+        for (uint8_t& b : input) {
+            b = (uint8_t)rng();
+        }
+        n++;
+        if (!check(input).empty()) {
+            std::vector<uint8_t> small = shrink(input);
+            std::string crash = "crash-" + std::to_string(seed) + "-" + std::to_string(n);
+            std::ofstream(crash, std::ios::binary).write((const char*)small.data(), (std::streamsize)small.size());
+            std::cerr << "discrepancy after " << n << " runs (seed " << seed << "), shrunk to:\n  "
+                      << program(small.data(), small.size()) << "\n" << check(small)
+                      << "input saved as " << crash << "\n";
+            return -1;
+        }
+        if (report && n == next_report) {
+            std::cerr << "#" << n << "\texecs/s: " << (uint64_t)(n / seconds_since(start)) << "\n";
+            next_report *= 2;
+        }
+    }
+    return (int64_t)n;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t runs = 0;   // 0: no limit
+    double seconds = 0;  // 0: no limit
+    uint64_t seed = (uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+    size_t max_len = 64;
+    int workers = 1;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        if (arg.compare(0, 6, "-runs=") == 0) {
+            runs = std::stoull(value);
+        } else if (arg.compare(0, 16, "-max_total_time=") == 0) {
+            seconds = std::stod(value);
+        } else if (arg.compare(0, 6, "-seed=") == 0) {
+            seed = std::stoull(value);
+        } else if (arg.compare(0, 9, "-max_len=") == 0) {
+            max_len = std::stoull(value);
+        } else if (arg.compare(0, 9, "-workers=") == 0) {
+            workers = std::stoi(value);
+        } else if (arg[0] != '-') {
+            files.push_back(arg);
+        } else {
+            usage();
+        }
+    }
+    if (!files.empty()) {
+        return replay(files);
+    }
+    if (max_len < 1 || workers < 1) {
+        usage();
+    }
+
+    std::cerr << "fuzz_msdscript: seed " << seed << "\n";
+    auto start = std::chrono::steady_clock::now();
+    int64_t total = 0;
+    bool failed = false;
+    if (workers == 1) {
+        total = fuzz(seed, runs, seconds, max_len, true);
+        failed = total < 0;
+    } else {
+        // Processes rather than threads: memoization is switched on and off
+        // for the whole process. Each child writes its run count to a pipe.
+        std::vector<std::pair<pid_t, int>> children;
+        for (int w = 0; w < workers; w++) {
+            uint64_t share = runs == 0 ? 0 : runs / workers + ((uint64_t)w < runs % workers);
+            int fds[2];
+            if (pipe(fds) != 0) {
+                perror("pipe");
+                return 1;
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                int64_t n = fuzz(seed + w, share, seconds, max_len, w == 0);
+                ssize_t written = write(fds[1], &n, sizeof n);
+                _exit(written == (ssize_t)sizeof n && n >= 0 ? 0 : 1);
+            }
+            close(fds[1]);
+            children.push_back({pid, fds[0]});
+        }
+        for (const std::pair<pid_t, int>& c : children) {
+            int64_t n = -1;
+            failed |= read(c.second, &n, sizeof n) != (ssize_t)sizeof n || n < 0;
+            close(c.second);
+            int status = 0;
+            waitpid(c.first, &status, 0);
+            total += n > 0 ? n : 0;
+        }
+    }
+    if (failed) {
+        return 1;
+    }
+    double elapsed = seconds_since(start);
+    std::cerr << "done: " << total << " runs in " << elapsed << " s, " << (uint64_t)(total / elapsed) << " execs/s\n";
+    return 0;
+}
+
+#endif // MSDSCRIPT_LIBFUZZER
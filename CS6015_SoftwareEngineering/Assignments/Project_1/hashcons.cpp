@@ -0,0 +1,101 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "hashcons.h"
+#include <algorithm>
+#include <atomic>
+
+// Ids are never reused, so nodes of a destroyed interner never look like
+// they belong to a later one.
+static std::atomic<size_t> next_id(1);
+
+ExprInterner::ExprInterner() : id(next_id++), count(0) {}
+
+PTR(Expr) ExprInterner::intern(PTR(Expr) e) {
+    visit(e);
+    run(0);
+    return pop();
+}
+
+bool ExprInterner::owns(const Expr& e) const {
+    return e.interner_id == id;
+}
+
+size_t ExprInterner::size() const {
+    return count;
+}
+
+size_t ExprInterner::combine(size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+const std::vector<PTR(Expr)>& ExprInterner::candidates(size_t hash) {
+    static const std::vector<PTR(Expr)> none;
+    auto it = table.find(hash);
+    return it == table.end() ? none : it->second;
+}
+
+PTR(Expr) ExprInterner::add(size_t hash, PTR(Expr) e) {
+    e->hash_code = hash;
+    e->interner_id = id;
+    table[hash].push_back(e);
+    count++;
+    return e;
+}
+
+void ExprInterner::visit(PTR(Expr) const& e) {
+    schedule(Step{&*e, 0});
+}
+
+void ExprInterner::resume(Expr* e, int stage) {
+    schedule(Step{e, stage});
+}
+
+void ExprInterner::push(PTR(Expr) e) {
+    results.push_back(std::move(e));
+}
+
+PTR(Expr) ExprInterner::pop() {
+    PTR(Expr) e = std::move(results.back());
+    results.pop_back();
+    return e;
+}
+
+void ExprInterner::schedule(const Step& step) {
+    if (steps.size() != mark || depth >= max_depth) {
+        steps.push_back(step); // Runs after the steps ahead of it
+        return;
+    }
+
+    // Nothing is waiting ahead of it: run it now
+    depth++;
+    step.expr->intern(*this, step.stage);
+    if (steps.size() > mark) {
+        // It scheduled steps of its own; run them before going on
+        std::reverse(steps.begin() + mark, steps.end());
+        run(mark);
+    }
+    depth--;
+}
+
+void ExprInterner::run(size_t base) {
+    while (steps.size() > base) {
+        Step step = steps.back();
+        steps.pop_back();
+
+        size_t outer = mark;
+        mark = steps.size();
+        step.expr->intern(*this, step.stage);
+
+        // Its steps go on top of the stack, first step last
+        std::reverse(steps.begin() + mark, steps.end());
+        mark = outer;
+    }
+}
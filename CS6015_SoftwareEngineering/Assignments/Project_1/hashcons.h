@@ -0,0 +1,126 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HASHCONS_H
+#define HASHCONS_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pointer.h"
+#include "expr.h"
+
+/**
+ * @class ExprInterner
+ * @brief Hash-consing for Expr trees.
+ *
+ * intern() rebuilds a tree bottom-up so that structurally equal subtrees
+ * become a single shared node carrying a precomputed structural hash.
+ * Comparing two trees of the same interner with equals() is then a pointer
+ * comparison, and a generated program that repeats the same subexpression
+ * stores it once.
+ *
+ * Interned nodes are shared between contexts, so they cannot hold the
+ * per-occurrence frame slots written by the Resolver: Resolver::resolve
+ * leaves interned trees alone and they are evaluated by name lookup. The
+ * interner keeps every node it creates alive and is not thread-safe.
+ *
+ * intern() walks the tree as the Optimizer does: an expression's intern()
+ * schedules its children with visit() and its next stage with resume(),
+ * takes their nodes with pop() and push()es its own. Past max_depth nested
+ * steps they wait on an explicit stack instead of running by recursion, so
+ * tree depth is limited by memory rather than by the thread stack.
+ */
+class ExprInterner {
+public:
+    ExprInterner();
+
+    ExprInterner(const ExprInterner&) = delete;
+    ExprInterner& operator=(const ExprInterner&) = delete;
+
+    /**
+     * @brief Returns the interned copy of a tree.
+     * @param e Any expression; it is not modified.
+     * @return The canonical node for e in this interner.
+     */
+    PTR(Expr) intern(PTR(Expr) e);
+
+    /**
+     * @brief Checks whether a node already belongs to this interner.
+     */
+    bool owns(const Expr& e) const;
+
+    /**
+     * @brief Number of distinct nodes interned so far.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Mixes a value into a hash.
+     */
+    static size_t combine(size_t seed, size_t value);
+
+    /**
+     * @brief Interned nodes with the given hash, for Expr::intern to compare against.
+     */
+    const std::vector<PTR(Expr)>& candidates(size_t hash);
+
+    /**
+     * @brief Registers a new node under its hash.
+     * @param hash The node's structural hash.
+     * @param e A node whose children are already interned here.
+     * @return e, now owned by this interner.
+     */
+    PTR(Expr) add(size_t hash, PTR(Expr) e);
+
+    /**
+     * @brief Schedules a subexpression to be interned; its node is then pushed.
+     */
+    void visit(PTR(Expr) const& e);
+
+    /**
+     * @brief Schedules a later stage of an expression's intern().
+     * @param e The expression, which must outlive the walk.
+     * @param stage The stage to pass to its intern().
+     */
+    void resume(Expr* e, int stage);
+
+    /**
+     * @brief Pushes an interned node as the result of the current expression.
+     */
+    void push(PTR(Expr) e);
+
+    /**
+     * @brief Takes the most recently pushed node.
+     */
+    PTR(Expr) pop();
+
+private:
+    struct Step {
+        Expr* expr;
+        int stage;
+    };
+
+    size_t id;
+    size_t count;
+    std::unordered_map<size_t, std::vector<PTR(Expr)>> table;
+    std::vector<Step> steps;        // Scheduled steps, next one last
+    std::vector<PTR(Expr)> results; // Nodes not yet taken, most recent last
+    size_t mark = 0;                // Size of steps before the current expression scheduled its own
+    int depth = 0;                  // Steps being run by recursion
+
+    static const int max_depth = 1000; ///< Most steps run by recursion at once.
+
+    void schedule(const Step& step);
+    void run(size_t base);
+};
+
+#endif // HASHCONS_H
@@ -0,0 +1,169 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "lexer.h"
+#include "bignum.h"
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+
+// Plain range checks instead of <cctype>, which consults the locale per call
+static bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Maps the letters after a '_' to a keyword token, or tok_error if unknown
+static token_t keyword(std::string_view word) {
+    switch (word.size()) {
+        case 2:
+            if (word == "in") return tok_in;
+            if (word == "if") return tok_if;
+            break;
+        case 3:
+            if (word == "let") return tok_let;
+            if (word == "fun") return tok_fun;
+            break;
+        case 4:
+            if (word == "then") return tok_then;
+            if (word == "else") return tok_else;
+            if (word == "true") return tok_true;
+            break;
+        case 5:
+            if (word == "false") return tok_false;
+            break;
+    }
+    return tok_error;
+}
+
+Lexer::Lexer(std::string_view src) : src(src), pos(0) {
+    scan();
+}
+
+const Token& Lexer::peek() const {
+    return tok;
+}
+
+Token Lexer::next() {
+    Token t = tok;
+    scan();
+    return t;
+}
+
+void Lexer::expect(token_t kind) {
+    if (tok.kind != kind) {
+        throw std::runtime_error("bad input");
+    }
+    scan();
+}
+
+size_t Lexer::offset() const {
+    return tok.text.data() - src.data();
+}
+
+void Lexer::scan() {
+    const char* s = src.data();
+    size_t n = src.size();
+
+    while (pos < n && is_space(s[pos])) {
+        pos++;
+    }
+
+    size_t start = pos;
+    tok.num = 0;
+    tok.error = nullptr;
+
+    if (pos == n) {
+        tok.kind = tok_eof;
+        tok.text = src.substr(start, 0);
+        return;
+    }
+
+    char c = s[pos];
+    if (c == '-' || is_digit(c)) {
+        bool negative = (c == '-');
+        if (negative) {
+            pos++;
+            if (pos == n || !is_digit(s[pos])) {
+                tok.kind = tok_error;
+                tok.error = "invalid input";
+                tok.text = src.substr(start, pos - start);
+                return;
+            }
+        }
+        uint64_t value = 0;
+        while (pos < n && is_digit(s[pos])) {
+            value = value * 10 + (s[pos] - '0');
+            pos++;
+            if (value > static_cast<uint64_t>(INT_MAX) && BigInt::enabled) {
+                // The parser reads the whole literal as a BigInt
+                while (pos < n && is_digit(s[pos])) {
+                    pos++;
+                }
+                tok.kind = tok_big_num;
+                tok.text = src.substr(start, pos - start);
+                return;
+            }
+            if (value > static_cast<uint64_t>(INT_MAX)) {
+                tok.kind = tok_error;
+                tok.error = "number too large";
+                tok.text = src.substr(start, pos - start);
+                return;
+            }
+        }
+        tok.kind = tok_num;
+        tok.num = negative ? -static_cast<int>(value) : static_cast<int>(value);
+    } else if (is_alpha(c)) {
+        while (pos < n && is_alpha(s[pos])) {
+            pos++;
+        }
+        if (pos < n && s[pos] == '_') {
+            // Variable names cannot contain underscores
+            tok.kind = tok_error;
+            tok.error = "invalid input";
+            pos++;
+        } else {
+            tok.kind = tok_var;
+        }
+    } else if (c == '_') {
+        pos++;
+        while (pos < n && is_alpha(s[pos])) {
+            pos++;
+        }
+        tok.kind = keyword(src.substr(start + 1, pos - start - 1));
+        if (tok.kind == tok_error) {
+            tok.error = "bad input";
+        }
+    } else if (c == '=' && pos + 1 < n && s[pos + 1] == '=') {
+        tok.kind = tok_eqeq;
+        pos += 2;
+    } else {
+        pos++;
+        switch (c) {
+            case '(': tok.kind = tok_lparen; break;
+            case ')': tok.kind = tok_rparen; break;
+            case '+': tok.kind = tok_plus; break;
+            case '*': tok.kind = tok_star; break;
+            case '=': tok.kind = tok_equal; break;
+            default:
+                tok.kind = tok_error;
+                tok.error = "bad input";
+                break;
+        }
+    }
+    tok.text = src.substr(start, pos - start);
+}
@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @enum token_t
+ * @brief Kinds of tokens produced by the Lexer.
+ */
+typedef enum {
+    tok_num,     ///< Integer literal, possibly negative; value in Token::num.
+    tok_big_num, ///< Integer literal outside the range of an int (--bignum only); digits in Token::text.
+    tok_var,     ///< Variable name; text in Token::text.
+    tok_let,     ///< _let
+    tok_in,      ///< _in
+    tok_if,      ///< _if
+    tok_then,    ///< _then
+    tok_else,    ///< _else
+    tok_fun,     ///< _fun
+    tok_true,    ///< _true
+    tok_false,   ///< _false
+    tok_lparen,  ///< (
+    tok_rparen,  ///< )
+    tok_plus,    ///< +
+    tok_star,    ///< *
+    tok_equal,   ///< = (in _let bindings)
+    tok_eqeq,    ///< ==
+    tok_eof,     ///< End of input.
+    tok_error    ///< Malformed input; message in Token::error.
+} token_t;
+
+/**
+ * @struct Token
+ * @brief One token of MSDScript source.
+ */
+struct Token {
+    token_t kind;          ///< What kind of token this is.
+    std::string_view text; ///< The token's source text (points into the Lexer's buffer).
+    int num;               ///< Value of a tok_num.
+    const char* error;     ///< Message of a tok_error.
+};
+
+/**
+ * @class Lexer
+ * @brief Splits a contiguous buffer of MSDScript source into tokens.
+ *
+ * The lexer keeps one token of lookahead. Malformed input does not throw
+ * while scanning; it becomes a tok_error token, and the parser reports its
+ * message only if it actually tries to use that token. That keeps the
+ * parser's error messages the same as when it read characters one at a
+ * time: "invalid input" for a bad number or variable name, "bad input"
+ * for anything else.
+ *
+ * The buffer is not copied and must outlive the lexer and every Token's text.
+ */
+class Lexer {
+public:
+    /**
+     * @brief Creates a lexer positioned on the first token of src.
+     * @param src The source text.
+     */
+    explicit Lexer(std::string_view src);
+
+    /**
+     * @brief The current token, without consuming it.
+     */
+    const Token& peek() const;
+
+    /**
+     * @brief Consumes and returns the current token.
+     */
+    Token next();
+
+    /**
+     * @brief Consumes the current token, which must be of the given kind.
+     * @param kind The expected token kind.
+     * @throws std::runtime_error("bad input") if the current token is different.
+     */
+    void expect(token_t kind);
+
+    /**
+     * @brief Byte offset of the current token in the source.
+     */
+    size_t offset() const;
+
+private:
+    std::string_view src;
+    size_t pos;   // Next unscanned byte
+    Token tok;    // Current token
+
+    void scan();
+};
+
+#endif // LEXER_H
@@ -20,12 +20,41 @@
 #include "val.h"
 #include "pointer.h"
 #include "env.h"
+#include "vm.h"
+#include "batch.h"
+#include "optimize.h"
+#include "writer.h"
+#include "memo.h"
+#include "serve.h"
+#include "encode.h"
+#include "profile.h"
+#include "exec_pool.h"
+#include <fstream>
+#include <iterator>
+#include <unistd.h>      // For STDOUT_FILENO
 
-// Main function
-int main(int argc, char* argv[]) {
+// Runs one command line; main, and each request of a --worker
+static int run_command(int argc, char* argv[]) {
     try {
         // Parse command-line arguments and determine the run mode
-        run_mode_t mode = use_arguments(argc, argv);
+        options_t options = use_arguments(argc, argv);
+        run_mode_t mode = options.mode;
+
+        // Apply --max-depth to both evaluators
+        if (options.max_depth > 0) {
+            FunVal::max_depth = options.max_depth;
+            VM::max_depth = options.max_depth;
+        }
+
+        // --bignum lets literals and arithmetic results grow past an int
+        if (options.bignum) {
+            BigInt::enabled = true;
+        }
+
+        // --memoize caches the results of function calls on each thread
+        if (options.memoize) {
+            CallCache::enable(true);
+        }
 
         // If the mode is do_test, run the Catch2 test suite
         if (mode == do_test) {
@@ -35,32 +64,109 @@ int main(int argc, char* argv[]) {
             return result;
         }
 
-        // Read input from standard input
-        std::string input;
-        std::getline(std::cin, input);
+        // If the mode is do_batch, evaluate every expression in the input, one result per line
+        if (mode == do_batch) {
+            std::ios::sync_with_stdio(false);
+            int failures;
+            if (options.batch_file.empty()) {
+                failures = run_batch(std::cin, std::cout, options.jobs);
+            } else {
+                std::ifstream file(options.batch_file);
+                if (!file) {
+                    throw std::runtime_error("cannot open " + options.batch_file);
+                }
+                failures = run_batch(file, std::cout, options.jobs);
+            }
+            // Exit with a non-zero status code if any expression failed
+            return failures == 0 ? 0 : 1;
+        }
+
+        // If the mode is do_serve, evaluate expressions sent to the socket until interrupted
+        if (mode == do_serve) {
+            return run_serve(options.socket_path, options.jobs);
+        }
 
-        // Create a string stream from the input for parsing
-        std::stringstream ss(input);
+        // If the mode is do_worker, run the commands an ExecPool sends until it closes standard input
+        if (mode == do_worker) {
+            return run_worker(run_command);
+        }
 
-        // Parse the input expression into an Expr object
-        PTR(Expr) expr = parse_expr(ss);
+        // Parse all of standard input (which may span several lines) into an Expr object,
+        // or for do_run load the one --compile wrote, without parsing
+        std::string source;
+        if (mode != do_run) {
+            source.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        }
+        PTR(Expr) expr = mode == do_run ? Decoder::load(options.program_file) : parse(std::string_view(source));
 
         // Handle the flag based on the run mode
         switch (mode) {
-            case do_interp: {
-                // If the mode is do_interp, interpret the expression and print the result
-                PTR(Val) result = expr->interp(Env::empty);
+            case do_interp:
+            case do_run: {
+                // If the mode is do_interp, fold constants (--compile already did for do_run),
+                // interpret the expression and print the result
+                PTR(Expr) prepared = mode == do_run ? expr : Optimizer::optimize(expr);
+                // --profile measures only the evaluation
+                Profiler profiler;
+                if (options.profile != profile_off) {
+                    Profiler::active = &profiler;
+                }
+                PTR(Val) result;
+                try {
+                    result = prepared->interp(Env::empty);
+                } catch (...) {
+                    Profiler::active = nullptr;
+                    throw;
+                }
+                Profiler::active = nullptr;
+                std::cout << result->to_string() << "\n";
+                if (options.profile == profile_text) {
+                    profiler.report(std::cerr, source);
+                } else if (options.profile == profile_json) {
+                    profiler.report_json(std::cerr, source);
+                }
+                if (CallCache* cache = CallCache::current()) {
+                    // Report how well the cache did, away from the result
+                    std::cerr << "memoize: " << cache->hits() << " hits, " << cache->misses() << " misses, "
+                              << cache->size() << " entries\n";
+                }
+                break;
+            }
+            case do_interp_vm: {
+                // If the mode is do_interp_vm, compile the expression to bytecode and run it on the VM
+                PTR(Val) result = vm_interp(expr);
                 std::cout << result->to_string() << "\n";
                 break;
             }
             case do_print: {
-                // If the mode is do_print, print the expression as a string
-                std::cout << expr->to_string() << "\n";
+                // If the mode is do_print, print the expression straight to standard output
+                Writer out(STDOUT_FILENO);
+                expr->printExp(out);
+                out << '\n';
+                out.flush();
                 break;
             }
             case do_pretty_print: {
-                // If the mode is do_pretty_print, pretty-print the expression
-                std::cout << expr->to_pretty_string() << "\n";
+                // If the mode is do_pretty_print, pretty-print the expression straight to standard output
+                Writer out(STDOUT_FILENO);
+                expr->pretty_print(out, prec_none);
+                out << '\n';
+                out.flush();
+                break;
+            }
+            case do_optimize: {
+                // If the mode is do_optimize, print the expression after constant folding
+                Writer out(STDOUT_FILENO);
+                Optimizer::optimize(expr)->printExp(out);
+                out << '\n';
+                out.flush();
+                break;
+            }
+            case do_compile: {
+                // If the mode is do_compile, write the constant-folded program in binary for --run
+                Writer out(STDOUT_FILENO);
+                out << Encoder::encode(Optimizer::optimize(expr));
+                out.flush();
                 break;
             }
             default:
@@ -79,4 +185,9 @@ int main(int argc, char* argv[]) {
         // Exit with a non-zero status code to indicate an error
         return 1;
     }
-}
\ No newline at end of file
+}
+
+// Main function
+int main(int argc, char* argv[]) {
+    return run_command(argc, argv);
+}
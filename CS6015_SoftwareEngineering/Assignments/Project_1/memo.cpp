@@ -0,0 +1,121 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "memo.h"
+#include "hashcons.h" // For ExprInterner::combine
+#include <functional>
+#include <memory>
+
+size_t CallCache::default_capacity = 100000;
+
+// Set once by main before any thread starts, like FunVal::max_depth
+static bool enabled = false;
+
+static thread_local std::unique_ptr<CallCache> cache;
+
+CallCache::CallCache(size_t capacity)
+    : limit(capacity > 0 ? capacity : 1), hit_count(0), miss_count(0) {}
+
+CallCache* CallCache::current() {
+    if (!enabled) {
+        return nullptr;
+    }
+    if (!cache) {
+        cache.reset(new CallCache(default_capacity));
+    }
+    return cache.get();
+}
+
+void CallCache::enable(bool on) {
+    enabled = on;
+    cache.reset();
+}
+
+bool CallCache::Key::operator==(const Key& other) const {
+    return fun == other.fun && kind == other.kind && arg == other.arg;
+}
+
+size_t CallCache::KeyHash::operator()(const Key& k) const {
+    size_t h = std::hash<const Val*>()(k.fun);
+    h = ExprInterner::combine(h, k.kind);
+    return ExprInterner::combine(h, std::hash<std::intptr_t>()(k.arg));
+}
+
+bool CallCache::make_key(const Val* fun, PTR(Val) const& arg, Key& key) {
+    key.fun = fun;
+    Val* a = &*arg;
+    switch (a->type) {
+        case val_num:
+            key.kind = key_num;
+            key.arg = static_cast<NumVal*>(a)->value;
+            return true;
+        case val_bool:
+            key.kind = key_bool;
+            key.arg = a->is_true();
+            return true;
+        case val_fun:
+            key.kind = key_fun;
+            key.arg = reinterpret_cast<std::intptr_t>(a);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool CallCache::find(const Val* fun, PTR(Val) const& arg, PTR(Val)& result) {
+    Key key;
+    if (!make_key(fun, arg, key)) {
+        return false;
+    }
+    auto it = table.find(key);
+    if (it == table.end()) {
+        miss_count++;
+        return false;
+    }
+    hit_count++;
+    entries.splice(entries.begin(), entries, it->second); // Now the most recently used
+    result = it->second->result;
+    return true;
+}
+
+void CallCache::insert(PTR(Val) fun, PTR(Val) arg, PTR(Val) result) {
+    Key key;
+    if (!make_key(&*fun, arg, key)) {
+        return;
+    }
+    auto it = table.find(key);
+    if (it != table.end()) {
+        // A recursive call with the same key finished first; the results are equal
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    if (entries.size() >= limit) {
+        table.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front(Entry{key, fun, arg, result});
+    table.emplace(key, entries.begin());
+}
+
+size_t CallCache::hits() const {
+    return hit_count;
+}
+
+size_t CallCache::misses() const {
+    return miss_count;
+}
+
+size_t CallCache::size() const {
+    return entries.size();
+}
+
+size_t CallCache::capacity() const {
+    return limit;
+}
@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include "pointer.h"
+#include "val.h"
+
+/**
+ * @class CallCache
+ * @brief Memoizes function calls of the tree-walking interpreter (--memoize).
+ *
+ * Every MSDScript function is pure, so a call's result depends only on the
+ * function value and the argument. FunVal::call looks each call up here
+ * first; a miss runs the body and stores the result.
+ *
+ * The function is keyed by identity. Number and boolean arguments are keyed
+ * by value, and function arguments by identity, which is what makes the
+ * usual self-application recursion hit: `f(f)` returns the same cached
+ * closure every time, so `f(f)(n)` is found for each n seen before.
+ *
+ * An entry holds on to its function, argument and result, so an address in
+ * the table always belongs to a live value. At most capacity entries are
+ * kept; the least recently used one is dropped first. Each thread has its
+ * own cache, so --batch --jobs workers never share one.
+ */
+class CallCache {
+public:
+    /**
+     * @brief Creates an empty cache.
+     * @param capacity Most entries kept at once (at least 1).
+     */
+    explicit CallCache(size_t capacity);
+
+    CallCache(const CallCache&) = delete;
+    CallCache& operator=(const CallCache&) = delete;
+
+    /**
+     * @brief This thread's cache, or nullptr when memoization is off.
+     *
+     * The cache is created on first use with the current default_capacity.
+     */
+    static CallCache* current();
+
+    /**
+     * @brief Turns memoization on or off for calls made from now on.
+     *
+     * Turning it off drops this thread's cache; turning it on again starts
+     * an empty one.
+     */
+    static void enable(bool on);
+
+    /**
+     * @brief Looks up a call.
+     * @param fun The function being called.
+     * @param arg The argument.
+     * @param result Set to the cached result on a hit.
+     * @return true on a hit. Counts a hit or a miss, unless arg cannot be a key.
+     */
+    bool find(const Val* fun, PTR(Val) const& arg, PTR(Val)& result);
+
+    /**
+     * @brief Stores the result of a call, evicting the least recently used entry if full.
+     *
+     * Does nothing if arg cannot be a key.
+     */
+    void insert(PTR(Val) fun, PTR(Val) arg, PTR(Val) result);
+
+    size_t hits() const;     ///< Lookups that found a result.
+    size_t misses() const;   ///< Lookups that did not.
+    size_t size() const;     ///< Entries currently held.
+    size_t capacity() const; ///< Most entries held at once.
+
+    /**
+     * @brief Capacity of caches created from now on.
+     *
+     * A NumVal entry with its list and table nodes is a little over 100
+     * bytes, so the default bounds a cache to roughly 10 MB.
+     */
+    static size_t default_capacity;
+
+private:
+    typedef enum {
+        key_num,
+        key_bool,
+        key_fun
+    } key_kind_t;
+
+    struct Key {
+        const Val* fun;
+        key_kind_t kind;
+        std::intptr_t arg; // The number, the boolean, or the function's address
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const;
+    };
+
+    struct Entry {
+        Key key;
+        PTR(Val) fun;    // Keep the keyed addresses alive
+        PTR(Val) arg;
+        PTR(Val) result;
+    };
+
+    static bool make_key(const Val* fun, PTR(Val) const& arg, Key& key);
+
+    size_t limit;
+    size_t hit_count;
+    size_t miss_count;
+    std::list<Entry> entries; // Most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> table;
+};
+
+#endif // MEMO_H
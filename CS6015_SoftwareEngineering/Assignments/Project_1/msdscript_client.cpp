@@ -0,0 +1,152 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+// A client for msdscript --serve.
+//
+//   msdscript_client <socket>
+//       Sends each line of standard input as an expression and prints each reply.
+//
+//   msdscript_client <socket> --clients N --requests M [--pipeline K] [expression]
+//       Load test: N connections on their own threads each send M requests,
+//       keeping up to K of them in flight, then prints the throughput and the
+//       round-trip latency percentiles. The expression defaults to a small
+//       recursive function.
+
+#include "serve.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+static const char* default_expr =
+    "_let f = _fun (f) _fun (n) _if n == 0 _then 0 _else n + f(f)(n + -1) _in f(f)(50)";
+
+static double now_us() {
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void usage() {
+    std::cerr << "Usage: msdscript_client <socket> [--clients N --requests M [--pipeline K] [expression]]\n";
+    exit(1);
+}
+
+// Sends every line of standard input and prints the replies in order
+static int interactive(const std::string& path) {
+    int fd = connect_socket(path);
+    std::string line;
+    std::string reply;
+    int failures = 0;
+    while (std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        send_frame(fd, line);
+        if (!recv_frame(fd, reply)) {
+            throw std::runtime_error("server closed the connection");
+        }
+        std::cout << reply << "\n";
+        failures += reply.compare(0, 7, "Error: ") == 0;
+    }
+    ::close(fd);
+    return failures == 0 ? 0 : 1;
+}
+
+// One load-testing connection: keeps up to pipeline requests in flight
+static void load_client(const std::string& path, const std::string& expr, int requests, int pipeline,
+                        LatencyStats& stats, std::string& error) {
+    try {
+        int fd = connect_socket(path);
+        std::vector<double> sent_at(requests);
+        std::string reply;
+        int sent = 0;
+        for (int done = 0; done < requests; done++) {
+            while (sent < requests && sent - done < pipeline) {
+                sent_at[sent++] = now_us();
+                send_frame(fd, expr);
+            }
+            if (!recv_frame(fd, reply)) {
+                throw std::runtime_error("server closed the connection");
+            }
+            stats.add(now_us() - sent_at[done]);
+        }
+        ::close(fd);
+    } catch (std::exception& e) {
+        error = e.what();
+    }
+}
+
+static int load(const std::string& path, int clients, int requests, int pipeline, const std::string& expr) {
+    std::vector<LatencyStats> stats(clients);
+    std::vector<std::string> errors(clients);
+    std::vector<std::thread> threads;
+    double start = now_us();
+    for (int i = 0; i < clients; i++) {
+        threads.emplace_back(load_client, std::cref(path), std::cref(expr), requests, pipeline,
+                             std::ref(stats[i]), std::ref(errors[i]));
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    double seconds = (now_us() - start) / 1e6;
+
+    LatencyStats all;
+    for (int i = 0; i < clients; i++) {
+        if (!errors[i].empty()) {
+            std::cerr << "client " << i << ": " << errors[i] << "\n";
+            return 1;
+        }
+        all.merge(stats[i]);
+    }
+    std::cout << clients << " clients, " << all.count() << " requests in " << seconds << " s ("
+              << (long)(all.count() / seconds) << " requests/s)\n";
+    std::cout << "round trip: " << all.report() << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+    }
+    std::string path = argv[1];
+    int clients = 0;
+    int requests = 0;
+    int pipeline = 1;
+    std::string expr = default_expr;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--clients" && i + 1 < argc) {
+            clients = atoi(argv[++i]);
+        } else if (arg == "--requests" && i + 1 < argc) {
+            requests = atoi(argv[++i]);
+        } else if (arg == "--pipeline" && i + 1 < argc) {
+            pipeline = atoi(argv[++i]);
+        } else if (arg.compare(0, 2, "--") != 0) {
+            expr = arg;
+        } else {
+            usage();
+        }
+    }
+
+    try {
+        if (clients == 0 && requests == 0) {
+            return interactive(path);
+        }
+        if (clients < 1 || requests < 1 || pipeline < 1) {
+            usage();
+        }
+        return load(path, clients, requests, pipeline, expr);
+    } catch (std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "optimize.h"
+#include "resolve.h"
+#include "env.h"
+#include <algorithm>
+#include <stdexcept>
+
+PTR(Expr) Optimizer::optimize(PTR(Expr) e) {
+    Optimizer o;
+    o.visit(e);
+    o.run(0);
+    PTR(Expr) result = o.pop();
+    // Removing _lets changes the frame layout, so the new tree is resolved from scratch
+    Resolver::resolve(result);
+    return result;
+}
+
+bool Optimizer::is_literal(PTR(Expr) e) {
+    return e->type == expr_num || e->type == expr_bool || e->type == expr_big_num;
+}
+
+PTR(Expr) Optimizer::fold(PTR(Expr) e) {
+    try {
+        return e->interp(Env::empty)->to_expr();
+    } catch (const std::exception&) {
+        return e; // Keep the error for run time
+    }
+}
+
+PTR(Expr) Optimizer::lookup(Symbol name) {
+    for (size_t i = bindings.size(); i > 0; i--) {
+        if (bindings[i - 1].first == name) {
+            return bindings[i - 1].second;
+        }
+    }
+    return nullptr;
+}
+
+void Optimizer::bind(Symbol name, PTR(Expr) value) {
+    bindings.push_back({name, value});
+}
+
+void Optimizer::unbind() {
+    bindings.pop_back();
+}
+
+void Optimizer::visit(PTR(Expr) const& e) {
+    schedule(Step{&*e, 0});
+}
+
+void Optimizer::resume(Expr* e, int stage) {
+    schedule(Step{e, stage});
+}
+
+void Optimizer::push(PTR(Expr) e) {
+    results.push_back(std::move(e));
+}
+
+PTR(Expr) Optimizer::pop() {
+    PTR(Expr) e = std::move(results.back());
+    results.pop_back();
+    return e;
+}
+
+void Optimizer::schedule(const Step& step) {
+    if (steps.size() != mark || depth >= max_depth) {
+        steps.push_back(step); // Runs after the steps ahead of it
+        return;
+    }
+
+    // Nothing is waiting ahead of it: run it now
+    depth++;
+    step.expr->optimize(*this, step.stage);
+    if (steps.size() > mark) {
+        // It scheduled steps of its own; run them before going on
+        std::reverse(steps.begin() + mark, steps.end());
+        run(mark);
+    }
+    depth--;
+}
+
+void Optimizer::run(size_t base) {
+    while (steps.size() > base) {
+        Step step = steps.back();
+        steps.pop_back();
+
+        size_t outer = mark;
+        mark = steps.size();
+        step.expr->optimize(*this, step.stage);
+
+        // Its steps go on top of the stack, first step last
+        std::reverse(steps.begin() + mark, steps.end());
+        mark = outer;
+    }
+}
@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef OPTIMIZE_H
+#define OPTIMIZE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "pointer.h"
+#include "expr.h"
+
+/**
+ * @class Optimizer
+ * @brief Constant folding and constant propagation over Expr trees.
+ *
+ * The pass builds a new tree in which
+ *   - +, * and == on two literal operands are replaced by their result,
+ *   - a _let whose right-hand side is a literal is removed and the literal
+ *     is substituted for its variable,
+ *   - an _if whose condition is _true or _false is replaced by that branch.
+ * Folding happens inside function bodies too, so a closed subexpression is
+ * computed once instead of on every call.
+ *
+ * The result means exactly the same as the input. Folding is done by
+ * interpreting the node itself, and a node whose evaluation throws (for
+ * example "arithmetic overflow", or adding a boolean) is left in place, so
+ * the error still happens at run time and only if that code runs. Function
+ * values keep their original bodies for equality (see FunExpr).
+ *
+ * An expression's optimize() schedules its subexpressions with visit() and
+ * its own later stages with resume(), which run in the order scheduled;
+ * each subexpression leaves its result for pop(), and the expression's last
+ * stage push()es its own. As in the Resolver, a step scheduled while nothing
+ * is waiting ahead of it runs at once, so ordinary trees are optimized by
+ * plain recursion; past max_depth, steps wait on an explicit stack instead,
+ * so tree depth is limited by memory rather than by the thread stack.
+ * bind(), unbind() and lookup() take effect at once.
+ */
+class Optimizer {
+public:
+    /**
+     * @brief Optimizes an expression.
+     * @param e The expression, resolved or not; it is not modified.
+     * @return A new, resolved expression (see resolve.h).
+     */
+    static PTR(Expr) optimize(PTR(Expr) e);
+
+    /**
+     * @brief Checks whether an expression is a number (of either size) or boolean literal.
+     */
+    static bool is_literal(PTR(Expr) e);
+
+    /**
+     * @brief Replaces a node whose operands are literals by its value.
+     * @param e The node to fold.
+     * @return The value as a literal, or e if evaluating it throws.
+     */
+    static PTR(Expr) fold(PTR(Expr) e);
+
+    /**
+     * @brief Finds the literal a variable is known to hold.
+     * @return The literal, or nullptr if the variable's value is unknown here.
+     */
+    PTR(Expr) lookup(Symbol name);
+
+    /**
+     * @brief Brings a binding into scope.
+     * @param name The variable.
+     * @param value The literal it holds, or nullptr if unknown (a function
+     *        argument or a _let of a non-constant), which hides outer bindings.
+     */
+    void bind(Symbol name, PTR(Expr) value);
+
+    /**
+     * @brief Ends the scope of the most recent bind().
+     */
+    void unbind();
+
+    /**
+     * @brief Schedules a subexpression to be optimized; its result is then pushed.
+     */
+    void visit(PTR(Expr) const& e);
+
+    /**
+     * @brief Schedules a later stage of an expression's optimize().
+     * @param e The expression, which must outlive the walk.
+     * @param stage The stage to pass to its optimize().
+     */
+    void resume(Expr* e, int stage);
+
+    /**
+     * @brief Pushes a result, or a value an expression keeps for its next stage.
+     */
+    void push(PTR(Expr) e);
+
+    /**
+     * @brief Takes the most recently pushed result.
+     */
+    PTR(Expr) pop();
+
+private:
+    struct Step {
+        Expr* expr;
+        int stage;
+    };
+
+    std::vector<std::pair<Symbol, PTR(Expr)>> bindings; // Innermost last
+    std::vector<Step> steps;        // Scheduled steps, next one last
+    std::vector<PTR(Expr)> results; // Results not yet taken, most recent last
+    size_t mark = 0;                // Size of steps before the current expression scheduled its own
+    int depth = 0;                  // Steps being run by recursion
+
+    static const int max_depth = 1000; ///< Most steps run by recursion at once.
+
+    void schedule(const Step& step);
+    void run(size_t base);
+};
+
+#endif // OPTIMIZE_H
@@ -11,349 +11,239 @@
 #include "parse.hpp"
 #include "expr.h"
 #include "val.h"
+#include "resolve.h"
 #include <iostream>
-#include <sstream>
-#include <cctype>
-#include <climits>
-#include <cstdint>
-
-void consume(std::istream& in, int expect) {
-    int c = in.get();  // Read the next character from the input stream
-    if (c != expect) { // Check if the character matches the expected one
-        throw std::runtime_error("bad input"); // Throw an error if it doesn't match
-    }
-}
-
-void skip_whitespace(std::istream& in) {
-    while (true) {
-        int c = in.peek(); // Peek at the next character without consuming it
-        if (!isspace(c)) break; // Exit the loop if the character is not whitespace
-        consume(in, c); // Consume the whitespace character
-    }
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Throws the lexer's message for a malformed token, or "bad input" otherwise
+static void fail_on(const Token& t) {
+    throw std::runtime_error(t.kind == tok_error ? t.error : "bad input");
 }
 
-PTR(Expr) parse_num(std::istream& in) {
-    uint64_t n = 0; // Use uint64_t to handle large numbers
-    bool negative = false;
-
-    if (in.peek() == '-') {
-        negative = true;
-        consume(in, '-');
-        if (!isdigit(in.peek())) {
-            throw std::runtime_error("invalid input");
-        }
-    }
-
-    while (true) {
-        int c = in.peek();
-        if (isdigit(c)) {
-            consume(in, c);
-//            uint64_t prev = n;
-            n = n * 10 + (c - '0');
-
-            // Check for overflow
-            if (n > static_cast<uint64_t>(INT_MAX)) {
-                throw std::runtime_error("number too large");
-            }
-        } else {
-            break;
+PTR(Expr) parse_num(Lexer& lex) {
+    if (lex.peek().kind == tok_big_num) {
+        BigInt value = BigInt::parse(lex.next().text);
+        if (value.fits_int()) {
+            return NEW(NumExpr)(value.to_int()); // Such as -2147483648
         }
+        return NEW(BigNumExpr)(value);
     }
-
-    if (negative) {
-        n = -n; // Cast to signed value
+    if (lex.peek().kind != tok_num) {
+        fail_on(lex.peek()); // "invalid input" for '-' without a digit, "number too large" on overflow
     }
-
-    return NEW(NumExpr)(static_cast<int>(n)); // Cast back to int for NumExpr
+    return NEW(NumExpr)(lex.next().num);
 }
 
-PTR(Expr) parse_var(std::istream& in) {
-    std::string name; // Initialize an empty string to store the variable name
-    while (true) {
-        int c = in.peek(); // Peek at the next character
-        if (isalpha(c)) {  // If it's an alphabetic character, consume it and add to the name
-            consume(in, c);
-            name += static_cast<char>(c);
-        } else if (c == '_') {
-            // If an underscore is encountered, throw an exception
-            throw std::runtime_error("invalid input");
-        } else {
-            break; // Exit the loop if a non-alphabetic character is encountered
-        }
+PTR(Expr) parse_var(Lexer& lex) {
+    if (lex.peek().kind != tok_var) {
+        fail_on(lex.peek()); // "invalid input" if the name runs into a '_'
     }
+    return NEW(VarExpr)(std::string(lex.next().text));
+}
 
-    // Ensure the variable name is not empty
-    if (name.empty()) {
-        throw std::runtime_error("invalid input");
+// What an unfinished construct is waiting for. The parser keeps these on
+// an explicit stack instead of recursing, so nesting depth is limited by
+// memory rather than by the thread stack.
+typedef enum {
+    wait_root,     // The whole expression
+    wait_add,      // The expression after lhs +
+    wait_eq,       // The expression after lhs ==
+    wait_mult,     // The addend after lhs *
+    wait_paren,    // The expression inside ( )
+    wait_call,     // The argument of a call
+    wait_if_cond,  // The condition after _if
+    wait_if_then,  // The expression after _then
+    wait_if_else,  // The expression after _else
+    wait_let_rhs,  // The expression after _let x =
+    wait_let_body, // The expression after _in
+    wait_fun_body  // The expression after _fun (x)
+} pending_t;
+
+struct Pending {
+    pending_t kind;
+    PTR(Expr) a;      // lhs, function, condition, or _let right-hand side
+    PTR(Expr) b;      // The _then branch
+    std::string name; // _let variable or formal argument
+    int position = -1; // Byte offset of a _fun
+};
+
+// Reads the name in _let name = or _fun (name)
+static std::string parse_name(Lexer& lex) {
+    if (lex.peek().kind != tok_var) {
+        throw std::runtime_error("bad input");
     }
-
-    // Return a NEW( VarExpr object representing the parsed variable
-    return NEW(VarExpr)(name);
+    return std::string(lex.next().text);
 }
 
-PTR(Expr) parse_let(std::istream& in) {
-    skip_whitespace(in);
-    consume(in, '_'); // Consume '_'
-    consume(in, 'l'); // Consume 'l'
-    consume(in, 'e'); // Consume 'e'
-    consume(in, 't'); // Consume 't'
-    skip_whitespace(in);
-
-    // Parse the variable name
-    std::string var;
-    while (isalpha(in.peek())) {
-        var += in.get();
+// Opens constructs until reaching a number, variable or boolean, and returns it
+static PTR(Expr) parse_leaf(Lexer& lex, std::vector<Pending>& pending) {
+    for (;;) {
+        switch (lex.peek().kind) {
+            case tok_num:
+            case tok_big_num:
+                return parse_num(lex);
+            case tok_var:
+                return parse_var(lex);
+            case tok_true:
+            case tok_false:
+                return parse_bool(lex);
+            case tok_lparen:
+                lex.next();
+                pending.push_back(Pending{wait_paren, nullptr, nullptr, {}});
+                break;
+            case tok_if:
+                lex.next();
+                pending.push_back(Pending{wait_if_cond, nullptr, nullptr, {}});
+                break;
+            case tok_let: {
+                lex.next();
+                std::string var = parse_name(lex);
+                lex.expect(tok_equal);
+                pending.push_back(Pending{wait_let_rhs, nullptr, nullptr, var});
+                break;
+            }
+            case tok_fun: {
+                int position = (int)lex.offset();
+                lex.next();
+                lex.expect(tok_lparen);
+                std::string formal_arg = parse_name(lex);
+                lex.expect(tok_rparen);
+                pending.push_back(Pending{wait_fun_body, nullptr, nullptr, formal_arg, position});
+                break;
+            }
+            default:
+                fail_on(lex.peek());
+        }
     }
-    skip_whitespace(in);
-
-    // Parse the '='
-    consume(in, '=');
-    skip_whitespace(in);
-
-    // Parse the right-hand side expression
-    PTR(Expr) rhs = parse_expr(in);
-    skip_whitespace(in);
-
-    // Parse the '_in' keyword
-    consume(in, '_');
-    consume(in, 'i');
-    consume(in, 'n');
-    skip_whitespace(in);
-
-    // Parse the body expression
-    PTR(Expr) body = parse_expr(in);
-
-    // Return a NEW( LetExpr object
-    return NEW(LetExpr)(var, rhs, body);
 }
 
-PTR(Expr) parse_multicand(std::istream& in) {
-    PTR(Expr) e = parse_inner(in);
+// Finishes every construct that the inner expression e completes. Returns
+// false if the next token opens a place for another expression, or true
+// with e set to the whole expression.
+static bool parse_rest(Lexer& lex, std::vector<Pending>& pending, PTR(Expr)& e) {
+    for (;;) {
+        // A multicand is an inner expression followed by any number of calls
+        token_t kind = lex.peek().kind;
+        if (kind == tok_lparen) {
+            lex.next();
+            pending.push_back(Pending{wait_call, e, nullptr, {}});
+            return false;
+        }
 
-    while (true) {
-        skip_whitespace(in);
-        int c = in.peek();
-        if (c == '(') {
-            consume(in, '(');
-            PTR(Expr) actual_arg = parse_expr(in);
-            skip_whitespace(in);
-            consume(in, ')');
-            e = NEW(CallExpr)(e, actual_arg);
+        // An addend is a multicand, or a multicand * an addend
+        if (kind == tok_star) {
+            lex.next();
+            pending.push_back(Pending{wait_mult, e, nullptr, {}});
+            return false;
         }
-        else {
-            break;
+        while (pending.back().kind == wait_mult) {
+            e = NEW(MultExpr)(pending.back().a, e);
+            pending.pop_back();
         }
-    }
-
-    return e;
-}
 
-PTR(Expr) parse_addend(std::istream& in) {
-    PTR(Expr) lhs = parse_multicand(in);
-    skip_whitespace(in);
+        // An expression is an addend, or an addend + or == an expression
+        if (kind == tok_plus || kind == tok_eqeq) {
+            lex.next();
+            pending.push_back(Pending{kind == tok_plus ? wait_add : wait_eq, e, nullptr, {}});
+            return false;
+        }
+        while (pending.back().kind == wait_add || pending.back().kind == wait_eq) {
+            if (pending.back().kind == wait_add) {
+                e = NEW(AddExpr)(pending.back().a, e);
+            } else {
+                e = NEW(EqExpr)(pending.back().a, e);
+            }
+            pending.pop_back();
+        }
 
-    if (in.peek() == '*') {
-        consume(in, '*');
-        PTR(Expr) rhs = parse_addend(in);
-        return NEW(MultExpr)(lhs, rhs);
+        // e is a whole expression: hand it to the construct waiting for one
+        Pending& p = pending.back();
+        switch (p.kind) {
+            case wait_root:
+                if (kind != tok_eof) {
+                    fail_on(lex.peek()); // Such as the 2 of (1) 2
+                }
+                return true;
+            case wait_paren:
+                lex.expect(tok_rparen);
+                break;
+            case wait_call:
+                lex.expect(tok_rparen);
+                e = NEW(CallExpr)(p.a, e);
+                break;
+            case wait_if_cond:
+                lex.expect(tok_then);
+                p.kind = wait_if_then;
+                p.a = e;
+                return false;
+            case wait_if_then:
+                lex.expect(tok_else);
+                p.kind = wait_if_else;
+                p.b = e;
+                return false;
+            case wait_if_else:
+                e = NEW(IfExpr)(p.a, p.b, e);
+                break;
+            case wait_let_rhs:
+                lex.expect(tok_in);
+                p.kind = wait_let_body;
+                p.a = e;
+                return false;
+            case wait_let_body:
+                e = NEW(LetExpr)(p.name, p.a, e);
+                break;
+            case wait_fun_body:
+                e = NEW(FunExpr)(p.name, e, 0, nullptr, p.position);
+                break;
+            default:
+                break; // Operators were finished above
+        }
+        pending.pop_back();
+        // The finished construct is an inner expression of the one around it
     }
+}
 
-    return lhs;
+PTR(Expr) parse_expr(Lexer& lex) {
+    std::vector<Pending> pending;
+    pending.push_back(Pending{wait_root, nullptr, nullptr, {}});
+    PTR(Expr) e;
+    do {
+        e = parse_leaf(lex, pending);
+    } while (!parse_rest(lex, pending, e));
+    return e;
 }
 
 PTR(Expr) parse_expr(std::istream& in) {
-    PTR(Expr) lhs = parse_addend(in);
-    skip_whitespace(in);
-
-    int c = in.peek();
-    if (c == '+') {
-        consume(in, '+');
-        PTR(Expr) rhs = parse_expr(in);
-        return NEW(AddExpr)(lhs, rhs);
-    }
-    else if (c == '=' && in.peek() == '=') {
-        consume(in, '=');
-        consume(in, '=');
-        PTR(Expr) rhs = parse_expr(in);
-        return NEW(EqExpr)(lhs, rhs);
-    }
-
-    return lhs;
+    std::string src((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    Lexer lex(src);
+    return parse_expr(lex);
 }
 
-PTR(Expr) parse_bool(std::istream& in) {
-    consume(in, '_'); // Consume '_'
-    if (in.peek() == 't') {
-        consume(in, 't');
-        consume(in, 'r');
-        consume(in, 'u');
-        consume(in, 'e');
-        return NEW(BoolExpr)(true);
-    } else if (in.peek() == 'f') {
-        consume(in, 'f');
-        consume(in, 'a');
-        consume(in, 'l');
-        consume(in, 's');
-        consume(in, 'e');
-        return NEW(BoolExpr)(false);
-    } else {
+PTR(Expr) parse_bool(Lexer& lex) {
+    token_t kind = lex.peek().kind;
+    if (kind != tok_true && kind != tok_false) {
         throw std::runtime_error("bad input");
     }
-}
-
-PTR(Expr) parse_eq(std::istream& in) {
-    PTR(Expr) lhs = parse_expr(in); // Parse the left-hand side of the equality
-    skip_whitespace(in);
-    if (in.peek() == '=') {
-        consume(in, '='); // Consume the first '='
-        consume(in, '='); // Consume the second '='
-        PTR(Expr) rhs = parse_expr(in); // Parse the right-hand side of the equality
-        return NEW(EqExpr)(lhs, rhs); // Return a NEW( EqExpr object
-    }
-    return lhs; // If no equality operator, return the left-hand side
-}
-
-PTR(Expr) parse_if(std::istream& in) {
-    skip_whitespace(in); // Skip any leading whitespace
-
-    // Parse the condition
-    PTR(Expr) condition = parse_expr(in);
-    skip_whitespace(in);
-
-    // Parse the _then keyword
-    consume(in, '_');
-    consume(in, 't');
-    consume(in, 'h');
-    consume(in, 'e');
-    consume(in, 'n');
-    skip_whitespace(in);
-
-    // Parse the then branch
-    PTR(Expr) then_branch = parse_expr(in);
-    skip_whitespace(in);
-
-    // Parse the _else keyword
-    consume(in, '_');
-    consume(in, 'e');
-    consume(in, 'l');
-    consume(in, 's');
-    consume(in, 'e');
-    skip_whitespace(in);
-
-    // Parse the else branch
-    PTR(Expr) else_branch = parse_expr(in);
-
-    // Return a NEW( IfExpr object
-    return NEW(IfExpr)(condition, then_branch, else_branch);
+    lex.next();
+    return NEW(BoolExpr)(kind == tok_true);
 }
 
 PTR(Expr) parse(std::istream& in) {
-    return parse_expr(in); // Delegate to parse_expr
+    PTR(Expr) e = parse_expr(in); // Delegate to parse_expr
+    Resolver::resolve(e);         // Turn variable names into frame slots
+    return e;
 }
 
-PTR(Expr) parse_str(const std::string& s) {
-    std::stringstream ss(s);
-    return parse_expr(ss);
+PTR(Expr) parse(std::string_view src) {
+    Lexer lex(src);
+    PTR(Expr) e = parse_expr(lex);
+    Resolver::resolve(e);
+    return e;
 }
 
-PTR(Expr) parse_fun(std::istream& in) {
-    skip_whitespace(in);
-
-    // Parse formal argument
-    consume(in, '(');
-    skip_whitespace(in);
-
-    std::string formal_arg;
-    while (isalpha(in.peek())) {
-        formal_arg += in.get();
-    }
-
-    skip_whitespace(in);
-    consume(in, ')');
-    skip_whitespace(in);
-
-    // Parse function body
-    PTR(Expr) body = parse_expr(in);
-
-    return NEW(FunExpr)(formal_arg, body);
+PTR(Expr) parse_str(const std::string& s) {
+    return parse(std::string_view(s));
 }
-
-PTR(Expr) parse_inner(std::istream& in) {
-    skip_whitespace(in);
-    int c = in.peek();
-
-    // Handle NEW(lines in pretty-printed input
-    while (c == '\n') {
-        consume(in, '\n');
-        skip_whitespace(in);
-        c = in.peek();
-    }
-
-    if ((c == '-') || isdigit(c)) {
-        return parse_num(in);
-    }
-    else if (c == '(') {
-        consume(in, '(');
-        PTR(Expr) e = parse_expr(in);
-        skip_whitespace(in);
-        consume(in, ')');
-        return e;
-    }
-    else if (isalpha(c)) {
-        return parse_var(in);
-    }
-    else if (c == '_') {
-        consume(in, '_');
-        if (in.peek() == 'f') {
-            // Could be _fun or _false
-            consume(in, 'f');
-            if (in.peek() == 'u') {
-                consume(in, 'u');
-                consume(in, 'n');
-                skip_whitespace(in);
-                return parse_fun(in);
-            }
-            else if (in.peek() == 'a') {
-                // Handle _false
-                consume(in, 'a');
-                consume(in, 'l');
-                consume(in, 's');
-                consume(in, 'e');
-                skip_whitespace(in);
-                return NEW(BoolExpr)(false);
-            }
-            else {
-                throw std::runtime_error("bad input");
-            }
-        }
-        else if (in.peek() == 't') {
-            // Handle _true
-            consume(in, 't');
-            consume(in, 'r');
-            consume(in, 'u');
-            consume(in, 'e');
-            skip_whitespace(in);
-            return NEW(BoolExpr)(true);
-        }
-        else if (in.peek() == 'i') {
-            // Handle _if
-            consume(in, 'i');
-            consume(in, 'f');
-            return parse_if(in);
-        }
-        else if (in.peek() == 'l') {
-            // Handle _let
-            consume(in, 'l');
-            consume(in, 'e');
-            consume(in, 't');
-            skip_whitespace(in);
-            return parse_let(in);
-        }
-        else {
-            throw std::runtime_error("bad input");
-        }
-    }
-    else {
-        throw std::runtime_error("bad input");
-    }
-}
\ No newline at end of file
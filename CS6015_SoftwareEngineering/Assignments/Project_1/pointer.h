@@ -12,14 +12,40 @@ class Expr;
 class Val;
 class Env;
 
+// Pointer modes (pass -DUSE_PLAIN_POINTERS=1 or -DUSE_ARENA_POINTERS=1 to select):
+//   default: reference-counted std::shared_ptr
+//   plain:   raw new, never freed
+//   arena:   raw pointers into the current Arena (see arena.h), freed in one shot
+//
+// UNOWNED(T)(p) wraps a pointer to a statically allocated object that NEW
+// did not create; in shared_ptr mode the result has no control block, so
+// copying it never touches a reference count.
+#ifndef USE_PLAIN_POINTERS
 #define USE_PLAIN_POINTERS 0
-#if USE_PLAIN_POINTERS
+#endif
+#ifndef USE_ARENA_POINTERS
+#define USE_ARENA_POINTERS 0
+#endif
+
+#if USE_ARENA_POINTERS
+
+#include "arena.h"
+
+# define NEW(T)    arena_new<T>
+# define PTR(T)    T*
+# define CAST(T)   dynamic_cast<T*>
+# define CLASS(T)  class T
+# define THIS      this
+# define UNOWNED(T) static_cast<T*>
+
+#elif USE_PLAIN_POINTERS
 
 # define NEW(T)    new T
 # define PTR(T)    T*
 # define CAST(T)   dynamic_cast<T*>
 # define CLASS(T)  class T
 # define THIS      this
+# define UNOWNED(T) static_cast<T*>
 
 #else
 
@@ -28,7 +54,13 @@ class Env;
 # define CAST(T)   std::dynamic_pointer_cast<T>
 # define CLASS(T)  class T : public std::enable_shared_from_this<T>
 # define THIS      shared_from_this()
+# define UNOWNED(T) unowned_ptr<T>
+
+template<class T>
+std::shared_ptr<T> unowned_ptr(T* p) {
+    return std::shared_ptr<T>(std::shared_ptr<T>(), p); // Aliasing constructor: no owner
+}
 
 #endif
 
-#endif
\ No newline at end of file
+#endif
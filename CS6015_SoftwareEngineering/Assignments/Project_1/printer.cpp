@@ -0,0 +1,133 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "printer.h"
+#include <algorithm>
+
+Printer::Printer(Writer& out) : out(out), mark(0), depth(0) {}
+
+void Printer::print(Writer& out, PTR(Expr) const& e) {
+    Printer p(out);
+    p.print(e);
+    p.run(0);
+}
+
+void Printer::pretty_print(Writer& out, PTR(Expr) const& e, precedence_t prec) {
+    Printer p(out);
+    p.pretty_print(e, prec);
+    p.run(0);
+}
+
+void Printer::text(std::string_view s) {
+    if (parts.size() == mark) {
+        out << s; // Nothing is scheduled ahead of it
+        return;
+    }
+    parts.push_back(Part{part_text, nullptr, s, 0, prec_none, 0, 0});
+}
+
+void Printer::number(int n) {
+    if (parts.size() == mark) {
+        out << n;
+        return;
+    }
+    parts.push_back(Part{part_number, nullptr, {}, n, prec_none, 0, 0});
+}
+
+void Printer::print(PTR(Expr) const& e) {
+    if (parts.size() == mark && depth < max_depth) {
+        depth++;
+        e->print(*this); // Nothing is scheduled ahead of it: print it now, by recursion
+        finish();
+        depth--;
+        return;
+    }
+    parts.push_back(Part{part_print, &*e, {}, 0, prec_none, 0, 0});
+}
+
+void Printer::pretty_print_at(PTR(Expr) const& e, precedence_t prec, size_t line) {
+    if (parts.size() == mark && depth < max_depth) {
+        depth++;
+        e->pretty_print_at(*this, prec, line);
+        finish();
+        depth--;
+        return;
+    }
+    parts.push_back(Part{part_pretty_at, &*e, {}, 0, prec, line, 0});
+}
+
+void Printer::pretty_print(PTR(Expr) const& e, precedence_t prec) {
+    if (parts.size() == mark && depth < max_depth) {
+        depth++;
+        lines.push_back(out.position()); // A new line record, starting here
+        e->pretty_print_at(*this, prec, lines.size() - 1);
+        finish();
+        depth--;
+        return;
+    }
+    parts.push_back(Part{part_pretty, &*e, {}, 0, prec, 0, 0});
+}
+
+void Printer::newline(size_t line, size_t indent) {
+    if (parts.size() == mark) {
+        out << '\n';
+        lines[line] = out.position();
+        out.repeat(' ', indent);
+        return;
+    }
+    parts.push_back(Part{part_newline, nullptr, {}, 0, prec_none, line, indent});
+}
+
+size_t Printer::column(size_t line) const {
+    return out.position() - lines[line];
+}
+
+void Printer::finish() {
+    if (parts.size() > mark) {
+        // The expression scheduled its parts first to last; run them in that order
+        std::reverse(parts.begin() + mark, parts.end());
+        run(mark);
+    }
+}
+
+void Printer::run(size_t base) {
+    while (parts.size() > base) {
+        Part part = parts.back();
+        parts.pop_back();
+
+        size_t outer = mark;
+        mark = parts.size();
+        switch (part.kind) {
+            case part_text:
+                out << part.text;
+                break;
+            case part_number:
+                out << part.num;
+                break;
+            case part_newline:
+                newline(part.line, part.indent);
+                break;
+            case part_print:
+                part.expr->print(*this);
+                break;
+            case part_pretty_at:
+                part.expr->pretty_print_at(*this, part.prec, part.line);
+                break;
+            case part_pretty:
+                lines.push_back(out.position()); // A new line record, starting here
+                part.expr->pretty_print_at(*this, part.prec, lines.size() - 1);
+                break;
+        }
+
+        // Its parts go on top of the stack, first part last
+        std::reverse(parts.begin() + mark, parts.end());
+        mark = outer;
+    }
+}
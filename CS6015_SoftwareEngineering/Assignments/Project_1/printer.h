@@ -0,0 +1,131 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PRINTER_H
+#define PRINTER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "pointer.h"
+#include "expr.h"
+#include "writer.h"
+
+/**
+ * @class Printer
+ * @brief Prints an expression with an explicit stack instead of recursion.
+ *
+ * Each expression's print() and pretty_print_at() do not print their
+ * subexpressions directly; they schedule their parts (text, numbers,
+ * subexpressions, newlines) on the Printer, in output order. The Printer
+ * then works through the scheduled parts one at a time, so printing depth
+ * is limited by memory rather than by the thread stack.
+ *
+ * A part scheduled while nothing is waiting ahead of it is printed at once,
+ * so text before an expression's first subexpression is already counted by
+ * column(). That includes subexpressions, which are printed at once by
+ * plain recursion until max_depth of them are nested; only deeper ones
+ * wait on the explicit stack, so ordinary trees print as fast as with
+ * recursion.
+ */
+class Printer {
+public:
+    /**
+     * @brief Creates a Printer that writes to the given Writer.
+     */
+    explicit Printer(Writer& out);
+
+    /**
+     * @brief Prints an expression in its fully parenthesized form.
+     */
+    static void print(Writer& out, PTR(Expr) const& e);
+
+    /**
+     * @brief Pretty-prints an expression, counting columns from the current position.
+     */
+    static void pretty_print(Writer& out, PTR(Expr) const& e, precedence_t prec);
+
+    /**
+     * @brief Schedules text.
+     * @param s The text; it must stay valid until the Printer has written it.
+     */
+    void text(std::string_view s);
+
+    /**
+     * @brief Schedules an integer, in decimal.
+     */
+    void number(int n);
+
+    /**
+     * @brief Schedules a subexpression in its fully parenthesized form.
+     */
+    void print(PTR(Expr) const& e);
+
+    /**
+     * @brief Schedules a subexpression that continues the current line.
+     * @param e The subexpression.
+     * @param prec The precedence level of the parent expression.
+     * @param line The record of where the current line starts.
+     */
+    void pretty_print_at(PTR(Expr) const& e, precedence_t prec, size_t line);
+
+    /**
+     * @brief Schedules a subexpression that counts its columns from where it starts.
+     *
+     * Used for a _let's right-hand side and an _if's condition, whose own
+     * newlines are indented relative to where they begin.
+     */
+    void pretty_print(PTR(Expr) const& e, precedence_t prec);
+
+    /**
+     * @brief Schedules a newline that starts a new line record and indents it.
+     * @param line The line record to update.
+     * @param indent Number of spaces after the newline.
+     */
+    void newline(size_t line, size_t indent);
+
+    /**
+     * @brief Number of bytes written since the given line started.
+     */
+    size_t column(size_t line) const;
+
+private:
+    typedef enum {
+        part_text,
+        part_number,
+        part_print,
+        part_pretty_at,
+        part_pretty,
+        part_newline
+    } part_t;
+
+    struct Part {
+        part_t kind;
+        Expr* expr;            // part_print, part_pretty_at, part_pretty
+        std::string_view text; // part_text
+        int num;               // part_number
+        precedence_t prec;     // part_pretty_at, part_pretty
+        size_t line;           // part_pretty_at, part_newline
+        size_t indent;         // part_newline
+    };
+
+    Writer& out;
+    std::vector<Part> parts;  // Scheduled parts, next one last
+    std::vector<size_t> lines; // Position where each line record's line starts
+    size_t mark;              // Size of parts before the current expression scheduled its own
+    int depth;                // Subexpressions being printed by recursion
+
+    static const int max_depth = 1000; ///< Most subexpressions printed by recursion at once.
+
+    void finish();
+    void run(size_t base);
+};
+
+#endif // PRINTER_H
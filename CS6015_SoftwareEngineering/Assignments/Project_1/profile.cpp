@@ -0,0 +1,203 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "profile.h"
+#include "val.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+
+Profiler* Profiler::active = nullptr;
+
+static int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Line and column (both from 1) of a byte offset; 0 and 0 if it is unknown
+static void line_column(std::string_view source, int position, int& line, int& column) {
+    line = 0;
+    column = 0;
+    if (position < 0 || (size_t)position > source.size()) {
+        return;
+    }
+    line = 1;
+    size_t line_start = 0;
+    for (size_t i = 0; i < (size_t)position; i++) {
+        if (source[i] == '\n') {
+            line++;
+            line_start = i + 1;
+        }
+    }
+    column = (int)(position - line_start) + 1;
+}
+
+Profiler::Profiler() : kinds(), allocations(0) {
+    NumVal::make(0); // Builds NumVal's table of small numbers now, so it is never counted
+}
+
+const char* Profiler::name(prof_kind_t kind) {
+    static const char* const names[prof_kinds] = {
+        "NumExpr", "BigNumExpr", "AddExpr", "MultExpr", "VarExpr", "LetExpr",
+        "BoolExpr", "IfExpr", "EqExpr", "FunExpr", "CallExpr"
+    };
+    return names[kind];
+}
+
+void Profiler::enter(prof_kind_t kind) {
+    kinds[kind].calls++;
+    kinds[kind].depth++;
+    stack.push_back(Frame{kind, now_ns(), 0});
+}
+
+void Profiler::leave() {
+    Frame f = stack.back();
+    stack.pop_back();
+    int64_t elapsed = now_ns() - f.start;
+    KindStats& k = kinds[f.kind];
+    k.exclusive_ns += elapsed - f.nested;
+    if (--k.depth == 0) {
+        k.inclusive_ns += elapsed;
+    }
+    if (!stack.empty()) {
+        stack.back().nested += elapsed;
+    }
+}
+
+void Profiler::define_function(const Expr* body, int position, const std::string& formal_arg) {
+    auto found = functions.find(body);
+    if (found == functions.end()) {
+        functions.emplace(body, FunctionStats{position, formal_arg, 0, 0, 0, 0, 0, 0});
+    }
+}
+
+void Profiler::enter_function(const Expr* body) {
+    FunctionStats& f = functions.try_emplace(body, FunctionStats{-1, "?", 0, 0, 0, 0, 0, 0}).first->second;
+    f.calls++;
+    if (f.depth++ == 0) {
+        f.start = now_ns();
+        f.allocations_at_start = allocations;
+    }
+}
+
+void Profiler::leave_function(const Expr* body) {
+    FunctionStats& f = functions[body];
+    if (--f.depth == 0) {
+        f.inclusive_ns += now_ns() - f.start;
+        f.allocations += allocations - f.allocations_at_start;
+    }
+}
+
+uint64_t Profiler::calls(prof_kind_t kind) const {
+    return kinds[kind].calls;
+}
+
+uint64_t Profiler::allocations_in(prof_kind_t kind) const {
+    return kinds[kind].allocations;
+}
+
+uint64_t Profiler::total_allocations() const {
+    return allocations;
+}
+
+std::vector<const Profiler::FunctionStats*> Profiler::hottest(size_t top) const {
+    std::vector<const FunctionStats*> called;
+    for (auto& entry : functions) {
+        if (entry.second.calls > 0) {
+            called.push_back(&entry.second);
+        }
+    }
+    std::sort(called.begin(), called.end(), [](const FunctionStats* a, const FunctionStats* b) {
+        return a->inclusive_ns != b->inclusive_ns ? a->inclusive_ns > b->inclusive_ns : a->position < b->position;
+    });
+    if (called.size() > top) {
+        called.resize(top);
+    }
+    return called;
+}
+
+void Profiler::report(std::ostream& out, std::string_view source, size_t top) const {
+    std::vector<prof_kind_t> order;
+    uint64_t nodes = 0;
+    uint64_t total_ns = 0;
+    for (int k = 0; k < prof_kinds; k++) {
+        if (kinds[k].calls > 0) {
+            order.push_back((prof_kind_t)k);
+        }
+        nodes += kinds[k].calls;
+        total_ns += kinds[k].exclusive_ns;
+    }
+    std::sort(order.begin(), order.end(), [this](prof_kind_t a, prof_kind_t b) {
+        return kinds[a].exclusive_ns > kinds[b].exclusive_ns;
+    });
+
+    char line[160];
+    std::snprintf(line, sizeof line, "profile: %llu nodes evaluated in %.3f ms, %llu values allocated\n",
+                  (unsigned long long)nodes, total_ns / 1e6, (unsigned long long)allocations);
+    out << line;
+    std::snprintf(line, sizeof line, "  %-10s %12s %14s %14s %12s\n", "node", "calls", "inclusive ms",
+                  "exclusive ms", "values");
+    out << line;
+    for (prof_kind_t k : order) {
+        const KindStats& s = kinds[k];
+        std::snprintf(line, sizeof line, "  %-10s %12llu %14.3f %14.3f %12llu\n", name(k),
+                      (unsigned long long)s.calls, s.inclusive_ns / 1e6, s.exclusive_ns / 1e6,
+                      (unsigned long long)s.allocations);
+        out << line;
+    }
+
+    std::vector<const FunctionStats*> funs = hottest(top);
+    if (funs.empty()) {
+        return;
+    }
+    out << "hottest functions:\n";
+    std::snprintf(line, sizeof line, "  %-10s %-16s %12s %14s %12s\n", "at", "function", "calls",
+                  "inclusive ms", "values");
+    out << line;
+    for (const FunctionStats* f : funs) {
+        int l;
+        int c;
+        line_column(source, f->position, l, c);
+        std::string at = l > 0 ? std::to_string(l) + ":" + std::to_string(c) : "?";
+        std::string head = "_fun (" + f->formal_arg + ")";
+        std::snprintf(line, sizeof line, "  %-10s %-16s %12llu %14.3f %12llu\n", at.c_str(), head.c_str(),
+                      (unsigned long long)f->calls, f->inclusive_ns / 1e6, (unsigned long long)f->allocations);
+        out << line;
+    }
+}
+
+void Profiler::report_json(std::ostream& out, std::string_view source, size_t top) const {
+    out << "{\"allocations\":" << allocations << ",\"nodes\":[";
+    bool first = true;
+    for (int k = 0; k < prof_kinds; k++) {
+        const KindStats& s = kinds[k];
+        if (s.calls == 0) {
+            continue;
+        }
+        out << (first ? "" : ",") << "{\"type\":\"" << name((prof_kind_t)k) << "\",\"calls\":" << s.calls
+            << ",\"inclusive_ns\":" << s.inclusive_ns << ",\"exclusive_ns\":" << s.exclusive_ns
+            << ",\"allocations\":" << s.allocations << "}";
+        first = false;
+    }
+    out << "],\"functions\":[";
+    first = true;
+    for (const FunctionStats* f : hottest(top)) {
+        int l;
+        int c;
+        line_column(source, f->position, l, c);
+        // Argument names are letters only, so they need no escaping
+        out << (first ? "" : ",") << "{\"line\":" << l << ",\"column\":" << c << ",\"arg\":\"" << f->formal_arg
+            << "\",\"calls\":" << f->calls << ",\"inclusive_ns\":" << f->inclusive_ns
+            << ",\"allocations\":" << f->allocations << "}";
+        first = false;
+    }
+    out << "]}\n";
+}
@@ -0,0 +1,225 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class Expr;
+
+/**
+ * @brief The Expr subclasses the profiler tells apart.
+ */
+typedef enum {
+    prof_num,
+    prof_big_num,
+    prof_add,
+    prof_mult,
+    prof_var,
+    prof_let,
+    prof_bool,
+    prof_if,
+    prof_eq,
+    prof_fun,
+    prof_call,
+    prof_kinds ///< Number of kinds.
+} prof_kind_t;
+
+/**
+ * @class Profiler
+ * @brief Measures where the tree-walking interpreter spends its time (--profile).
+ *
+ * For each kind of expression it counts the interp() calls, their
+ * inclusive time (counting only the outermost of nested calls of the same
+ * kind, so recursion is not counted twice), their exclusive time (minus the
+ * nested interp() calls), and the values allocated while that kind was the
+ * innermost one running. For each function, identified by where its _fun
+ * is in the source, it counts calls, inclusive time and the values
+ * allocated during them.
+ *
+ * Nothing is measured unless a Profiler is installed as active. The hooks
+ * in interp() and FunVal::call only test that pointer, so the interpreter
+ * runs at full speed without --profile. Times include the cost of reading
+ * the clock around each node, so they overstate very cheap nodes.
+ *
+ * The active profiler is shared by every thread; profile one evaluation at
+ * a time (--profile is only accepted with --interp and --run).
+ */
+class Profiler {
+public:
+    Profiler();
+
+    static Profiler* active; ///< The profiler recording now, or nullptr.
+
+    /**
+     * @brief Counts a value allocation against the innermost running expression.
+     */
+    static void count_allocation() {
+        if (active) {
+            active->allocations++;
+            if (!active->stack.empty()) {
+                active->kinds[active->stack.back().kind].allocations++;
+            }
+        }
+    }
+
+    /**
+     * @brief Starts timing an interp() call of the given kind.
+     */
+    void enter(prof_kind_t kind);
+
+    /**
+     * @brief Stops timing the most recent interp() call.
+     */
+    void leave();
+
+    /**
+     * @brief Records where a function starts in the source, when a closure is made from it.
+     * @param body The function's body, which identifies it.
+     * @param position Byte offset of its _fun in the source, or -1 if unknown.
+     * @param formal_arg The name of its argument.
+     */
+    void define_function(const Expr* body, int position, const std::string& formal_arg);
+
+    /**
+     * @brief Starts timing a call of the function with the given body.
+     */
+    void enter_function(const Expr* body);
+
+    /**
+     * @brief Stops timing a call of the function with the given body.
+     */
+    void leave_function(const Expr* body);
+
+    /**
+     * @brief Number of interp() calls of a kind.
+     */
+    uint64_t calls(prof_kind_t kind) const;
+
+    /**
+     * @brief Values allocated while a kind was the innermost expression running.
+     */
+    uint64_t allocations_in(prof_kind_t kind) const;
+
+    /**
+     * @brief Values allocated in all.
+     */
+    uint64_t total_allocations() const;
+
+    /**
+     * @brief Writes a table of the kinds by exclusive time and the hottest functions.
+     * @param out Where to write it (--profile writes to standard error).
+     * @param source The program's source, to turn offsets into line:column.
+     * @param top How many functions to list.
+     */
+    void report(std::ostream& out, std::string_view source, size_t top = 10) const;
+
+    /**
+     * @brief Writes the same report as a JSON object (--profile-json).
+     */
+    void report_json(std::ostream& out, std::string_view source, size_t top = 10) const;
+
+    /**
+     * @brief The class name of a kind, such as "AddExpr".
+     */
+    static const char* name(prof_kind_t kind);
+
+private:
+    struct KindStats {
+        uint64_t calls;
+        uint64_t inclusive_ns;
+        uint64_t exclusive_ns;
+        uint64_t allocations;
+        int depth;             // Calls of this kind running now
+    };
+
+    struct Frame {
+        prof_kind_t kind;
+        int64_t start;         // Nanoseconds on the steady clock
+        int64_t nested;        // Nanoseconds spent in nested interp() calls
+    };
+
+    struct FunctionStats {
+        int position;
+        std::string formal_arg;
+        uint64_t calls;
+        uint64_t inclusive_ns;
+        uint64_t allocations;
+        int depth;             // Calls running now; only the outermost is timed
+        int64_t start;
+        uint64_t allocations_at_start;
+    };
+
+    KindStats kinds[prof_kinds];
+    std::vector<Frame> stack;
+    std::unordered_map<const Expr*, FunctionStats> functions;
+    uint64_t allocations;
+
+    std::vector<const FunctionStats*> hottest(size_t top) const;
+};
+
+/**
+ * @class ProfileScope
+ * @brief Times one interp() call while a Profiler is active.
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(prof_kind_t kind) : profiler(Profiler::active) {
+        if (profiler) {
+            profiler->enter(kind);
+        }
+    }
+
+    ~ProfileScope() {
+        if (profiler) {
+            profiler->leave();
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    Profiler* profiler;
+};
+
+/**
+ * @class ProfileCall
+ * @brief Times one function call while a Profiler is active.
+ */
+class ProfileCall {
+public:
+    explicit ProfileCall(const Expr* body) : profiler(Profiler::active), body(body) {
+        if (profiler) {
+            profiler->enter_function(body);
+        }
+    }
+
+    ~ProfileCall() {
+        if (profiler) {
+            profiler->leave_function(body);
+        }
+    }
+
+    ProfileCall(const ProfileCall&) = delete;
+    ProfileCall& operator=(const ProfileCall&) = delete;
+
+private:
+    Profiler* profiler;
+    const Expr* body;
+};
+
+#endif // PROFILE_H
@@ -0,0 +1,48 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "program.h"
+#include "env.h"
+#include "optimize.h"
+#include "parse.hpp"
+#include <stdexcept>
+
+Program::Program(std::string_view source, std::vector<std::string> inputs)
+    : names(std::move(inputs)), body(Optimizer::optimize(parse(source))) {}
+
+PTR(Val) Program::run(const std::vector<PTR(Val)>& args) const {
+    if (args.size() != names.size()) {
+        throw std::runtime_error("expected " + std::to_string(names.size()) + " inputs, got " +
+                                 std::to_string(args.size()));
+    }
+    // The inputs are free in the resolved body, so it finds them by name
+    PTR(Env) env = Env::empty;
+    for (size_t i = 0; i < args.size(); i++) {
+        env = NEW(ExtendedEnv)(names[i], args[i], env);
+    }
+    return body->interp(env);
+}
+
+std::string Program::run_to_string(const std::vector<int>& args) const {
+    std::vector<PTR(Val)> vals;
+    vals.reserve(args.size());
+    for (int n : args) {
+        vals.push_back(NumVal::make(n));
+    }
+    return run(vals)->to_string();
+}
+
+const std::vector<std::string>& Program::inputs() const {
+    return names;
+}
+
+PTR(Expr) Program::expr() const {
+    return body;
+}
@@ -0,0 +1,76 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "pointer.h"
+#include "expr.h"
+#include "val.h"
+
+/**
+ * @class Program
+ * @brief An MSDScript program parsed once and run many times (libmsdscript).
+ *
+ * This is the entry point for embedding the interpreter instead of running
+ * the msdscript binary once per expression. A Program is parsed, constant
+ * folded and resolved when it is created; run() then only evaluates it.
+ *
+ * The program's inputs are free variables named when it is created; each
+ * run binds them to the values it is given. run() does not modify the
+ * Program, so one Program may be run from several threads at once.
+ *
+ * Settings of the command-line flags are process-wide here too: set
+ * FunVal::max_depth, BigInt::enabled or CallCache::enable before running.
+ */
+class Program {
+public:
+    /**
+     * @brief Parses and prepares a program.
+     * @param source The program text, as msdscript reads it from standard input.
+     * @param inputs Names of the free variables that every run binds, in order.
+     * @throws std::runtime_error with the parser's message if source is invalid.
+     */
+    explicit Program(std::string_view source, std::vector<std::string> inputs = {});
+
+    /**
+     * @brief Evaluates the program.
+     * @param args One value per input, in the order the inputs were named.
+     * @return The program's value.
+     * @throws std::runtime_error if args has the wrong length, or with the
+     *         interpreter's message if evaluation fails (as msdscript --interp).
+     */
+    PTR(Val) run(const std::vector<PTR(Val)>& args = {}) const;
+
+    /**
+     * @brief Evaluates the program with number inputs and prints its value.
+     * @return The value as msdscript --interp prints it.
+     */
+    std::string run_to_string(const std::vector<int>& args) const;
+
+    /**
+     * @brief Names of the inputs, in the order run() expects their values.
+     */
+    const std::vector<std::string>& inputs() const;
+
+    /**
+     * @brief The prepared expression that run() evaluates.
+     */
+    PTR(Expr) expr() const;
+
+private:
+    std::vector<std::string> names;
+    PTR(Expr) body;
+};
+
+#endif // PROGRAM_H
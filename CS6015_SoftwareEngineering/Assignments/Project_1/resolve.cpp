@@ -0,0 +1,142 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "resolve.h"
+#include <algorithm>
+
+void Resolver::resolve(PTR(Expr) e) {
+    if (e->is_interned()) {
+        return; // Shared nodes cannot hold per-occurrence slots; see hashcons.h
+    }
+    Resolver r;
+    r.visit(e);
+    r.run(0);
+}
+
+void Resolver::visit(PTR(Expr) const& e) {
+    schedule(Step{step_visit, &*e, Symbol(), nullptr, nullptr});
+}
+
+bool Resolver::lookup(Symbol name, int& depth, int& slot) {
+    // Find the innermost frame that binds or already captures the name
+    int f = (int)frames.size() - 1;
+    bool found = false;
+    for (; f >= 0 && !found; f--) {
+        const std::vector<std::pair<Symbol, int>>& active = frames[f].active;
+        for (int i = (int)active.size() - 1; i >= 0 && !found; i--) {
+            if (active[i].first == name) {
+                depth = 0;
+                slot = active[i].second;
+                found = true;
+            }
+        }
+        const std::vector<FreeVar>* captures = frames[f].captures;
+        for (size_t i = 0; captures && i < captures->size() && !found; i++) {
+            if ((*captures)[i].name == name) {
+                depth = 1;
+                slot = (int)i;
+                found = true;
+            }
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    // Every function between that frame and this one captures it from the one outside
+    for (f += 2; f < (int)frames.size(); f++) {
+        std::vector<FreeVar>* captures = frames[f].captures;
+        captures->push_back(FreeVar{name, depth, slot});
+        depth = 1;
+        slot = (int)captures->size() - 1;
+    }
+    return true;
+}
+
+bool Resolver::in_frame() {
+    return !frames.empty();
+}
+
+void Resolver::open_frame(Symbol first, std::vector<FreeVar>* captures) {
+    schedule(Step{step_open, nullptr, first, nullptr, captures});
+}
+
+void Resolver::close_frame(int& size) {
+    schedule(Step{step_close, nullptr, Symbol(), &size, nullptr});
+}
+
+void Resolver::bind(Symbol name, int& slot) {
+    schedule(Step{step_bind, nullptr, name, &slot, nullptr});
+}
+
+void Resolver::unbind() {
+    schedule(Step{step_unbind, nullptr, Symbol(), nullptr, nullptr});
+}
+
+void Resolver::schedule(const Step& step) {
+    if (steps.size() != mark || (step.kind == step_visit && depth >= max_depth)) {
+        steps.push_back(step); // Runs after the steps ahead of it
+        return;
+    }
+
+    // Nothing is waiting ahead of it: run it now
+    depth++;
+    perform(step);
+    if (steps.size() > mark) {
+        // It scheduled steps of its own; run them before going on
+        std::reverse(steps.begin() + mark, steps.end());
+        run(mark);
+    }
+    depth--;
+}
+
+void Resolver::perform(const Step& step) {
+    switch (step.kind) {
+        case step_visit:
+            step.expr->resolve(*this);
+            break;
+        case step_open:
+            if (step.captures) {
+                step.captures->clear(); // Resolving again starts over
+            }
+            frames.push_back(Frame{{{step.name, 0}}, 1, step.captures});
+            break;
+        case step_close:
+            *step.out = frames.back().size;
+            frames.pop_back();
+            break;
+        case step_bind: {
+            // Slots are never reused within a frame: a closure created earlier in
+            // the same call may still be reading a previous binding's slot.
+            Frame& f = frames.back();
+            *step.out = f.size++;
+            f.active.push_back({step.name, *step.out});
+            break;
+        }
+        case step_unbind:
+            frames.back().active.pop_back();
+            break;
+    }
+}
+
+void Resolver::run(size_t base) {
+    while (steps.size() > base) {
+        Step step = steps.back();
+        steps.pop_back();
+
+        size_t outer = mark;
+        mark = steps.size();
+        perform(step);
+
+        // Its steps go on top of the stack, first step last
+        std::reverse(steps.begin() + mark, steps.end());
+        mark = outer;
+    }
+}
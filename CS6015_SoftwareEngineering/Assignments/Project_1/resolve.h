@@ -0,0 +1,133 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RESOLVE_H
+#define RESOLVE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "pointer.h"
+#include "expr.h"
+
+/**
+ * @class Resolver
+ * @brief Resolves variable names to (depth, slot) frame indices.
+ *
+ * Every function call gets one flat FrameEnv holding its argument in slot 0
+ * and each of the body's _let bindings in a slot of its own. A _let that is
+ * not inside any function opens such a frame for itself and the _let
+ * expressions nested in its body. After resolution, a VarExpr finds its
+ * value by following `depth` frame links and indexing `slot`, instead of
+ * comparing names down an ExtendedEnv chain.
+ *
+ * Functions are closure converted: a variable that a function's body uses
+ * from outside the function is one of its FunExpr's captures, which the
+ * FunVal copies when it is created, so a closure keeps only the values it
+ * needs alive. A call's frame reads them at depth 1, so `depth` is never
+ * more than 1 inside a function. A function nested in another captures a
+ * variable of an outer scope through each function in between.
+ *
+ * Resolution writes into the tree, so it is run once on freshly parsed
+ * trees (see parse()). Variables that are not bound anywhere stay
+ * unresolved and are looked up by name, which reports them as free.
+ * Interned trees (see hashcons.h) are shared, so they are left unresolved.
+ *
+ * An expression's resolve() schedules its subexpressions and frame changes
+ * with visit(), open_frame(), bind() and friends, which run in the order
+ * scheduled. A step scheduled while nothing is waiting ahead of it runs at
+ * once, so ordinary trees are resolved by plain recursion; past max_depth
+ * nested visits, steps wait on an explicit stack instead, so tree depth is
+ * limited by memory rather than by the thread stack. lookup() and
+ * in_frame() answer at once.
+ */
+class Resolver {
+public:
+    /**
+     * @brief Resolves every variable in the given expression.
+     * @param e The expression to resolve in place.
+     */
+    static void resolve(PTR(Expr) e);
+
+    /**
+     * @brief Schedules a subexpression to be resolved.
+     */
+    void visit(PTR(Expr) const& e);
+
+    /**
+     * @brief Finds the innermost binding of a name, capturing it if it is outside this function.
+     * @param name The variable name.
+     * @param depth Set to 0 for a slot of the current frame, or 1 for a captured variable.
+     * @param slot Set to the binding's slot in its frame, or its index in the captures.
+     * @return false if the name is not bound by any enclosing frame.
+     */
+    bool lookup(Symbol name, int& depth, int& slot);
+
+    /**
+     * @brief Checks whether any frame is open at this point of the walk.
+     */
+    bool in_frame();
+
+    /**
+     * @brief Schedules opening a new frame whose slot 0 is bound to the given name.
+     * @param first The name bound in slot 0.
+     * @param captures For a function's frame, filled with the variables the function
+     *        captures; nullptr for the frame of a top-level _let.
+     */
+    void open_frame(Symbol first, std::vector<FreeVar>* captures = nullptr);
+
+    /**
+     * @brief Schedules closing the innermost frame.
+     * @param size Set to the number of slots the frame needs.
+     */
+    void close_frame(int& size);
+
+    /**
+     * @brief Schedules binding a name to a new slot of the innermost frame.
+     * @param name The variable name; it must outlive the walk.
+     * @param slot Set to the slot.
+     */
+    void bind(Symbol name, int& slot);
+
+    /**
+     * @brief Schedules the end of the scope of the most recent bind().
+     */
+    void unbind();
+
+private:
+    struct Frame {
+        std::vector<std::pair<Symbol, int>> active; // Bindings in scope, innermost last
+        int size;                                   // Slots allocated so far
+        std::vector<FreeVar>* captures;             // The function's captures; nullptr for a _let
+    };
+
+    typedef enum { step_visit, step_open, step_close, step_bind, step_unbind } step_t;
+
+    struct Step {
+        step_t kind;
+        Expr* expr;              // step_visit
+        Symbol name;             // step_open, step_bind
+        int* out;                // step_close, step_bind
+        std::vector<FreeVar>* captures; // step_open
+    };
+
+    std::vector<Frame> frames;
+    std::vector<Step> steps; // Scheduled steps, next one last
+    size_t mark = 0;         // Size of steps before the current expression scheduled its own
+    int depth = 0;           // Subexpressions being resolved by recursion
+
+    static const int max_depth = 1000; ///< Most subexpressions resolved by recursion at once.
+
+    void schedule(const Step& step);
+    void perform(const Step& step);
+    void run(size_t base);
+};
+
+#endif // RESOLVE_H
@@ -0,0 +1,487 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "serve.h"
+#include "batch.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Reply bytes queued on a connection before it stops being read from
+static const size_t max_pending_output = 1 << 20;
+
+// Requests of one connection being evaluated before it stops being read from
+static const uint64_t max_pending_requests = 1024;
+
+static double now_us() {
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::runtime_error socket_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+static void put_length(std::string& out, uint32_t n) {
+    out += (char)(n >> 24);
+    out += (char)(n >> 16);
+    out += (char)(n >> 8);
+    out += (char)n;
+}
+
+static uint32_t get_length(const char* p) {
+    const unsigned char* u = (const unsigned char*)p;
+    return (uint32_t)u[0] << 24 | (uint32_t)u[1] << 16 | (uint32_t)u[2] << 8 | u[3];
+}
+
+// ====================== LatencyStats ======================
+
+void LatencyStats::add(double us) {
+    samples.push_back(us);
+    sorted = false;
+}
+
+void LatencyStats::merge(const LatencyStats& other) {
+    samples.insert(samples.end(), other.samples.begin(), other.samples.end());
+    sorted = false;
+}
+
+size_t LatencyStats::count() const {
+    return samples.size();
+}
+
+void LatencyStats::sort() const {
+    if (!sorted) {
+        std::sort(samples.begin(), samples.end());
+        sorted = true;
+    }
+}
+
+double LatencyStats::percentile(double p) const {
+    if (samples.empty()) {
+        return 0;
+    }
+    sort();
+    // Nearest rank: the smallest sample with at least p percent at or below it
+    size_t rank = (size_t)(p / 100 * samples.size() + 0.999999);
+    return samples[std::min(std::max(rank, (size_t)1), samples.size()) - 1];
+}
+
+std::string LatencyStats::report() const {
+    char line[200];
+    std::snprintf(line, sizeof line, "%zu requests, latency p50 %.1f us, p90 %.1f us, p99 %.1f us, "
+                  "p99.9 %.1f us, max %.1f us", count(), percentile(50), percentile(90), percentile(99),
+                  percentile(99.9), percentile(100));
+    return line;
+}
+
+// ====================== Blocking frames ======================
+
+void send_frame(int fd, std::string_view payload) {
+    std::string frame;
+    frame.reserve(4 + payload.size());
+    put_length(frame, (uint32_t)payload.size());
+    frame.append(payload.data(), payload.size());
+    size_t sent = 0;
+    while (sent < frame.size()) {
+        ssize_t n = ::send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw socket_error("send failed");
+        }
+        sent += n;
+    }
+}
+
+// Reads exactly n bytes; false if the peer closed before the first one
+static bool recv_all(int fd, char* p, size_t n) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = ::recv(fd, p + got, n - got, 0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw socket_error("recv failed");
+        }
+        if (r == 0) {
+            if (got == 0) {
+                return false;
+            }
+            throw std::runtime_error("connection closed mid-frame");
+        }
+        got += r;
+    }
+    return true;
+}
+
+bool recv_frame(int fd, std::string& payload) {
+    char header[4];
+    if (!recv_all(fd, header, 4)) {
+        return false;
+    }
+    payload.resize(get_length(header));
+    if (!payload.empty() && !recv_all(fd, &payload[0], payload.size())) {
+        throw std::runtime_error("connection closed mid-frame");
+    }
+    return true;
+}
+
+static sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) {
+        throw std::runtime_error("socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+int connect_socket(const std::string& path) {
+    sockaddr_un addr = socket_address(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw socket_error("socket failed");
+    }
+    if (::connect(fd, (sockaddr*)&addr, sizeof addr) != 0) {
+        std::runtime_error e = socket_error("cannot connect to " + path);
+        ::close(fd);
+        throw e;
+    }
+    return fd;
+}
+
+// ====================== Server ======================
+
+Server::Server(const std::string& path, int jobs)
+    : path(path), listen_fd(-1), epoll_fd(-1), wake_fd(-1), stopping(false), next_id(1) {
+    sockaddr_un addr = socket_address(path);
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        ::unlink(path.c_str()); // Left behind by a server that did not shut down
+    }
+
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    bool ok = listen_fd >= 0 && epoll_fd >= 0 && wake_fd >= 0;
+    std::string what = "cannot create server";
+    if (ok && (::bind(listen_fd, (sockaddr*)&addr, sizeof addr) != 0 || ::listen(listen_fd, SOMAXCONN) != 0)) {
+        ok = false;
+        what = "cannot listen on " + path;
+    }
+    if (!ok) {
+        // The destructor does not run when the constructor throws
+        std::runtime_error e = socket_error(what);
+        for (int fd : {listen_fd, epoll_fd, wake_fd}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        throw e;
+    }
+
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.fd = wake_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+    // The event loop only waits, so every thread of the pool but the
+    // caller's, which never runs a loop, is a worker
+    pool.reset(new ThreadPool(std::max(jobs, 1) + 1));
+}
+
+Server::~Server() {
+    pool.reset(); // Waits for requests being evaluated, which post to wake_fd
+    for (auto& c : connections) {
+        ::close(c.first);
+    }
+    connections.clear();
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        ::unlink(path.c_str());
+        listen_fd = -1;
+    }
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+        epoll_fd = -1;
+    }
+    if (wake_fd >= 0) {
+        ::close(wake_fd);
+        wake_fd = -1;
+    }
+}
+
+void Server::stop() {
+    stopping = true; // Lock-free, so async-signal-safe
+    uint64_t one = 1;
+    ssize_t n = ::write(wake_fd, &one, sizeof one); // Async-signal-safe
+    (void)n;
+}
+
+const LatencyStats& Server::latencies() const {
+    return stats;
+}
+
+void Server::run() {
+    std::vector<epoll_event> events(256);
+    while (true) {
+        int n = ::epoll_wait(epoll_fd, events.data(), (int)events.size(), -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw socket_error("epoll_wait failed");
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            uint32_t what = events[i].events;
+            if (fd == wake_fd) {
+                uint64_t count;
+                ssize_t r = ::read(wake_fd, &count, sizeof count); // Reset it
+                (void)r;
+                if (stopping) {
+                    return;
+                }
+                deliver();
+                continue;
+            }
+            if (fd == listen_fd) {
+                accept_all();
+                continue;
+            }
+            if (what & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                read_from(fd, (what & (EPOLLHUP | EPOLLERR)) != 0);
+            }
+            if ((what & EPOLLOUT) && connections.count(fd)) {
+                write_to(fd);
+            }
+        }
+    }
+}
+
+void Server::accept_all() {
+    while (true) {
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return; // EAGAIN once every pending connection is taken; other errors affect only that client
+        }
+        Connection& c = connections[fd];
+        c.id = next_id++;
+        c.next_request = 0;
+        c.next_reply = 0;
+        c.events = EPOLLIN;
+        c.half_closed = false;
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void Server::read_from(int fd, bool hung_up) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) {
+        return;
+    }
+    Connection& c = it->second;
+
+    char buf[65536];
+    while (!c.half_closed) {
+        ssize_t r = ::recv(fd, buf, sizeof buf, 0);
+        if (r > 0) {
+            c.in.append(buf, r);
+            continue;
+        }
+        if (r == 0) {
+            c.half_closed = true; // The client may still be reading replies
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        close_connection(fd); // Failed
+        return;
+    }
+    if (hung_up) {
+        close_connection(fd); // Closed both ways, so no reply can be delivered
+        return;
+    }
+
+    // Take every complete request
+    double start = now_us();
+    size_t pos = 0;
+    while (c.in.size() - pos >= 4) {
+        uint32_t len = get_length(c.in.data() + pos);
+        if (len > max_request) {
+            close_connection(fd);
+            return;
+        }
+        if (c.in.size() - pos - 4 < len) {
+            break;
+        }
+        submit(Request{fd, c.id, c.next_request++, c.in.substr(pos + 4, len), std::string(), start});
+        pos += 4 + len;
+    }
+    c.in.erase(0, pos);
+    settle(fd, c);
+}
+
+void Server::write_to(int fd) {
+    Connection& c = connections[fd];
+    size_t sent = 0;
+    while (sent < c.out.size()) {
+        ssize_t n = ::send(fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            close_connection(fd);
+            return;
+        }
+        sent += n;
+    }
+    c.out.erase(0, sent);
+    settle(fd, c);
+}
+
+// Watches for input unless the client is done sending or too much is
+// pending, and for output while any is waiting
+void Server::watch(int fd, Connection& c) {
+    bool read = !c.half_closed && c.out.size() < max_pending_output &&
+                c.next_request - c.next_reply < max_pending_requests;
+    uint32_t events = (read ? (uint32_t)EPOLLIN : 0u) | (c.out.empty() ? 0u : (uint32_t)EPOLLOUT);
+    if (events != c.events) {
+        epoll_event ev;
+        ev.events = events;
+        ev.data.fd = fd;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+        c.events = events;
+    }
+}
+
+// Closes a half-closed connection once every reply is written, or else
+// updates what epoll watches it for
+void Server::settle(int fd, Connection& c) {
+    if (c.half_closed && c.next_reply == c.next_request && c.out.empty()) {
+        close_connection(fd);
+        return;
+    }
+    watch(fd, c);
+}
+
+void Server::close_connection(int fd) {
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+}
+
+// Evaluates a request on the pool; the worker posts it back with its reply
+void Server::submit(Request r) {
+    pool->submit([this, r = std::move(r)]() mutable {
+        batch_eval(r.src, r.reply);
+        r.reply.pop_back(); // batch_eval's newline
+        r.src.clear();
+        {
+            std::lock_guard<std::mutex> guard(finished_lock);
+            finished.push_back(std::move(r));
+        }
+        uint64_t one = 1;
+        ssize_t n = ::write(wake_fd, &one, sizeof one);
+        (void)n;
+    });
+}
+
+// Queues the replies posted by the workers, each connection's in request order
+void Server::deliver() {
+    std::vector<Request> batch;
+    {
+        std::lock_guard<std::mutex> guard(finished_lock);
+        batch.swap(finished);
+    }
+
+    double end = now_us();
+    std::vector<int> touched;
+    for (Request& r : batch) {
+        auto it = connections.find(r.fd);
+        if (it == connections.end() || it->second.id != r.id) {
+            continue; // The client has gone
+        }
+        Connection& c = it->second;
+        uint64_t seq = r.seq;
+        c.ready.emplace(seq, std::move(r));
+        while (!c.ready.empty() && c.ready.begin()->first == c.next_reply) {
+            Request& next = c.ready.begin()->second;
+            put_length(c.out, (uint32_t)next.reply.size());
+            c.out += next.reply;
+            stats.add(end - next.start);
+            c.ready.erase(c.ready.begin());
+            c.next_reply++;
+        }
+        touched.push_back(r.fd);
+    }
+
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (int fd : touched) {
+        write_to(fd);
+    }
+}
+
+// ====================== --serve ======================
+
+static Server* running = nullptr;
+
+static void on_signal(int sig) {
+    (void)sig;
+    if (running) {
+        running->stop();
+    }
+}
+
+int run_serve(const std::string& path, int jobs) {
+    Server server(path, jobs);
+    running = &server;
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::cerr << "msdscript: serving on " << path << "\n";
+
+    server.run();
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    running = nullptr;
+    std::cerr << "msdscript: " << server.latencies().report() << "\n";
+    return 0;
+}
@@ -0,0 +1,210 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SERVE_H
+#define SERVE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "thread_pool.h"
+
+/**
+ * @class LatencyStats
+ * @brief Collects request latencies and reports their percentiles.
+ */
+class LatencyStats {
+public:
+    /**
+     * @brief Records one latency, in microseconds.
+     */
+    void add(double us);
+
+    /**
+     * @brief Adds every latency recorded by another collector.
+     */
+    void merge(const LatencyStats& other);
+
+    /**
+     * @brief Number of latencies recorded.
+     */
+    size_t count() const;
+
+    /**
+     * @brief The latency that p percent of the recorded ones do not exceed.
+     * @param p A percentage from 0 to 100.
+     * @return The latency in microseconds, or 0 if none were recorded.
+     */
+    double percentile(double p) const;
+
+    /**
+     * @brief One line with the count and the p50, p90, p99, p99.9 and max latencies.
+     */
+    std::string report() const;
+
+private:
+    mutable std::vector<double> samples;
+    mutable bool sorted = true;
+
+    void sort() const;
+};
+
+/**
+ * @brief Sends one length-prefixed frame on a blocking socket.
+ *
+ * A frame is the payload's length as a 4-byte big-endian integer, followed
+ * by the payload. Requests carry one expression's source text; replies carry
+ * its value or "Error: " and a message, as one line of --batch output
+ * without the newline.
+ *
+ * @throws std::runtime_error if the socket fails.
+ */
+void send_frame(int fd, std::string_view payload);
+
+/**
+ * @brief Receives one length-prefixed frame from a blocking socket.
+ * @param payload Set to the frame's payload.
+ * @return false if the peer closed the connection before a frame started.
+ * @throws std::runtime_error if the socket fails or closes mid-frame.
+ */
+bool recv_frame(int fd, std::string& payload);
+
+/**
+ * @brief Connects to a server's Unix domain socket.
+ * @return The connected socket.
+ * @throws std::runtime_error if the connection fails.
+ */
+int connect_socket(const std::string& path);
+
+/**
+ * @class Server
+ * @brief Evaluates expressions sent over a Unix domain socket (--serve).
+ *
+ * One thread watches the listening socket and every connection with epoll.
+ * It hands each complete request to a ThreadPool without waiting for it;
+ * the worker that evaluates it posts the reply back and wakes the event
+ * loop through an eventfd. So a slow request holds up only the replies
+ * after it on its own connection, never other clients.
+ *
+ * Replies on one connection come in request order, so a client may send
+ * several requests before reading. It may also shut down its sending side
+ * once it has sent them all: the connection stays open until every reply
+ * has been written. A request nested too deeply for the evaluating
+ * thread's stack gets an "Error: " reply like any other failure (see
+ * StackGuard).
+ *
+ * Every distinct variable name a request uses stays interned until the
+ * process exits (see Symbol). Once the table reaches Symbol::limit, a
+ * request with a name not seen before gets "Error: too many distinct
+ * names", while requests using known names are still served.
+ *
+ * The latency of a request is measured from when it has been read
+ * completely until its reply is queued.
+ */
+class Server {
+public:
+    /**
+     * @brief Creates the socket and starts listening.
+     * @param path File system path of the socket; an existing socket file there is replaced.
+     * @param jobs Threads to evaluate with; the event loop has a thread of its own.
+     * @throws std::runtime_error if the socket cannot be created.
+     */
+    Server(const std::string& path, int jobs);
+
+    /**
+     * @brief Closes every connection and removes the socket file.
+     */
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * @brief Serves clients until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return soon.
+     *
+     * Safe to call from any thread and from a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Latencies of the requests served so far; read it after run() returns.
+     */
+    const LatencyStats& latencies() const;
+
+    /**
+     * @brief Largest request accepted; a client sending a larger one is disconnected.
+     */
+    static const uint32_t max_request = 16 << 20;
+
+private:
+    struct Request {
+        int fd;
+        uint64_t id;       // The connection's
+        uint64_t seq;      // Requests read from the connection before this one
+        std::string src;
+        std::string reply;
+        double start;      // Microseconds on the steady clock
+    };
+
+    struct Connection {
+        uint64_t id;       // Distinguishes connections that reuse a file descriptor
+        std::string in;    // Bytes read but not yet part of a complete request
+        std::string out;   // Reply bytes not yet written
+        uint64_t next_request;  // seq of the next request read
+        uint64_t next_reply;    // seq of the next reply to queue on out
+        std::map<uint64_t, Request> ready; // Evaluated ahead of an earlier request, by seq
+        uint32_t events;   // What epoll watches it for (no input while much is pending)
+        bool half_closed;  // The client has sent everything it will send
+    };
+
+    std::string path;
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;           // eventfd written by stop() and by workers with a reply
+    std::atomic<bool> stopping;
+    std::map<int, Connection> connections;
+    uint64_t next_id;
+    LatencyStats stats;
+
+    std::mutex finished_lock;
+    std::vector<Request> finished; // Evaluated, not yet taken by the event loop
+    std::unique_ptr<ThreadPool> pool; // Destroyed first, so no task outlives the rest
+
+    void accept_all();
+    void read_from(int fd, bool hung_up);
+    void write_to(int fd);
+    void watch(int fd, Connection& c);
+    void settle(int fd, Connection& c);
+    void close_connection(int fd);
+    void submit(Request r);
+    void deliver();
+};
+
+/**
+ * @brief Runs a server until SIGINT or SIGTERM, then reports its latencies (--serve).
+ *
+ * @param path The socket's path.
+ * @param jobs Threads to evaluate with (--jobs).
+ * @return 0 once stopped.
+ */
+int run_serve(const std::string& path, int jobs);
+
+#endif // SERVE_H
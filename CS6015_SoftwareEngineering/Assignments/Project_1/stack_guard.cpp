@@ -0,0 +1,44 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "stack_guard.h"
+#include <stdexcept>
+#include <pthread.h>
+
+// The lowest address of the calling thread's stack, or 0 if it is not known
+static uintptr_t stack_bottom() {
+#if defined(__APPLE__)
+    pthread_t self = pthread_self();
+    return (uintptr_t)pthread_get_stackaddr_np(self) - pthread_get_stacksize_np(self);
+#elif defined(__linux__)
+    // For the main thread, glibc derives the size from the stack rlimit
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return 0;
+    }
+    void* addr = nullptr;
+    size_t size = 0;
+    pthread_attr_getstack(&attr, &addr, &size);
+    pthread_attr_destroy(&attr);
+    return (uintptr_t)addr;
+#else
+    return 0;
+#endif
+}
+
+void StackGuard::slow_check(uintptr_t here, size_t reserve, const char* what) {
+    if (bottom == 0) {
+        uintptr_t found = stack_bottom();
+        bottom = found != 0 && found < here ? found : 1;
+    }
+    if (here < bottom + reserve) {
+        throw std::runtime_error(what);
+    }
+}
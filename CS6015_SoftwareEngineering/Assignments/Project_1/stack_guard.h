@@ -0,0 +1,60 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef STACK_GUARD_H
+#define STACK_GUARD_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class StackGuard
+ * @brief Checks how much native stack the current thread has left.
+ *
+ * The tree-walking interpreter recurses on the native stack for every
+ * nested subexpression and every non-tail call. A fixed depth limit cannot
+ * be right everywhere: the main thread's stack follows `ulimit -s`, and
+ * other threads get the platform's default (8 MB on Linux, 512 KB on
+ * macOS). So the interpreter checks against the actual bounds of the
+ * thread's stack, found once per thread, and throws while some of it is
+ * still free for unwinding and error reporting. Where the bounds cannot be
+ * found, nothing is checked.
+ */
+class StackGuard {
+public:
+    static const size_t call_reserve = 128 * 1024; ///< Stack left free when a call is refused (see CallDepth).
+    static const size_t expr_reserve = 64 * 1024;  ///< Stack left free when a subexpression is refused.
+
+    /**
+     * @brief Throws if less than `reserve` bytes of this thread's stack are left.
+     *
+     * Calls keep the larger reserve, so recursion through calls is always
+     * reported as such, and only a deeply nested expression reaches the
+     * smaller one.
+     *
+     * @param reserve call_reserve or expr_reserve.
+     * @param what The message of the std::runtime_error thrown.
+     */
+    static void check(size_t reserve, const char* what) {
+        char here;
+        if ((uintptr_t)&here < bottom + reserve || bottom == 0) {
+            slow_check((uintptr_t)&here, reserve, what);
+        }
+    }
+
+private:
+    // Lowest address of this thread's stack (it grows down), 0 until it is
+    // found, and 1 if it cannot be
+    static inline thread_local uintptr_t bottom = 0;
+
+    static void slow_check(uintptr_t here, size_t reserve, const char* what);
+};
+
+#endif // STACK_GUARD_H
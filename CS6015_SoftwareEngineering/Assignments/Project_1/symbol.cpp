@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "symbol.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// Names live in blocks of doubling size: block b holds ids 2^b - 1 up to
+// 2^(b+1) - 2. A block is allocated once and never moved, so str() can read
+// it without the lock, and the map can key on views of the stored names.
+constexpr int blocks = 32;
+
+// Bytes counted for a name besides its characters: its string and map entry
+constexpr size_t overhead = sizeof(std::string) + 32;
+
+struct Table {
+    std::shared_mutex lock; // Shared to look a name up, exclusive to add one
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::atomic<std::string*> block[blocks] = {};
+    uint32_t size = 0;
+    size_t bytes = 0;
+
+    Table() {
+        add(""); // Id 0, the default Symbol
+    }
+
+    // Stores a new name; the caller holds the lock exclusively
+    uint32_t add(std::string_view name) {
+        if (size == UINT32_MAX || (size > 0 && bytes + name.size() + overhead > Symbol::limit)) {
+            throw std::runtime_error("too many distinct names");
+        }
+        uint32_t id = size;
+        int b = block_of(id);
+        std::string* names = block[b].load(std::memory_order_relaxed);
+        if (!names) {
+            names = new std::string[(size_t)1 << b];
+            block[b].store(names, std::memory_order_release);
+        }
+        std::string& stored = names[id + 1 - ((size_t)1 << b)];
+        stored = name;
+        ids.emplace(std::string_view(stored), id);
+        size++;
+        bytes += name.size() + overhead;
+        return id;
+    }
+
+    static int block_of(uint32_t id) {
+        return 63 - __builtin_clzll((uint64_t)id + 1);
+    }
+};
+
+Table& table() {
+    static Table* t = new Table(); // Never destroyed, so Symbols outlive static destructors
+    return *t;
+}
+
+} // namespace
+
+size_t Symbol::limit = 64 << 20;
+
+uint32_t Symbol::intern(std::string_view name) {
+    Table& t = table();
+    {
+        // Most names are already interned, and threads parsing at once
+        // (--batch --jobs, the --serve pool) look them up side by side
+        std::shared_lock<std::shared_mutex> reading(t.lock);
+        auto found = t.ids.find(name);
+        if (found != t.ids.end()) {
+            return found->second;
+        }
+    }
+    std::lock_guard<std::shared_mutex> writing(t.lock);
+    auto found = t.ids.find(name); // Another thread may have added it meanwhile
+    return found != t.ids.end() ? found->second : t.add(name);
+}
+
+const std::string& Symbol::str() const {
+    Table& t = table();
+    int b = Table::block_of(index);
+    return t.block[b].load(std::memory_order_acquire)[index + 1 - ((size_t)1 << b)];
+}
+
+size_t Symbol::count() {
+    Table& t = table();
+    std::shared_lock<std::shared_mutex> guard(t.lock);
+    return t.size;
+}
+
+size_t Symbol::bytes() {
+    Table& t = table();
+    std::shared_lock<std::shared_mutex> guard(t.lock);
+    return t.bytes;
+}
@@ -0,0 +1,101 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/**
+ * @class Symbol
+ * @brief An interned identifier: a 32-bit id standing for a variable name.
+ *
+ * Every distinct name gets one id from a global table the first time it is
+ * seen (normally by the parser), so comparing or hashing two Symbols is an
+ * integer operation and a node holds 4 bytes instead of a std::string.
+ * Symbols convert implicitly from strings, so `NEW(VarExpr)("x")` still
+ * works; str() gives the name back for printing.
+ *
+ * Interning is safe from any thread. Looking up a name already interned
+ * takes the table's lock shared, so threads parsing at once do not wait
+ * on each other; only adding a new name takes it exclusively. str() takes
+ * no lock: names are stored in blocks that are never moved or freed, so
+ * the reference it returns stays valid for the life of the program.
+ *
+ * That also means the table only grows: a long-lived process (--serve,
+ * --worker, a long --batch) keeps every distinct name any input has used.
+ * So the table is capped at `limit` bytes, and interning a new name past
+ * it throws; names already interned keep working.
+ */
+class Symbol {
+public:
+    /**
+     * @brief The symbol for the empty name.
+     */
+    Symbol() : index(0) {}
+
+    /**
+     * @brief Interns a name.
+     * @param name The name; it is copied into the table the first time.
+     * @throws std::runtime_error("too many distinct names") if a new name
+     *         would take the table past `limit` bytes.
+     */
+    Symbol(std::string_view name) : index(intern(name)) {}
+    Symbol(const std::string& name) : index(intern(name)) {}
+    Symbol(const char* name) : index(intern(name)) {}
+
+    /**
+     * @brief The name this symbol stands for.
+     */
+    const std::string& str() const;
+
+    /**
+     * @brief The symbol's id; ids are handed out from 0 in interning order.
+     */
+    uint32_t id() const { return index; }
+
+    bool operator==(Symbol other) const { return index == other.index; }
+    bool operator!=(Symbol other) const { return index != other.index; }
+
+    /**
+     * @brief Number of distinct names interned so far.
+     */
+    static size_t count();
+
+    /**
+     * @brief Approximate bytes the table holds: every name plus its bookkeeping.
+     */
+    static size_t bytes();
+
+    /**
+     * @brief Most bytes() the table may grow to; 64 MB, about a million short names.
+     *
+     * Set it before any thread starts interning.
+     */
+    static size_t limit;
+
+private:
+    uint32_t index;
+
+    static uint32_t intern(std::string_view name);
+};
+
+namespace std {
+template <>
+struct hash<Symbol> {
+    size_t operator()(Symbol s) const noexcept { return s.id(); }
+};
+} // namespace std
+
+#endif // SYMBOL_H
@@ -9,49 +9,59 @@
 //////////////////////////////////////////////////////////////////////////////////
 
 #include "exec.h"
+#include "exec_pool.h"
+#include "thread_pool.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <ctime>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 #include <string>
 
-// Function to generate a random expression
-std::string generate_random_expression(int depth = 0) {
+// Function to generate a random expression from the given generator
+std::string generate_random_expression(std::mt19937& rng, int depth = 0) {
     if (depth > 3) {
         // Base case: return a number or variable
-        if (rand() % 2 == 0) {
-            return std::to_string(rand() % 100); // Random number
+        if (rng() % 2 == 0) {
+            return std::to_string(rng() % 100); // Random number
         } else {
             return "x"; // Variable
         }
     }
 
     // Recursive case: generate a more complex expression
-    switch (rand() % 4) {
+    switch (rng() % 4) {
         case 0:
-            return generate_random_expression(depth + 1) + " + " + generate_random_expression(depth + 1);
+            return generate_random_expression(rng, depth + 1) + " + " + generate_random_expression(rng, depth + 1);
         case 1:
-            return generate_random_expression(depth + 1) + " * " + generate_random_expression(depth + 1);
+            return generate_random_expression(rng, depth + 1) + " * " + generate_random_expression(rng, depth + 1);
         case 2:
-            return "(" + generate_random_expression(depth + 1) + ")";
+            return "(" + generate_random_expression(rng, depth + 1) + ")";
         case 3:
-            return "_let x = " + generate_random_expression(depth + 1) + " _in " + generate_random_expression(depth + 1);
+            return "_let x = " + generate_random_expression(rng, depth + 1) + " _in " + generate_random_expression(rng, depth + 1);
         default:
-            return generate_random_expression(depth + 1);
+            return generate_random_expression(rng, depth + 1);
     }
 }
 
 // Function to test a single msdscript executable
 void test_single(const std::string& msdscript_path) {
-    srand(time(nullptr)); // Seed the random number generator
+    std::mt19937 rng(time(nullptr)); // Seed the random number generator
+    ExecPool pool(msdscript_path, 1); // Reuses one msdscript --worker (exec_program if it has none)
 
     for (int i = 0; i < 100; ++i) {
-        std::string expr = generate_random_expression();
+        std::string expr = generate_random_expression(rng);
         std::cout << "Testing expression: " << expr << "\n";
 
         // Test --interp
         const char* command[] = {msdscript_path.c_str(), "--interp", nullptr};
-        ExecResult interp_result = exec_program(2, command, expr);
+        ExecResult interp_result = pool.run(2, command, expr);
         if (interp_result.exit_code != 0) {
             std::cerr << "Error in --interp mode:\n" << interp_result.err << "\n";
             exit(1);
@@ -59,7 +69,7 @@ void test_single(const std::string& msdscript_path) {
 
         // Test --print
         const char* print_command[] = {msdscript_path.c_str(), "--print", nullptr};
-        ExecResult print_result = exec_program(2, print_command, expr);
+        ExecResult print_result = pool.run(2, print_command, expr);
         if (print_result.exit_code != 0) {
             std::cerr << "Error in --print mode:\n" << print_result.err << "\n";
             exit(1);
@@ -67,7 +77,7 @@ void test_single(const std::string& msdscript_path) {
 
         // Test --pretty-print
         const char* pretty_print_command[] = {msdscript_path.c_str(), "--pretty-print", nullptr};
-        ExecResult pretty_print_result = exec_program(2, pretty_print_command, expr);
+        ExecResult pretty_print_result = pool.run(2, pretty_print_command, expr);
         if (pretty_print_result.exit_code != 0) {
             std::cerr << "Error in --pretty-print mode:\n" << pretty_print_result.err << "\n";
             exit(1);
@@ -79,17 +89,19 @@ void test_single(const std::string& msdscript_path) {
 
 // Function to compare two msdscript executables
 void test_compare(const std::string& msdscript1_path, const std::string& msdscript2_path) {
-    srand(time(nullptr)); // Seed the random number generator
+    std::mt19937 rng(time(nullptr)); // Seed the random number generator
+    ExecPool pool1(msdscript1_path, 1); // Reuse a worker of each executable that has one
+    ExecPool pool2(msdscript2_path, 1);
 
     for (int i = 0; i < 100; ++i) {
-        std::string expr = generate_random_expression();
+        std::string expr = generate_random_expression(rng);
         std::cout << "Comparing expression: " << expr << "\n";
 
         // Test --interp
         const char* command1[] = {msdscript1_path.c_str(), "--interp", nullptr};
         const char* command2[] = {msdscript2_path.c_str(), "--interp", nullptr};
-        ExecResult result1 = exec_program(2, command1, expr);
-        ExecResult result2 = exec_program(2, command2, expr);
+        ExecResult result1 = pool1.run(2, command1, expr);
+        ExecResult result2 = pool2.run(2, command2, expr);
 
         if (result1.out != result2.out) {
             std::cerr << "Discrepancy in --interp mode:\n"
@@ -101,8 +113,8 @@ void test_compare(const std::string& msdscript1_path, const std::string& msdscri
         // Test --print
         const char* print_command1[] = {msdscript1_path.c_str(), "--print", nullptr};
         const char* print_command2[] = {msdscript2_path.c_str(), "--print", nullptr};
-        result1 = exec_program(2, print_command1, expr);
-        result2 = exec_program(2, print_command2, expr);
+        result1 = pool1.run(2, print_command1, expr);
+        result2 = pool2.run(2, print_command2, expr);
 
         if (result1.out != result2.out) {
             std::cerr << "Discrepancy in --print mode:\n"
@@ -114,8 +126,8 @@ void test_compare(const std::string& msdscript1_path, const std::string& msdscri
         // Test --pretty-print
         const char* pretty_print_command1[] = {msdscript1_path.c_str(), "--pretty-print", nullptr};
         const char* pretty_print_command2[] = {msdscript2_path.c_str(), "--pretty-print", nullptr};
-        result1 = exec_program(2, pretty_print_command1, expr);
-        result2 = exec_program(2, pretty_print_command2, expr);
+        result1 = pool1.run(2, pretty_print_command1, expr);
+        result2 = pool2.run(2, pretty_print_command2, expr);
 
         if (result1.out != result2.out) {
             std::cerr << "Discrepancy in --pretty-print mode:\n"
@@ -128,17 +140,162 @@ void test_compare(const std::string& msdscript1_path, const std::string& msdscri
     }
 }
 
+// ====================== Parallel Mode ======================
+
+// The modes every expression is run in
+static const char* const modes[] = {"--interp", "--print", "--pretty-print"};
+static const int mode_count = 3;
+
+// One failure found by test_parallel
+struct Discrepancy {
+    size_t index;      // Which expression, counting from 0 for the seed
+    int mode;          // Index into modes
+    std::string expr;
+    ExecResult result1;
+    ExecResult result2; // Unused when testing a single executable
+};
+
+// The generator for expression `index`: seeded from the run's seed and the
+// index alone, so any thread produces the same expression for it
+static std::mt19937& expression_rng(uint64_t seed, size_t index) {
+    thread_local std::mt19937 rng; // One per thread, reseeded for every expression
+    std::seed_seq seq{(uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)index, (uint32_t)((uint64_t)index >> 32)};
+    rng.seed(seq);
+    return rng;
+}
+
+static ExecResult run_mode(ExecPool& pool, int mode, const std::string& expr) {
+    const char* command[] = {pool.program().c_str(), modes[mode], nullptr};
+    try {
+        return pool.run(2, command, expr);
+    } catch (std::runtime_error& e) {
+        ExecResult r; // Reported as a failure rather than ending the run
+        r.exit_code = -1;
+        r.err = e.what();
+        return r;
+    }
+}
+
+static void report(const Discrepancy& d, const std::string& path1, const std::string& path2) {
+    std::cerr << (path2.empty() ? "Error" : "Discrepancy") << " in " << modes[d.mode] << " mode for expression "
+              << d.index << ":\n" << d.expr << "\n";
+    if (path2.empty()) {
+        std::cerr << "exit code " << d.result1.exit_code << ": " << d.result1.err << "\n";
+    } else {
+        std::cerr << path1 << " output: " << d.result1.out << "\n"
+                  << path2 << " output: " << d.result2.out << "\n";
+    }
+}
+
+// Tests one executable (path2 empty) or compares two on `count` expressions,
+// spread over `jobs` threads that each keep a worker of every executable
+// busy. Every failure is collected, and reported in expression order.
+// Returns the number of failures.
+int test_parallel(const std::string& path1, const std::string& path2, uint64_t seed, size_t count, int jobs) {
+    ExecPool pool1(path1, jobs);
+    std::unique_ptr<ExecPool> pool2(path2.empty() ? nullptr : new ExecPool(path2, jobs));
+    std::vector<std::vector<Discrepancy>> found(count); // Per expression, so threads never share a vector
+    auto start = std::chrono::steady_clock::now();
+
+    ThreadPool threads(jobs);
+    threads.parallel_for(count, [&](size_t index) {
+        std::string expr = generate_random_expression(expression_rng(seed, index));
+        for (int mode = 0; mode < mode_count; mode++) {
+            Discrepancy d{index, mode, expr, run_mode(pool1, mode, expr), ExecResult()};
+            if (pool2) {
+                d.result2 = run_mode(*pool2, mode, expr);
+                if (d.result1.out != d.result2.out) {
+                    found[index].push_back(d);
+                }
+            } else if (d.result1.exit_code != 0) {
+                found[index].push_back(d);
+            }
+        }
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    int per_mode[mode_count] = {};
+    std::vector<size_t> failed; // Expressions with at least one failure
+    for (const std::vector<Discrepancy>& list : found) {
+        for (const Discrepancy& d : list) {
+            report(d, path1, path2);
+            per_mode[d.mode]++;
+        }
+        if (!list.empty()) {
+            failed.push_back(list[0].index);
+        }
+    }
+
+    std::cout << "Summary: " << count << " expressions, seed " << seed << ", " << jobs << " threads, "
+              << (pool1.pooled() ? "pooled" : "exec_program");
+    if (pool2) {
+        std::cout << "/" << (pool2->pooled() ? "pooled" : "exec_program");
+    }
+    std::cout << ", " << seconds << " s (" << (seconds > 0 ? count / seconds : 0) << " expressions/s)\n";
+    int total = 0;
+    for (int mode = 0; mode < mode_count; mode++) {
+        std::cout << "  " << modes[mode] << ": " << per_mode[mode] << (pool2 ? " discrepancies\n" : " errors\n");
+        total += per_mode[mode];
+    }
+    std::cout << "  expressions with " << (pool2 ? "discrepancies" : "errors") << ": " << failed.size() << "\n";
+    if (!failed.empty()) {
+        std::cout << "  first: " << failed.front() << ", last: " << failed.back()
+                  << "; rerun with --seed " << seed << " --count " << failed.back() + 1 << " to reproduce\n";
+    }
+    return total;
+}
+
+static int usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--jobs N] [--seed S] [--count N] <msdscript_path> [<msdscript2_path>]\n"
+              << "  With any option, expressions run in parallel and every failure is reported\n"
+              << "  (--jobs 0, the default, uses every core; --count defaults to 1000).\n";
+    return 1;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc == 2) {
+    bool parallel = false;
+    int jobs = 0;
+    uint64_t seed = std::random_device()();
+    size_t count = 1000;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--jobs" || arg == "--seed" || arg == "--count") && i + 1 < argc) {
+            parallel = true;
+            char* end;
+            unsigned long long value = strtoull(argv[++i], &end, 10);
+            if (*end != '\0' || argv[i][0] == '-') {
+                return usage(argv[0]);
+            }
+            if (arg == "--jobs") {
+                jobs = (int)value;
+            } else if (arg == "--seed") {
+                seed = value;
+            } else {
+                count = value;
+            }
+        } else if (arg.compare(0, 2, "--") == 0) {
+            return usage(argv[0]);
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty() || paths.size() > 2) {
+        return usage(argv[0]);
+    }
+
+    if (parallel) {
+        if (jobs < 1) {
+            jobs = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return test_parallel(paths[0], paths.size() == 2 ? paths[1] : "", seed, count, jobs) == 0 ? 0 : 1;
+    } else if (paths.size() == 1) {
         // Single argument mode: test the given msdscript executable
-        test_single(argv[1]);
-    } else if (argc == 3) {
-        // Two argument mode: compare two msdscript executables
-        test_compare(argv[1], argv[2]);
+        test_single(paths[0]);
     } else {
-        std::cerr << "Usage: " << argv[0] << " <msdscript_path> [<msdscript2_path>]\n";
-        return 1;
+        // Two argument mode: compare two msdscript executables
+        test_compare(paths[0], paths[1]);
     }
 
     return 0;
-}
\ No newline at end of file
+}
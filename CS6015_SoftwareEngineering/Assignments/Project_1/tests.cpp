@@ -13,8 +13,36 @@
 #include "val.h"
 #include "parse.hpp"
 #include "pointer.h"
+#include "vm.h"
+#include "batch.h"
+#include "thread_pool.h"
+#include "optimize.h"
+#include "hashcons.h"
+#include "writer.h"
+#include "memo.h"
+#include "bignum.h"
+#include "program.h"
+#include "serve.h"
+#include "encode.h"
+#include "profile.h"
+#include "symbol.h"
+#include "exec_pool.h"
+#include "arena.h"
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
 #include <stdexcept>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 // ====================== NumExpr Tests ======================
 TEST_CASE("NumExpr tests") {
@@ -255,6 +283,21 @@ TEST_CASE("EqExpr tests") {
     CHECK(eq1->to_pretty_string() == "5 == 5");
     CHECK(eq2->to_pretty_string() == "5 == 6");
     CHECK(eq3->to_pretty_string() == "_true == _true");
+
+    // + and == group to the right, so a sum on the left keeps its parentheses
+    PTR(Expr) sum_eq = NEW(EqExpr)(NEW(AddExpr)(NEW(NumExpr)(1), NEW(NumExpr)(2)), NEW(NumExpr)(3));
+    CHECK(sum_eq->to_pretty_string() == "(1 + 2) == 3");
+    CHECK(parse_str(sum_eq->to_pretty_string())->interp(Env::empty)->to_string() == "_true");
+    CHECK(NEW(EqExpr)(NEW(NumExpr)(3), NEW(AddExpr)(NEW(NumExpr)(1), NEW(NumExpr)(2)))->to_pretty_string() == "3 == 1 + 2");
+
+    // The input the fuzzer found, as --pretty-print shows it; it used to lose
+    // the parentheses and print 1 + 2 == 3, which parses as 1 + (2 == 3)
+    PTR(Expr) found = parse_str("(1 + 2) == 3");
+    CHECK(found->to_pretty_string() == "(1 + 2) == 3");
+    CHECK(parse_str(found->to_pretty_string())->equals(found));
+    PTR(Expr) chained = parse_str("(x + 1) == (y == 2)");
+    CHECK(chained->to_pretty_string() == "(x + 1) == y == 2");
+    CHECK(parse_str(chained->to_pretty_string())->equals(chained));
 }
 
 // ====================== Parser Tests ======================
@@ -266,6 +309,14 @@ TEST_CASE("parse") {
 
     CHECK_THROWS_WITH( parse_str("(1"), "bad input" );
 
+    // Nothing but whitespace may follow the whole expression
+    CHECK_THROWS_WITH( parse_str("1 = 2"), "bad input" );
+    CHECK_THROWS_WITH( parse_str("(1) 2"), "bad input" );
+    CHECK_THROWS_WITH( parse_str("_let x = 1 _in x _in 2"), "bad input" );
+    std::istringstream trailing("1 + 2 )");
+    CHECK_THROWS_WITH( parse(trailing), "bad input" );
+    CHECK( parse_str("(1)  \n")->equals(NEW(NumExpr)(1)) );
+
     CHECK( parse_str("1")->equals(NEW(NumExpr)(1)) );
     CHECK( parse_str("10")->equals(NEW(NumExpr)(10)) );
     CHECK( parse_str("-3")->equals(NEW(NumExpr)(-3)) );
@@ -304,6 +355,44 @@ TEST_CASE("parse") {
           ->equals(NEW(IfExpr)(NEW(BoolExpr)(true), NEW(NumExpr)(1), NEW(NumExpr)(2))) );
 }
 
+// ====================== Lexer Tests ======================
+TEST_CASE("Lexer") {
+    std::string src = "_let f = _fun (x) x * -12 _in\n f(3) == 2 + _if _true _then a _else _false";
+    token_t expected[] = {
+        tok_let, tok_var, tok_equal, tok_fun, tok_lparen, tok_var, tok_rparen, tok_var,
+        tok_star, tok_num, tok_in, tok_var, tok_lparen, tok_num, tok_rparen, tok_eqeq,
+        tok_num, tok_plus, tok_if, tok_true, tok_then, tok_var, tok_else, tok_false, tok_eof
+    };
+    Lexer lex(src);
+    for (token_t kind : expected) {
+        CHECK(lex.peek().kind == kind);
+        lex.next();
+    }
+
+    Lexer nums("-12 2147483647 2147483648");
+    CHECK(nums.next().num == -12);
+    CHECK(nums.next().num == 2147483647);
+    CHECK(nums.peek().kind == tok_error);
+    CHECK(std::string(nums.peek().error) == "number too large");
+
+    Lexer var("xyz(");
+    CHECK(var.offset() == 0);
+    CHECK(var.next().text == "xyz");
+    CHECK(var.offset() == 3);
+    CHECK_THROWS_WITH(var.expect(tok_rparen), "bad input");
+
+    // A malformed token is reported as itself, even after the whole expression
+    CHECK_THROWS_WITH(parse_str("1 -"), "invalid input");
+    CHECK_THROWS_WITH(parse_str("1 + -"), "invalid input");
+    CHECK_THROWS_WITH(parse_str("1 + 99999999999"), "number too large");
+    CHECK_THROWS_WITH(parse_str("_lett x = 1 _in x"), "bad input");
+    CHECK_THROWS_WITH(parse_str("_let x = 1 _inn x"), "bad input");
+    CHECK_THROWS_WITH(parse_str("_let x = 1 x"), "bad input");
+    CHECK_THROWS_WITH(parse_str("_fun (1) 1"), "bad input");
+    CHECK_THROWS_WITH(parse_str("1 + $"), "bad input");
+    CHECK_THROWS_WITH(parse_str(""), "bad input");
+}
+
 // ====================== Additional Tests for Pretty Print ======================
 TEST_CASE("Pretty print tests for conditionals") {
     // Test pretty printing of nested if expressions
@@ -515,16 +604,1204 @@ TEST_CASE("parse functions") {
 }
 
 // ====================== Factorial Example Test ======================
-//TEST_CASE("Factorial example") {
-//    std::string factorial =
-//        "_let factrl = _fun (factrl)\n"
-//        "                _fun (x)\n"
-//        "                  _if x == 1\n"
-//        "                  _then 1\n"
-//        "                  _else x * factrl(factrl)(x + -1)\n"
-//        "_in factrl(factrl)(10)";
-//
-//    Expr* expr = parse_str(factorial);
-//    Val* result = expr->interp(Env::empty);
-//    CHECK(result->to_string() == "3628800");
-//}
\ No newline at end of file
+TEST_CASE("Factorial example") {
+    std::string factorial =
+        "_let factrl = _fun (factrl)\n"
+        "                _fun (x)\n"
+        "                  _if x == 1\n"
+        "                  _then 1\n"
+        "                  _else x * factrl(factrl)(x + -1)\n"
+        "_in factrl(factrl)(10)";
+
+    PTR(Expr) expr = parse_str(factorial);
+    PTR(Val) result = expr->interp(Env::empty);
+    CHECK(result->to_string() == "3628800");
+}
+
+// ====================== Bytecode VM Tests ======================
+
+// Runs `e` with the given evaluator and returns either the printed value
+// or the error message, so results and failures can be compared alike.
+static std::string run_or_error(PTR(Val) (*run)(PTR(Expr)), PTR(Expr) e) {
+    try {
+        return run(e)->to_string();
+    } catch (const std::exception& ex) {
+        return std::string("error: ") + ex.what();
+    }
+}
+
+static PTR(Val) tree_interp(PTR(Expr) e) {
+    return e->interp(Env::empty);
+}
+
+TEST_CASE("VM matches interp") {
+    // factrl(factrl)(10) written out with constructors
+    PTR(Expr) factrl = NEW(LetExpr)("factrl",
+        NEW(FunExpr)("factrl",
+            NEW(FunExpr)("x",
+                NEW(IfExpr)(NEW(EqExpr)(NEW(VarExpr)("x"), NEW(NumExpr)(1)),
+                            NEW(NumExpr)(1),
+                            NEW(MultExpr)(NEW(VarExpr)("x"),
+                                NEW(CallExpr)(NEW(CallExpr)(NEW(VarExpr)("factrl"), NEW(VarExpr)("factrl")),
+                                              NEW(AddExpr)(NEW(VarExpr)("x"), NEW(NumExpr)(-1))))))),
+        NEW(CallExpr)(NEW(CallExpr)(NEW(VarExpr)("factrl"), NEW(VarExpr)("factrl")), NEW(NumExpr)(10)));
+
+    std::vector<PTR(Expr)> exprs = {
+        NEW(NumExpr)(5),
+        NEW(AddExpr)(NEW(NumExpr)(2), NEW(NumExpr)(3)),
+        NEW(MultExpr)(NEW(NumExpr)(2), NEW(NumExpr)(3)),
+        NEW(VarExpr)("x"),
+        NEW(LetExpr)("x", NEW(NumExpr)(5), NEW(AddExpr)(NEW(VarExpr)("x"), NEW(NumExpr)(1))),
+        NEW(BoolExpr)(true),
+        NEW(IfExpr)(NEW(BoolExpr)(false), NEW(NumExpr)(1), NEW(NumExpr)(2)),
+        NEW(IfExpr)(NEW(NumExpr)(5), NEW(NumExpr)(1), NEW(NumExpr)(2)),
+        NEW(IfExpr)(NEW(BoolExpr)(true), NEW(NumExpr)(1), NEW(VarExpr)("unbound")),
+        NEW(EqExpr)(NEW(NumExpr)(5), NEW(NumExpr)(5)),
+        NEW(EqExpr)(NEW(NumExpr)(5), NEW(BoolExpr)(true)),
+        NEW(EqExpr)(NEW(FunExpr)("x", NEW(VarExpr)("x")), NEW(FunExpr)("x", NEW(VarExpr)("x"))),
+        NEW(AddExpr)(NEW(NumExpr)(1), NEW(BoolExpr)(true)),
+        NEW(MultExpr)(NEW(BoolExpr)(true), NEW(NumExpr)(1)),
+        NEW(AddExpr)(NEW(NumExpr)(2147483647), NEW(NumExpr)(1)),
+        NEW(MultExpr)(NEW(NumExpr)(-2147483647), NEW(NumExpr)(2)),
+        NEW(CallExpr)(NEW(NumExpr)(1), NEW(NumExpr)(2)),
+        NEW(CallExpr)(NEW(BoolExpr)(false), NEW(NumExpr)(2)),
+        NEW(FunExpr)("x", NEW(AddExpr)(NEW(VarExpr)("x"), NEW(NumExpr)(1))),
+        // Shadowing and closures over _let and argument bindings
+        NEW(LetExpr)("x", NEW(NumExpr)(1),
+            NEW(LetExpr)("x", NEW(AddExpr)(NEW(VarExpr)("x"), NEW(NumExpr)(1)), NEW(VarExpr)("x"))),
+        NEW(LetExpr)("y", NEW(NumExpr)(10),
+            NEW(LetExpr)("f", NEW(FunExpr)("x", NEW(FunExpr)("z",
+                    NEW(AddExpr)(NEW(VarExpr)("x"), NEW(AddExpr)(NEW(VarExpr)("y"), NEW(VarExpr)("z"))))),
+                NEW(CallExpr)(NEW(CallExpr)(NEW(VarExpr)("f"), NEW(NumExpr)(1)), NEW(NumExpr)(100)))),
+        factrl,
+        parse_str("_fun (x) x + 1"),
+        parse_str("(_fun (x) x * x)(7)"),
+        parse_str("f(x + 1)"),
+        parse_str("_if 1 == 2 _then 3 + 4 _else 5 * 6"),
+    };
+
+    for (PTR(Expr) e : exprs) {
+        INFO(e->to_string());
+        CHECK(run_or_error(vm_interp, e) == run_or_error(tree_interp, e));
+    }
+
+    CHECK(vm_interp(factrl)->to_string() == "3628800");
+
+    // Functions returned from the VM can still be called by the tree-walker
+    PTR(Val) adder = vm_interp(parse_str("(_fun (y) _fun (x) x + y)(2)"));
+    CHECK(adder->call(NEW(NumVal)(40))->equals(NEW(NumVal)(42)));
+}
+
+// ====================== Resolved Frame Tests ======================
+TEST_CASE("Resolved frames match name lookup") {
+    std::vector<std::string> programs = {
+        "_let x = 5 _in x + 1",
+        "_let x = 1 _in _let y = 2 _in _let x = x + y _in x * y",
+        "(_let a = 1 _in a) + (_let b = 2 _in b)",
+        "_let x = (_let y = 3 _in y * y) _in x + 1",
+        "_let f = _fun (x) _fun (y) x + y _in f(1)(2)",
+        // A closure made before a later _let in the same frame keeps its own binding
+        "_let f = (_let a = 1 _in _fun (y) a) _in _let b = 2 _in f(0)",
+        "(_fun (a) _let g = _fun (x) a + x _in _let a = 100 _in g(1))(10)",
+        // A name bound later in the same frame is still free inside the closure
+        "(_fun (a) _let f = _fun (x) y _in _let y = 1 _in f(0))(0)",
+        "_let y = 1 _in (_fun (x) x + y)(z)",
+        "_if _true _then 1 _else nope",
+        // Captured through every function in between, and shadowed after being captured
+        "_let a = 1 _in (_fun (p) _fun (q) _fun (r) a + p + q + r)(10)(100)(1000)",
+        "(_fun (x) _fun (y) x + (_let x = 5 _in x * y) + x)(1)(2)",
+    };
+
+    for (const std::string& program : programs) {
+        INFO(program);
+        PTR(Expr) resolved = parse_str(program);
+        std::stringstream ss(program);
+        PTR(Expr) unresolved = parse_expr(ss); // parse_expr skips the Resolver
+        CHECK(resolved->equals(unresolved));
+        CHECK(run_or_error(tree_interp, resolved) == run_or_error(tree_interp, unresolved));
+        CHECK(run_or_error(vm_interp, resolved) == run_or_error(tree_interp, unresolved));
+    }
+
+    CHECK(parse_str("(_fun (a) _let g = _fun (x) a + x _in _let a = 100 _in g(1))(10)")
+              ->interp(Env::empty)->to_string() == "11");
+    CHECK_THROWS_WITH(parse_str("(_fun (a) _let f = _fun (x) y _in _let y = 1 _in f(0))(0)")
+                          ->interp(Env::empty), "Free variable: y");
+
+    // A resolved function value still works after a round trip through to_expr
+    PTR(Val) f = parse_str("_fun (x) _let y = x * 3 _in y + 1")->interp(Env::empty);
+    CHECK(f->call(NEW(NumVal)(2))->to_string() == "7");
+    CHECK(f->to_expr()->interp(Env::empty)->call(NEW(NumVal)(2))->to_string() == "7");
+}
+
+TEST_CASE("Closure conversion") {
+    // A resolved closure copies just the variables its body uses
+    PTR(Val) outer = parse_str("_fun (big) _fun (used) _fun (x) x + used")->interp(Env::empty);
+    PTR(Val) big = NEW(NumVal)(5000);
+    std::weak_ptr<Val> watch = big;
+    PTR(Val) inner = outer->call(big)->call(NEW(NumVal)(7));
+    big = nullptr;
+    CHECK(watch.expired()); // Nothing keeps the enclosing calls' frames alive
+    CHECK(inner->call(NEW(NumVal)(1))->to_string() == "8");
+
+    // Unresolved closures still keep their whole environment
+    std::stringstream ss("_fun (big) _fun (x) x");
+    PTR(Val) unresolved = parse_expr(ss)->interp(Env::empty);
+    big = NEW(NumVal)(5000);
+    watch = big;
+    PTR(Val) keeps = unresolved->call(big);
+    big = nullptr;
+    CHECK(!watch.expired());
+
+    // Names the Resolver left free are still found by name, as Program inputs are
+    Program p("_let k = _fun (x) x + n _in k(1)", {"n"});
+    CHECK(p.run_to_string({41}) == "42");
+}
+
+// ====================== Immediate Value Tests ======================
+TEST_CASE("Immediate values") {
+    // Small integers and booleans are shared, preallocated objects
+    CHECK(NumVal::make(7) == NumVal::make(7));
+    CHECK(NumVal::make(NumVal::small_min) == NumVal::make(NumVal::small_min));
+    CHECK(NumVal::make(NumVal::small_max) == NumVal::make(NumVal::small_max));
+    CHECK(BoolVal::make(true) == BoolVal::make(true));
+    CHECK(BoolVal::make(true) != BoolVal::make(false));
+
+    // Values outside the table are still correct, just allocated
+    CHECK(NumVal::make(NumVal::small_max + 1)->equals(NEW(NumVal)(NumVal::small_max + 1)));
+    CHECK(NumVal::make(-2147483647 - 1)->to_string() == "-2147483648");
+    CHECK(NumVal::make(-5)->equals(NEW(NumVal)(-5)));
+    CHECK(BoolVal::make(false)->equals(NEW(BoolVal)(false)));
+    CHECK(BoolVal::make(true)->is_true());
+
+    // Casting keeps working on preallocated values
+    PTR(Val) v = NumVal::make(3);
+    CHECK(CAST(NumVal)(v) != nullptr);
+    CHECK(CAST(NumVal)(v)->value == 3);
+    CHECK(parse_str("(1 + 2) == 3")->interp(Env::empty) == BoolVal::make(true));
+    CHECK(parse_str("500 * 4")->interp(Env::empty)->to_string() == "2000");
+}
+
+// ====================== Batch Mode Tests ======================
+TEST_CASE("Batch mode") {
+    std::stringstream in("1 + 2\n"
+                         "_let x = 5 _in x * x; _true == _false\n"
+                         "\n"
+                         "   ;  \n"
+                         "y + 1\n"
+                         "(_fun (x) x + 1)(41);1 + ;_if 1 _then 2 _else 3\n"
+                         "2147483647 + 1");
+    std::stringstream out;
+    CHECK(run_batch(in, out) == 4);
+    CHECK(out.str() == "3\n"
+                       "25\n"
+                       "_false\n"
+                       "Error: Free variable: y\n"
+                       "42\n"
+                       "Error: bad input\n"
+                       "Error: Condition must be a boolean\n"
+                       "Error: arithmetic overflow\n");
+
+    std::string one;
+    CHECK(batch_eval("_let f = _fun (x) x * 2 _in f(21)", one));
+    CHECK_FALSE(batch_eval("_fun (x", one));
+    CHECK(one == "42\nError: bad input\n");
+
+    std::stringstream empty_in, empty_out;
+    CHECK(run_batch(empty_in, empty_out) == 0);
+    CHECK(empty_out.str().empty());
+}
+
+// ====================== Parallel Batch Tests ======================
+TEST_CASE("Parallel batch mode") {
+    // Every index runs exactly once, even when the work per index is uneven
+    ThreadPool pool(4);
+    CHECK(pool.size() == 4);
+    for (size_t n : {0, 1, 3, 1000}) {
+        std::vector<int> hits(n, 0);
+        pool.parallel_for(n, [&](size_t i) {
+            volatile int spin = 0;
+            for (size_t k = 0; k < (i % 7) * 1000; k++) {
+                spin = spin + 1;
+            }
+            hits[i]++;
+        });
+        CHECK(std::count(hits.begin(), hits.end(), 1) == (long)n);
+    }
+
+    // Output stays in input order and matches a serial run
+    std::string input;
+    for (int i = 0; i < 5000; i++) {
+        input += "_let x = " + std::to_string(i) + " _in (_fun (y) x * y)(2)";
+        input += i % 10 == 0 ? "; x\n" : "\n";
+    }
+    std::stringstream serial_in(input), parallel_in(input);
+    std::stringstream serial_out, parallel_out;
+    CHECK(run_batch(serial_in, serial_out, 1) == 500);
+    CHECK(run_batch(parallel_in, parallel_out, 4) == 500);
+    CHECK(parallel_out.str() == serial_out.str());
+    CHECK(parallel_out.str().substr(0, 26) == "0\nError: Free variable: x\n");
+}
+
+// ====================== Optimizer Tests ======================
+TEST_CASE("Optimizer") {
+    auto optimized = [](const std::string& program) { return Optimizer::optimize(parse_str(program)); };
+
+    // Folding, constant propagation and branch selection
+    CHECK(optimized("(3 + 4) * x")->equals(parse_str("7 * x")));
+    CHECK(optimized("_let y = 5 _in y * 2")->equals(parse_str("10")));
+    CHECK(optimized("_let y = 2 * 3 _in _let z = y + 1 _in z == 7")->equals(parse_str("_true")));
+    CHECK(optimized("_if 1 == 1 _then a _else b")->equals(parse_str("a")));
+    CHECK(optimized("_if _false _then nope _else 2 + 2")->equals(parse_str("4")));
+    CHECK(optimized("_fun (x) (2 * 3) + x")->equals(parse_str("_fun (x) 6 + x")));
+    CHECK(optimized("1 == _true")->equals(parse_str("_false")));
+
+    // Arguments and non-constant _lets hide outer constants
+    CHECK(optimized("_let x = 1 _in _fun (x) x + 1")->equals(parse_str("_fun (x) x + 1")));
+    CHECK(optimized("_let x = 1 _in _let x = y _in x")->equals(parse_str("_let x = y _in x")));
+    CHECK(optimized("_let x = 1 _in (_let x = 2 _in x) + x")->equals(parse_str("3")));
+
+    // Anything that would throw is left for run time
+    CHECK(optimized("2147483647 + 1")->equals(parse_str("2147483647 + 1")));
+    CHECK_THROWS_WITH(optimized("2147483647 + 1")->interp(Env::empty), "arithmetic overflow");
+    CHECK(optimized("_if _true _then 0 _else 2147483647 * 2")->equals(parse_str("0")));
+    CHECK(optimized("_true + 1")->equals(parse_str("_true + 1")));
+    CHECK(optimized("_if 1 _then 2 _else 3")->equals(parse_str("_if 1 _then 2 _else 3")));
+
+    // The optimized tree means the same thing, on both evaluators
+    std::vector<std::string> programs = {
+        "_let x = 5 _in _let f = _fun (y) y * (x + 1) _in f(2) + f(3)",
+        "_let a = 3 _in (_fun (a) a * a)(a + 1)",
+        "_let g = _fun (n) _if n == 0 _then 1 _else n * 2 _in g(0) + g(4)",
+        "_let f = _fun (x) x + 2147483647 _in f(1)",
+        "(_fun (x) 1 + 2) == (_fun (x) 3)",
+        "(_let a = 1 _in _fun (x) a) == (_let a = 2 _in _fun (x) a)",
+        "_let x = 1 _in _let f = _fun (y) x _in _let x = 2 _in f(0) + x",
+        "_if 1 + 2 == 3 _then z _else 0",
+    };
+    for (const std::string& program : programs) {
+        INFO(program);
+        PTR(Expr) e = parse_str(program);
+        PTR(Expr) o = Optimizer::optimize(e);
+        CHECK(run_or_error(tree_interp, o) == run_or_error(tree_interp, e));
+        CHECK(run_or_error(vm_interp, o) == run_or_error(tree_interp, e));
+    }
+
+    // Function values compare by the bodies they were written with
+    CHECK(optimized("(_fun (x) 1 + 2) == (_fun (x) 3)")->interp(Env::empty)->to_string() == "_false");
+    CHECK(optimized("(_let a = 1 _in _fun (x) a) == (_let a = 2 _in _fun (x) a)")
+              ->interp(Env::empty)->to_string() == "_true");
+}
+
+// ====================== Call Depth Tests ======================
+TEST_CASE("Tail calls and call depth") {
+    int tree_depth = FunVal::max_depth;
+    int vm_depth = VM::max_depth;
+    std::string countdown = "_let loop = _fun (f) _fun (n) _if n == 0 _then 42 _else f(f)(n + -1)"
+                            " _in loop(loop)(";
+    std::string sum = "_let sum = _fun (f) _fun (n) _if n == 0 _then 0 _else n + f(f)(n + -1)"
+                      " _in sum(sum)(";
+
+    // Only calls whose result is returned directly become tail calls
+    auto has_op = [](const std::string& program, opcode_t op) {
+        PTR(Bytecode) code = Compiler::compile(parse_str(program));
+        for (const FunProto& proto : code->protos) {
+            for (const Instr& in : proto.code) {
+                if (in.op == op) return true;
+            }
+        }
+        return false;
+    };
+    CHECK(has_op("_fun (x) x(1)", op_tail_call));
+    CHECK(has_op("_fun (x) _let y = 2 _in _if _true _then x(y) _else 0", op_tail_call));
+    CHECK_FALSE(has_op("_fun (x) 1 + x(1)", op_tail_call));
+    CHECK_FALSE(has_op("_fun (x) x(1) == 2", op_tail_call));
+
+    // On the VM, tail recursion runs in constant space
+    VM::max_depth = 100;
+    CHECK(vm_interp(parse_str(countdown + "1000000)"))->to_string() == "42");
+    CHECK(vm_interp(parse_str(sum + "50)"))->to_string() == "1275");
+    CHECK_THROWS_WITH(vm_interp(parse_str(sum + "1000)")), "maximum call depth exceeded");
+    VM::max_depth = vm_depth;
+    CHECK(vm_interp(parse_str(sum + "60000)"))->to_string() == "1800030000"); // Far deeper than the native stack allows
+
+    // The tree-walker throws instead of overflowing the native stack
+    FunVal::max_depth = 100;
+    CHECK(parse_str(sum + "50)")->interp(Env::empty)->to_string() == "1275");
+    CHECK_THROWS_WITH(parse_str(sum + "1000)")->interp(Env::empty), "maximum call depth exceeded");
+    CHECK(parse_str(sum + "50)")->interp(Env::empty)->to_string() == "1275"); // Depth was unwound
+
+    // Its tail calls, through _if and _let, also run in constant space, resolved or not
+    CHECK(parse_str(countdown + "100000)")->interp(Env::empty)->to_string() == "42");
+    std::stringstream unresolved(countdown + "100000)");
+    CHECK(parse_expr(unresolved)->interp(Env::empty)->to_string() == "42");
+    CHECK(parse_str("_let even = _fun (e) _fun (o) _fun (n) _if n == 0 _then _true _else o(e)(o)(n + -1)"
+                    " _in _let odd = _fun (e) _fun (o) _fun (n) _if n == 0 _then _false _else"
+                    " _let m = n + -1 _in e(e)(o)(m)"
+                    " _in even(even)(odd)(100001)")->interp(Env::empty)->to_string() == "_false");
+    CHECK(parse_str(countdown + "100000) + 1")->interp(Env::empty)->to_string() == "43");
+    CHECK_THROWS_WITH(parse_str(countdown + "_true)")->interp(Env::empty), "Cannot add non-numeric values");
+    FunVal::max_depth = tree_depth;
+
+    // With a stack too small for max_depth calls, the actual stack is the limit
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, 512 * 1024);
+    struct Run {
+        std::string program;
+        std::string result;
+        static void* main(void* arg) {
+            Run* run = (Run*)arg;
+            try {
+                run->result = parse_str(run->program)->interp(Env::empty)->to_string();
+            } catch (std::runtime_error& e) {
+                run->result = e.what();
+            }
+            return nullptr;
+        }
+    };
+    Run deep{sum + std::to_string(tree_depth - 10) + ")", ""};
+    Run shallow{sum + "100)", ""};
+    for (Run* run : {&deep, &shallow}) {
+        pthread_t thread;
+        REQUIRE(pthread_create(&thread, &attr, Run::main, run) == 0);
+        pthread_join(thread, nullptr);
+    }
+    pthread_attr_destroy(&attr);
+    CHECK(deep.result == "maximum call depth exceeded");
+    CHECK(shallow.result == "5050");
+}
+
+// ====================== Hash-Consing Tests ======================
+TEST_CASE("Hash-consed expressions") {
+    ExprInterner in;
+    std::string program = "_let f = _fun (x) (x * 2) + (x * 2) _in f(3) + f(3)";
+
+    // Structurally equal subtrees become one node
+    PTR(Expr) a = in.intern(parse_str(program));
+    PTR(Expr) b = in.intern(parse_str(program));
+    CHECK(a == b);
+    CHECK(a->is_interned());
+    CHECK(in.intern(a) == a);
+    CHECK(in.intern(NEW(AddExpr)(NEW(NumExpr)(1), NEW(NumExpr)(1)))->hash()
+          == in.intern(NEW(AddExpr)(NEW(NumExpr)(1), NEW(NumExpr)(1)))->hash());
+
+    // (x * 2) is stored once, as are f(3), x and 2
+    size_t before = in.size();
+    in.intern(parse_str("(x * 2) + (x * 2)"));
+    CHECK(in.size() == before);
+
+    // equals agrees with the structural comparison
+    CHECK(a->equals(parse_str(program)));
+    CHECK(parse_str(program)->equals(a));
+    CHECK_FALSE(a->equals(in.intern(parse_str("_let f = _fun (x) x * 2 _in f(3)"))));
+    CHECK_FALSE(in.intern(NEW(NumExpr)(1))->equals(in.intern(NEW(BoolExpr)(true))));
+
+    // Trees from different interners still compare structurally
+    ExprInterner other;
+    PTR(Expr) c = other.intern(parse_str(program));
+    CHECK(c != a);
+    CHECK(c->equals(a));
+    CHECK_FALSE(c->equals(in.intern(parse_str("1 + 2"))));
+
+    // Interned trees are evaluated by name and give the same results
+    CHECK(a->interp(Env::empty)->to_string() == "24");
+    CHECK(vm_interp(a)->to_string() == "24");
+    PTR(Expr) shadow = in.intern(parse_str("_let x = 1 _in (_let x = 2 _in x) + x + (_fun (x) x)(3)"));
+    CHECK(shadow->interp(Env::empty)->to_string() == "6");
+    CHECK_THROWS_WITH(in.intern(parse_str("_let y = 1 _in y + z"))->interp(Env::empty), "Free variable: z");
+
+    // Optimizing an interned tree gives an ordinary, resolved tree
+    CHECK(Optimizer::optimize(a)->interp(Env::empty)->to_string() == "24");
+}
+
+TEST_CASE("Writer") {
+    // An in-memory writer keeps everything and counts every byte
+    Writer w;
+    w << "_let " << 'x' << std::string(" = ") << -42 << ' ' << INT_MIN << ' ' << 0;
+    w.repeat(' ', 3);
+    CHECK(w.str() == "_let x = -42 -2147483648 0   ");
+    CHECK(w.position() == w.str().size());
+    CHECK(w.take() == "_let x = -42 -2147483648 0   ");
+    CHECK(w.str().empty());
+    CHECK(w.position() == 29);
+
+    // Pretty-printing measures columns from position(), not from the buffer
+    PTR(Expr) let = parse_str("_let x = 1 _in _let y = 2 _in x + y");
+    w << "a\nbc";
+    let->pretty_print(w, prec_none);
+    CHECK(w.take() == "a\nbc_let x = 1\n_in  _let y = 2\n     _in  x + y");
+    let->pretty_print(w, prec_none);
+    CHECK(w.str() == let->to_pretty_string());
+
+    // A writer on a file descriptor flushes as its buffer fills and when asked
+    std::FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    std::vector<PTR(Expr)> terms;
+    for (int i = 0; i < 16384; i++) {
+        terms.push_back(NEW(NumExpr)(i));
+    }
+    while (terms.size() > 1) {
+        std::vector<PTR(Expr)> pairs;
+        for (size_t i = 0; i < terms.size(); i += 2) {
+            pairs.push_back(NEW(MultExpr)(terms[i], terms[i + 1]));
+        }
+        terms.swap(pairs);
+    }
+    PTR(Expr) big = terms[0];
+    {
+        Writer out(fileno(file));
+        big->printExp(out);
+        out << '\n';
+        big->pretty_print(out, prec_none);
+        CHECK(out.str().size() < out.position());
+    }
+    std::string expected = big->to_string() + "\n" + big->to_pretty_string();
+    std::string written(expected.size() + 1, '\0');
+    std::rewind(file);
+    written.resize(std::fread(&written[0], 1, written.size(), file));
+    std::fclose(file);
+    CHECK(written == expected);
+}
+
+// ====================== Deep Expression Tests ======================
+TEST_CASE("Deep expressions") {
+    const int n = 100000;
+
+    // A long sum nests to the right; parsing, printing and freeing it must not use the stack
+    std::string sum = "1";
+    for (int i = 0; i < n; i++) {
+        sum += " + 1";
+    }
+    std::string sum_printed;
+    for (int i = 0; i < n; i++) {
+        sum_printed += "(1+";
+    }
+    sum_printed += "1" + std::string(n, ')');
+    {
+        PTR(Expr) e = parse_str(sum);
+        CHECK(e->to_string() == sum_printed);
+        CHECK(e->to_pretty_string() == sum);
+    }
+
+    // Left-nested products, calls and functions nest the other ways; they round-trip
+    std::string product = std::string(n, '(') + "2";
+    std::string calls = "f";
+    std::string funs;
+    for (int i = 0; i < n; i++) {
+        product += " * 3)";
+        calls += "(1)";
+        funs += "_fun (x) ";
+    }
+    funs += "x";
+    for (const std::string& program : {product, calls, funs}) {
+        PTR(Expr) e = parse_str(program);
+        std::string printed = e->to_string();
+        CHECK(parse_str(printed)->to_string() == printed);
+        CHECK(parse_str(e->to_pretty_string())->to_string() == printed);
+    }
+
+    // A let chain deeper than the resolver's recursion limit still gets the right slots
+    std::string lets = "_let x = 0 _in ";
+    for (int i = 1; i < 3000; i++) {
+        lets += "_let x = x + 1 _in ";
+    }
+    lets += "x";
+    PTR(Expr) resolved = parse_str(lets);
+    std::stringstream ss(lets);
+    PTR(Expr) unresolved = parse_expr(ss);
+    CHECK(resolved->interp(Env::empty)->to_string() == "2999");
+    CHECK(unresolved->interp(Env::empty)->to_string() == "2999");
+    CHECK(resolved->to_string() == unresolved->to_string());
+
+    // Constant folding walks deep trees without the stack, so --interp and
+    // --compile take them as --interp-vm does
+    {
+        PTR(Expr) e = parse_str(sum);
+        CHECK(Optimizer::optimize(e)->to_string() == std::to_string(n + 1));
+        CHECK(e->to_string() == sum_printed); // The input is left as it was
+    }
+    std::string deep_lets = "_let x = 0 _in ";
+    for (int i = 1; i < n; i++) {
+        deep_lets += "_let x = x + 1 _in ";
+    }
+    deep_lets += "x";
+    CHECK(Optimizer::optimize(parse_str(deep_lets))->interp(Env::empty)->to_string() == std::to_string(n - 1));
+
+    // A deep function body that folding changes round-trips through --compile,
+    // even though it is too deep to compare with the body as written
+    std::string fun = "_fun (x) ";
+    for (int i = 0; i < n; i++) {
+        fun += "x + ";
+    }
+    fun += "(1 + 2)";
+    {
+        PTR(Expr) folded = Optimizer::optimize(parse_str(fun));
+        PTR(Expr) decoded = Decoder(Encoder::encode(folded)).decode();
+        CHECK(decoded->to_string() == folded->to_string());
+        CHECK(decoded->to_string().find("(x+3)") != std::string::npos);
+    }
+
+    // So does hash-consing: equal deep trees intern to the same node
+    {
+        ExprInterner in;
+        PTR(Expr) a = in.intern(parse_str(sum));
+        CHECK(in.intern(parse_str(sum)) == a);
+        CHECK(in.size() == (size_t)n + 1); // One NumExpr 1 and an AddExpr per depth
+        CHECK(a->to_string() == sum_printed);
+    }
+}
+
+// ====================== Memoization Tests ======================
+TEST_CASE("Memoized calls") {
+    std::string fib = "_let fib = _fun (f) _fun (n) _if n == 0 _then 0 _else _if n == 1 _then 1"
+                      " _else f(f)(n + -1) + f(f)(n + -2) _in fib(fib)(";
+    CHECK(CallCache::current() == nullptr);
+    CHECK(parse_str(fib + "15)")->interp(Env::empty)->to_string() == "610");
+
+    // f(f) always returns the cached closure, so each n runs its body once
+    CallCache::enable(true);
+    CHECK(parse_str(fib + "30)")->interp(Env::empty)->to_string() == "832040");
+    CallCache* cache = CallCache::current();
+    REQUIRE(cache != nullptr);
+    CHECK(cache->misses() == 32); // fib(fib) once, then n = 30 down to 0
+    CHECK(cache->hits() == 3 * 29 - 1); // Both f(f) and n + -2 for n = 30 down to 2, except 0 at n = 2
+
+    // Errors are not cached, and booleans are keyed by value
+    CHECK_THROWS_WITH(parse_str("_let f = _fun (x) x + 1 _in f(_true)")->interp(Env::empty),
+                      "Cannot add non-numeric values");
+    CHECK(parse_str("_let f = _fun (x) _if x _then 1 _else 2 _in f(_true) + f(1 == 1) + f(_false)")
+              ->interp(Env::empty)->to_string() == "4");
+    CallCache::enable(false);
+    CHECK(CallCache::current() == nullptr);
+
+    // The least recently used entry is dropped first
+    CallCache lru(2);
+    PTR(Val) f = parse_str("_fun (x) x * x")->interp(Env::empty);
+    PTR(Val) g = parse_str("_fun (x) x")->interp(Env::empty);
+    PTR(Val) result;
+    lru.insert(f, NumVal::make(3), NumVal::make(9));
+    lru.insert(f, g, g);
+    CHECK(lru.find(&*f, NumVal::make(3), result));
+    CHECK(result->to_string() == "9");
+    lru.insert(g, NumVal::make(4), NumVal::make(4));
+    CHECK(lru.size() == 2);
+    CHECK_FALSE(lru.find(&*f, g, result));
+    CHECK(lru.find(&*f, NumVal::make(3), result));
+    CHECK(lru.find(&*g, NumVal::make(4), result));
+    CHECK_FALSE(lru.find(&*g, NumVal::make(3), result));
+    CHECK(lru.hits() == 3);
+    CHECK(lru.misses() == 2);
+}
+
+// ====================== Big Number Tests ======================
+TEST_CASE("Big numbers") {
+    // Values leave the inline 64-bit form only when they overflow it, and come back
+    BigInt max(INT64_MAX);
+    CHECK((max + 1).to_string() == "9223372036854775808");
+    CHECK((max + 1).limbs() == 2);
+    CHECK((max + 1) + -1 == max);
+    CHECK(((max + 1) + -1).limbs() == 0);
+    CHECK((BigInt(INT64_MIN) * -1).to_string() == "9223372036854775808");
+    CHECK(BigInt::parse("-9223372036854775808") == BigInt(INT64_MIN));
+    CHECK(BigInt::parse("-0") == BigInt(0));
+    BigInt f = 1;
+    for (int i = 1; i <= 30; i++) {
+        f = f * i;
+    }
+    CHECK(f.to_string() == "265252859812191058636308480000000");
+    CHECK(f + BigInt::parse("-265252859812191058636308480000001") == BigInt(-1));
+
+    // Karatsuba agrees with schoolbook multiplication, also on lopsided operands
+    const size_t karatsuba = BigInt::karatsuba_limbs;
+    BigInt nines = BigInt::parse(std::string(2000, '9'));
+    BigInt other = BigInt::parse("-" + std::string(700, '8') + "1");
+    BigInt square = nines * nines;
+    BigInt product = nines * other;
+    CHECK(square.to_string() == std::string(1999, '9') + "8" + std::string(1999, '0') + "1");
+    BigInt::karatsuba_limbs = SIZE_MAX;
+    CHECK(nines * nines == square);
+    CHECK(nines * other == product);
+    BigInt::karatsuba_limbs = karatsuba;
+
+    // Without --bignum, numbers are ints as before
+    CHECK_THROWS_WITH(parse_str("2147483647 + 1")->interp(Env::empty), "arithmetic overflow");
+    CHECK_THROWS_WITH(parse_str("4294967296"), "number too large");
+
+    BigInt::enabled = true;
+    CHECK(parse_str("2147483647 + 1")->interp(Env::empty)->to_string() == "2147483648");
+    CHECK(parse_str("99999999999999999999 * 99999999999999999999")->interp(Env::empty)->to_string()
+          == "9999999999999999999800000000000000000001");
+    CHECK(parse_str("((2147483647 + 1) + -1) == 2147483647")->interp(Env::empty)->to_string() == "_true");
+    CHECK(parse_str("-2147483648")->equals(NEW(NumExpr)(INT_MIN)));
+    CHECK(parse_str("123456789012345678901234567890")->to_string() == "123456789012345678901234567890");
+    CHECK(Optimizer::optimize(parse_str("_let x = 4294967296 _in x * x"))->to_string() == "18446744073709551616");
+    CHECK(parse_str("_let f = _fun (f) _fun (n) _if n == 0 _then 1 _else n * f(f)(n + -1) _in f(f)(25)")
+              ->interp(Env::empty)->to_string() == "15511210043330985984000000");
+    CHECK_THROWS_WITH(parse_str("4294967296 + _true")->interp(Env::empty), "Cannot add non-numeric values");
+    CHECK_THROWS_WITH(vm_interp(parse_str("4294967296")), "number too large for the VM");
+    BigInt::enabled = false;
+}
+
+// ====================== Embedding Tests ======================
+TEST_CASE("Program API") {
+    // Parsed once, run with different inputs
+    Program poly("_let sq = _fun (v) v * v _in sq(x) + 2 * y", {"x", "y"});
+    CHECK(poly.inputs() == std::vector<std::string>{"x", "y"});
+    CHECK(poly.run_to_string({3, 4}) == "17");
+    CHECK(poly.run_to_string({-5, 0}) == "25");
+    CHECK(poly.run({NumVal::make(1), NumVal::make(1)})->equals(NumVal::make(3)));
+
+    // Any value can be an input, and a function result can be called
+    Program pick("_if c _then f(1) _else f(2)", {"c", "f"});
+    PTR(Val) inc = Program("_fun (n) n + 1").run();
+    CHECK(pick.run({BoolVal::make(true), inc})->to_string() == "2");
+    CHECK(pick.run({BoolVal::make(false), inc})->to_string() == "3");
+    CHECK(Program("_fun (n) n * k", {"k"}).run({NumVal::make(6)})->call(NumVal::make(7))->to_string() == "42");
+
+    // Errors are reported as msdscript reports them
+    CHECK_THROWS_WITH(Program("1 +"), "bad input");
+    CHECK_THROWS_WITH(poly.run_to_string({1}), "expected 2 inputs, got 1");
+    CHECK_THROWS_WITH(Program("x + z", {"x"}).run_to_string({1}), "Free variable: z");
+    CHECK_THROWS_WITH(pick.run({NumVal::make(1), inc}), "Condition must be a boolean");
+
+    // The inputs stay free when the program is folded, and runs do not change it
+    Program folded("_let a = 2 * 3 _in a * x", {"x"});
+    CHECK(folded.expr()->to_string() == "(6*x)");
+    CHECK(folded.run_to_string({7}) == "42");
+    CHECK(folded.run_to_string({7}) == "42");
+}
+
+// ====================== Compiled Program Tests ======================
+
+TEST_CASE("Compiled programs") {
+    // Programs come back structurally equal, resolved, with the same value
+    for (const char* src : {"1 + -2 * 3", "_let x = 5 _in _let y = x * x _in y + x",
+                            "_if 1 == 2 _then _false _else _true",
+                            "_let f = _fun (f) _fun (n) _if n == 0 _then 1 _else n * f(f)(n + -1) _in f(f)(10)",
+                            "-2147483647 + 2147483647", "(_fun (x) x)(_fun (y) y)(7)"}) {
+        PTR(Expr) e = parse_str(src);
+        PTR(Expr) back = Decoder(Encoder::encode(e)).decode();
+        CHECK(back->equals(e));
+        CHECK(back->to_string() == e->to_string());
+        CHECK(back->interp(Env::empty)->to_string() == e->interp(Env::empty)->to_string());
+    }
+
+    // An optimized function keeps the body it was written with, which function values compare by
+    PTR(Expr) folded = Optimizer::optimize(parse_str("_let k = 2 _in _fun (x) k * 3 + x"));
+    PTR(Expr) loaded = Decoder(Encoder::encode(folded)).decode();
+    CHECK(loaded->to_string() == "(_fun (x) (6+x))");
+    CHECK(loaded->interp(Env::empty)->equals(parse_str("_fun (x) k * 3 + x")->interp(Env::empty)));
+    CHECK(!loaded->interp(Env::empty)->equals(parse_str("_fun (x) 6 + x")->interp(Env::empty)));
+    CHECK(loaded->interp(Env::empty)->call(NumVal::make(1))->to_string() == "7");
+
+    // Names are stored once, so repeated long names cost an index each
+    std::string src = "_let counter = 1 _in counter + counter + counter + counter + counter";
+    std::string bytes = Encoder::encode(parse_str(src));
+    CHECK(bytes.size() < src.size() / 2);
+    CHECK(Decoder::is_compiled(bytes));
+    CHECK(!Decoder::is_compiled(src));
+    CHECK(!Decoder(bytes).bignum());
+
+    // Trees too deep for recursion round-trip
+    std::string sum = "1";
+    for (int i = 0; i < 100000; i++) {
+        sum += " + 1";
+    }
+    {
+        PTR(Expr) e = parse_str(sum);
+        CHECK(Decoder(Encoder::encode(e)).decode()->to_pretty_string() == sum);
+    }
+
+    // Big numbers keep their digits, and the file records --bignum
+    BigInt::enabled = true;
+    std::string big = Encoder::encode(parse_str("-123456789012345678901234567890 * 3"));
+    CHECK(Decoder(big).bignum());
+    BigInt::enabled = false;
+    CHECK(Decoder(big).decode()->to_string() == "(-123456789012345678901234567890*3)");
+
+    // Damaged programs are reported, not read past
+    for (size_t n = 0; n < bytes.size(); n++) {
+        CHECK_THROWS_WITH(Decoder(bytes.substr(0, n)).decode(), "bad compiled program");
+    }
+    CHECK_THROWS_WITH(Decoder(bytes + '\0').decode(), "bad compiled program");
+    std::string wrong = bytes;
+    wrong[4] = 9; // Version
+    CHECK_THROWS_WITH(Decoder(wrong), "bad compiled program");
+    wrong = bytes;
+    wrong.back() = 100; // Name index past the table
+    CHECK_THROWS_WITH(Decoder(wrong).decode(), "bad compiled program");
+
+    // load() reads a file written by --compile
+    std::string path = "/tmp/msdscript_test_" + std::to_string(getpid()) + ".msdc";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << Encoder::encode(parse_str("_let sq = _fun (v) v * v _in sq(12)"));
+    }
+    CHECK(Decoder::load(path)->interp(Env::empty)->to_string() == "144");
+    std::remove(path.c_str());
+    CHECK_THROWS(Decoder::load(path));
+}
+
+// ====================== Profiler Tests ======================
+
+TEST_CASE("Profiler") {
+    std::string src = "_let f = _fun (x) x + 1\n_in f(1) + f(2)";
+    PTR(Expr) e = parse_str(src);
+
+    // Nothing is recorded unless a profiler is active
+    Profiler idle;
+    CHECK(e->interp(Env::empty)->to_string() == "5");
+    CHECK(idle.calls(prof_add) == 0);
+
+    Profiler profiler;
+    Profiler::active = &profiler;
+    PTR(Val) result = e->interp(Env::empty);
+    Profiler::active = nullptr;
+    CHECK(result->to_string() == "5");
+
+    // Every interp() call is counted by kind
+    CHECK(profiler.calls(prof_let) == 1);
+    CHECK(profiler.calls(prof_fun) == 1);
+    CHECK(profiler.calls(prof_call) == 2);
+    CHECK(profiler.calls(prof_add) == 3);
+    CHECK(profiler.calls(prof_var) == 4);
+    CHECK(profiler.calls(prof_num) == 4);
+    CHECK(profiler.calls(prof_if) == 0);
+
+    // The closure is the only value allocated; small numbers are preallocated
+    CHECK(profiler.total_allocations() == 1);
+    CHECK(profiler.allocations_in(prof_fun) == 1);
+
+    // Functions are reported by where their _fun is
+    std::stringstream text;
+    profiler.report(text, src);
+    CHECK(text.str().find("hottest functions:") != std::string::npos);
+    CHECK(text.str().find("1:10       _fun (x)                    2") != std::string::npos);
+    std::stringstream json;
+    profiler.report_json(json, src);
+    CHECK(json.str().find("{\"type\":\"CallExpr\",\"calls\":2,") != std::string::npos);
+    CHECK(json.str().find("\"functions\":[{\"line\":1,\"column\":10,\"arg\":\"x\",\"calls\":2,")
+          != std::string::npos);
+
+    // Recursive calls are all counted, and errors leave the profiler consistent
+    Profiler recursive;
+    Profiler::active = &recursive;
+    CHECK_THROWS_WITH(parse_str("_let f = _fun (f) _fun (n) _if n == 0 _then _true + 1 _else f(f)(n + -1)"
+                                " _in f(f)(10)")->interp(Env::empty), "Cannot add non-numeric values");
+    Profiler::active = nullptr;
+    CHECK(recursive.calls(prof_if) == 11);
+    std::stringstream after;
+    recursive.report(after, "");
+    CHECK(after.str().find("?          _fun (n)") != std::string::npos);
+}
+
+// ====================== Type Tag Tests ======================
+
+TEST_CASE("Type tags") {
+    // Every node and value carries its class's tag
+    PTR(Expr) e = parse_str("_let f = _fun (x) _if x == 1 _then _true _else x * 2 + 3 _in f(4)");
+    CHECK(e->type == expr_let);
+    CHECK(NEW(NumExpr)(1)->type == NumExpr::tag);
+    CHECK(NEW(CallExpr)(NEW(VarExpr)("f"), NEW(NumExpr)(1))->type == expr_call);
+    CHECK(NumVal::make(5)->type == val_num);
+    CHECK(NumVal::make(5000)->type == val_num); // Allocated as well as preallocated
+    CHECK(BoolVal::make(false)->type == val_bool);
+    CHECK(e->interp(Env::empty)->type == val_num);
+    CHECK(NEW(FunExpr)("x", NEW(VarExpr)("x"))->interp(Env::empty)->type == val_fun);
+
+    // The casts check the tag, and pass null through
+    PTR(Expr) n = NEW(NumExpr)(7);
+    CHECK(expr_cast<NumExpr>(n) == &*n);
+    CHECK(expr_cast<BoolExpr>(n) == nullptr);
+    CHECK(expr_cast<NumExpr>(PTR(Expr)(nullptr)) == nullptr);
+    PTR(Val) v = BoolVal::make(true);
+    CHECK(val_cast<BoolVal>(v) == &*v);
+    CHECK(val_cast<NumVal>(v) == nullptr);
+    CHECK(val_cast<FunVal>(PTR(Val)(nullptr)) == nullptr);
+
+    // Dispatch on tags keeps the interpreter's type errors
+    CHECK_THROWS_WITH(parse_str("_true * 2")->interp(Env::empty), "Cannot multiply non-numeric values");
+    CHECK_THROWS_WITH(parse_str("_if 1 _then 2 _else 3")->interp(Env::empty), "Condition must be a boolean");
+    CHECK(NumVal::make(3)->equals(NumVal::make(3)));
+    CHECK(!NumVal::make(3)->equals(BoolVal::make(true)));
+}
+
+// ====================== Symbol Tests ======================
+
+TEST_CASE("Symbols") {
+    // Equal names intern to the same id, and the name comes back out
+    Symbol a("alpha");
+    Symbol b(std::string("alp") + "ha");
+    CHECK(a == b);
+    CHECK(a.id() == b.id());
+    CHECK(a != Symbol("beta"));
+    CHECK(a.str() == "alpha");
+    CHECK(Symbol().str() == "");
+    CHECK(Symbol("") == Symbol());
+    size_t before = Symbol::count();
+    Symbol("alpha");
+    CHECK(Symbol::count() == before);
+
+    // Names stay put while the table grows, and threads agree on ids
+    const std::string& kept = Symbol("gamma").str();
+    std::vector<uint32_t> ids[4];
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&ids, t] {
+            for (int i = 0; i < 2000; i++) {
+                ids[t].push_back(Symbol("symboltest" + std::to_string(i)).id());
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    for (int t = 1; t < 4; t++) {
+        CHECK(ids[t] == ids[0]);
+    }
+    CHECK(kept == "gamma");
+    CHECK(Symbol("symboltest1999").str() == "symboltest1999");
+
+    // Looking known names up from many threads adds nothing
+    size_t known = Symbol::count();
+    threads.clear();
+    std::atomic<int> mismatches(0);
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&ids, &mismatches] {
+            for (int i = 0; i < 2000; i++) {
+                mismatches += Symbol("symboltest" + std::to_string(i)).id() != ids[0][i];
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    CHECK(mismatches == 0);
+    CHECK(Symbol::count() == known);
+
+    // Names still print, report free variables, and look up by name
+    CHECK(parse_str("_let abc = 1 _in abc + abd")->to_string() == "(_let abc=1 _in (abc+abd))");
+    CHECK_THROWS_WITH(parse_str("_let abc = 1 _in abc + abd")->interp(Env::empty), "Free variable: abd");
+    CHECK_THROWS_WITH(vm_interp(parse_str("_let abc = 1 _in abc + abd")), "Free variable: abd");
+    PTR(Env) env = NEW(ExtendedEnv)("abc", NumVal::make(1), NEW(ExtendedEnv)("abd", NumVal::make(2), Env::empty));
+    CHECK(env->lookup("abd")->equals(NumVal::make(2)));
+    CHECK(NEW(VarExpr)("abc")->interp(env)->equals(NumVal::make(1)));
+
+    // The table stops growing at its limit; known names keep working
+    size_t limit = Symbol::limit;
+    Symbol::limit = Symbol::bytes() + 200;
+    CHECK(Symbol("symbollimita").str() == "symbollimita");
+    CHECK_THROWS_WITH(Symbol(std::string(300, 'y')), "too many distinct names");
+    size_t full = Symbol::count();
+    CHECK_THROWS_WITH(parse_str("_let symbollimitb = 1 _in symbollimitb + symbollimitc + symbollimitd + symbollimite"),
+                      "too many distinct names");
+    CHECK(Symbol::count() <= full + 2);
+    CHECK(parse_str("_let abc = 5 _in abc * abc")->interp(Env::empty)->to_string() == "25");
+    std::string reply;
+    batch_eval("_let symbollimitf = 1 _in _let symbollimitg = 2 _in _let symbollimith = 3 _in symbollimiti", reply);
+    CHECK(reply == "Error: too many distinct names\n");
+    CHECK(Symbol::bytes() <= Symbol::limit);
+    Symbol::limit = limit;
+    CHECK(Symbol("symbollimiti").str() == "symbollimiti");
+}
+
+// ====================== Exec Pool Tests ======================
+
+TEST_CASE("Exec pool") {
+    // This test binary is itself an msdscript executable, so it can be a worker
+    const char* self = "/proc/self/exe";
+    ExecPool pool(self, 2);
+    CHECK(pool.pooled());
+    CHECK(pool.program() == self);
+
+    // Replies match running the command directly, errors and bad flags included
+    std::vector<std::pair<std::vector<const char*>, std::string>> calls = {
+        {{self, "--interp"}, "_let f = _fun (x) x * x _in f(7)"},
+        {{self, "--print"}, "1 + 2 * 3"},
+        {{self, "--pretty-print"}, "_let x = 1 _in x + 2"},
+        {{self, "--interp"}, "1 + _true"},
+        {{self, "--interp"}, "x"},
+        {{self, "--bogus"}, ""},
+    };
+    for (auto& call : calls) {
+        ExecResult pooled = pool.run((int)call.first.size(), call.first.data(), call.second);
+        ExecResult direct = exec_program((int)call.first.size(), call.first.data(), call.second);
+        CHECK(pooled.exit_code == direct.exit_code);
+        CHECK(pooled.out == direct.out);
+        CHECK(pooled.err == direct.err);
+    }
+    const char* interp[] = {self, "--interp"};
+    CHECK(pool.run(2, interp, "1 + _true").exit_code != 0);
+
+    // Threads share the workers
+    std::vector<std::string> outs[4];
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&pool, &outs, &interp, t] {
+            for (int i = 0; i < 5; i++) {
+                outs[t].push_back(pool.run(2, interp, std::to_string(t) + " * 10 + " + std::to_string(i)).out);
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    for (int t = 0; t < 4; t++) {
+        for (int i = 0; i < 5; i++) {
+            CHECK(outs[t][i] == std::to_string(t * 10 + i) + "\n");
+        }
+    }
+
+    // A program that is not a worker, or another program, runs through exec_program
+    ExecPool echo("/bin/echo", 1);
+    CHECK(!echo.pooled());
+    const char* hello[] = {"/bin/echo", "hi"};
+    CHECK(echo.run(2, hello, "").out == "hi\n");
+    CHECK(pool.run(2, hello, "").out == "hi\n");
+}
+
+// ====================== Serve Mode Tests ======================
+
+TEST_CASE("Serve mode") {
+    LatencyStats stats;
+    CHECK(stats.percentile(50) == 0);
+    for (int i = 100; i >= 1; i--) {
+        stats.add(i);
+    }
+    CHECK(stats.count() == 100);
+    CHECK(stats.percentile(50) == 50);
+    CHECK(stats.percentile(99) == 99);
+    CHECK(stats.percentile(100) == 100);
+    CHECK(stats.percentile(0) == 1);
+
+    std::string path = "/tmp/msdscript_test_" + std::to_string(getpid()) + ".sock";
+    Server server(path, 3);
+    std::thread loop([&] { server.run(); });
+
+    // Requests may be pipelined; replies come back in order, errors included
+    int fd = connect_socket(path);
+    std::vector<std::string> requests = {"1 + 2", "_let f = _fun (x) x * x _in f(12)", "1 +", "x",
+                                         "_if 1 == 1 _then _true _else _false", ""};
+    std::vector<std::string> replies = {"3", "144", "Error: bad input", "Error: Free variable: x", "_true",
+                                        "Error: bad input"};
+    for (const std::string& r : requests) {
+        send_frame(fd, r);
+    }
+    std::string reply;
+    for (const std::string& expected : replies) {
+        REQUIRE(recv_frame(fd, reply));
+        CHECK(reply == expected);
+    }
+    ::close(fd);
+
+    // Several clients at once each get their own answers
+    std::vector<std::string> answers(8);
+    std::vector<std::thread> clients;
+    for (int c = 0; c < 8; c++) {
+        clients.emplace_back([&, c] {
+            int cfd = connect_socket(path);
+            std::string got;
+            for (int i = 0; i < 50; i++) {
+                send_frame(cfd, std::to_string(c) + " * 100 + " + std::to_string(i));
+            }
+            std::string r;
+            for (int i = 0; i < 50; i++) {
+                if (recv_frame(cfd, r)) {
+                    got += r + ",";
+                }
+            }
+            ::close(cfd);
+            answers[c] = got;
+        });
+    }
+    for (std::thread& t : clients) {
+        t.join();
+    }
+    for (int c = 0; c < 8; c++) {
+        std::string expected;
+        for (int i = 0; i < 50; i++) {
+            expected += std::to_string(c * 100 + i) + ",";
+        }
+        CHECK(answers[c] == expected);
+    }
+
+    // A request over the size limit ends that connection only
+    fd = connect_socket(path);
+    unsigned char huge[4] = {0xff, 0xff, 0xff, 0xff};
+    CHECK(::write(fd, huge, 4) == 4);
+    CHECK(!recv_frame(fd, reply));
+    ::close(fd);
+
+    // A client that shuts down its sending side still gets every reply
+    fd = connect_socket(path);
+    send_frame(fd, "6 * 7");
+    send_frame(fd, "_true == _false");
+    CHECK(::shutdown(fd, SHUT_WR) == 0);
+    REQUIRE(recv_frame(fd, reply));
+    CHECK(reply == "42");
+    REQUIRE(recv_frame(fd, reply));
+    CHECK(reply == "_false");
+    CHECK(!recv_frame(fd, reply)); // Then the server closes it
+    ::close(fd);
+
+    // A request nested deeper than the stack allows gets an error, and the server carries on
+    std::string deep = "1";
+    for (int i = 0; i < 500000; i++) {
+        deep += " + 1";
+    }
+    fd = connect_socket(path);
+    send_frame(fd, deep);
+    send_frame(fd, "2 + 2");
+    REQUIRE(recv_frame(fd, reply));
+    CHECK(reply == "Error: expression nested too deeply");
+    REQUIRE(recv_frame(fd, reply));
+    CHECK(reply == "4");
+    ::close(fd);
+
+    // A slow request holds up neither other clients nor the requests sent after it
+    int slow = connect_socket(path);
+    send_frame(slow, "_let loop = _fun (f) _fun (n) _if n == 0 _then 42 _else f(f)(n + -1) _in loop(loop)(300000)");
+    send_frame(slow, "1");
+    fd = connect_socket(path);
+    send_frame(fd, "1 + 2");
+    REQUIRE(recv_frame(fd, reply));
+    CHECK(reply == "3");
+    pollfd waiting = {slow, POLLIN, 0};
+    CHECK(::poll(&waiting, 1, 0) == 0); // The slow reply, and the one queued after it, are not there yet
+    ::close(fd);
+    REQUIRE(recv_frame(slow, reply));
+    CHECK(reply == "42");
+    REQUIRE(recv_frame(slow, reply));
+    CHECK(reply == "1");
+    ::close(slow);
+
+    server.stop();
+    loop.join();
+    CHECK(server.latencies().count() == 6 + 8 * 50 + 2 + 2 + 3);
+    CHECK(access(path.c_str(), F_OK) == 0);
+}
+
+// ====================== Arena Tests ======================
+
+// Counts its destructions, in order, to check what an arena runs
+struct ArenaTracked {
+    std::vector<int>* log;
+    int id;
+    std::string padding; // Not trivially destructible, so the arena must destroy it
+    ArenaTracked(std::vector<int>* log, int id) : log(log), id(id), padding(32, 'x') {}
+    ~ArenaTracked() { log->push_back(id); }
+};
+
+TEST_CASE("Arena allocation") {
+    // Mixed sizes and alignments each come back aligned and do not overlap
+    Arena arena(256);
+    std::vector<std::pair<char*, size_t>> blocks;
+    size_t sizes[] = {1, 8, 3, 16, 2, 5, 64, 7, 32, 1};
+    size_t aligns[] = {1, 8, 1, 16, 2, 4, 64, 1, 32, 1};
+    size_t total = 0;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 10; i++) {
+            char* p = (char*)arena.allocate(sizes[i], aligns[i]);
+            CHECK((uintptr_t)p % aligns[i] == 0);
+            memset(p, i, sizes[i]);
+            blocks.push_back({p, sizes[i]});
+            total += sizes[i];
+        }
+    }
+    CHECK(arena.bytes_used() == total);
+    std::sort(blocks.begin(), blocks.end());
+    for (size_t i = 1; i < blocks.size(); i++) {
+        CHECK(blocks[i - 1].first + blocks[i - 1].second <= blocks[i].first);
+    }
+
+    // An allocation larger than a block gets one of its own, and small ones carry on
+    char* big = (char*)arena.allocate(10000, 16);
+    CHECK((uintptr_t)big % 16 == 0);
+    memset(big, 1, 10000);
+    char* after = (char*)arena.allocate(8, 8);
+    CHECK((after < big || after >= big + 10000));
+    CHECK(arena.bytes_used() == total + 10000 + 8);
+
+    // Also when it is the arena's first block, which reset() keeps
+    Arena small(64);
+    char* first = (char*)small.allocate(1000, 8);
+    memset(first, 1, 1000);
+    small.reset();
+    CHECK(small.bytes_used() == 0);
+    for (int i = 0; i < 100; i++) {
+        CHECK((uintptr_t)small.allocate(24, 8) % 8 == 0);
+    }
+}
+
+TEST_CASE("Arena reset") {
+    std::vector<int> log;
+    {
+        Arena arena(128);
+        for (int i = 0; i < 10; i++) {
+            ArenaTracked* t = arena.create<ArenaTracked>(&log, i);
+            CHECK(t->padding.size() == 32);
+        }
+        CHECK(*arena.create<int>(42) == 42);
+        CHECK(log.empty());
+
+        // reset() runs every destructor, newest first, and the arena is reusable
+        arena.reset();
+        CHECK(log == std::vector<int>({9, 8, 7, 6, 5, 4, 3, 2, 1, 0}));
+        CHECK(arena.bytes_used() == 0);
+        log.clear();
+        arena.create<ArenaTracked>(&log, 100);
+        arena.create<ArenaTracked>(&log, 101);
+        CHECK(log.empty());
+    }
+    // So does destroying the arena
+    CHECK(log == std::vector<int>({101, 100}));
+}
+
+TEST_CASE("Arena scopes") {
+    std::vector<int> log;
+    Arena& fallback = Arena::current();
+    CHECK(&Arena::current() == &fallback);
+    {
+        ArenaScope outer;
+        CHECK(&Arena::current() == &outer.arena());
+        arena_new<ArenaTracked>(&log, 1);
+        {
+            ArenaScope inner;
+            CHECK(&Arena::current() == &inner.arena());
+            arena_new<ArenaTracked>(&log, 2);
+            arena_new<ArenaTracked>(&log, 3);
+        }
+        // Ending the inner scope frees only what it allocated
+        CHECK(log == std::vector<int>({3, 2}));
+        CHECK(&Arena::current() == &outer.arena());
+        CHECK(outer.arena().bytes_used() == sizeof(ArenaTracked));
+    }
+    CHECK(log == std::vector<int>({3, 2, 1}));
+    CHECK(&Arena::current() == &fallback);
+
+    // Each thread has its own default arena, and its scopes do not leak into others
+    ArenaScope mine;
+    Arena* seen[4];
+    bool scoped[4];
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&seen, &scoped, t] {
+            seen[t] = &Arena::current();
+            ArenaScope scope;
+            scoped[t] = &Arena::current() == &scope.arena();
+            for (int i = 0; i < 1000; i++) {
+                *arena_new<int>(i) += t;
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    for (int t = 0; t < 4; t++) {
+        CHECK(seen[t] != &mine.arena());
+        CHECK(seen[t] != &fallback);
+        CHECK(scoped[t]);
+    }
+    CHECK(&Arena::current() == &mine.arena());
+    CHECK(mine.arena().bytes_used() == 0);
+}
@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int threads)
+    : body(nullptr), generation(0), busy(0), stopping(false) {
+    if (threads < 1) {
+        threads = 1;
+    }
+    for (int i = 0; i < threads; i++) {
+        ranges.push_back(std::unique_ptr<Range>(new Range{{}, 0, 0}));
+    }
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back(&ThreadPool::worker, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    start.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return (int)ranges.size();
+}
+
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& fn) {
+    size_t threads = ranges.size();
+    for (size_t i = 0; i < threads; i++) {
+        std::lock_guard<std::mutex> guard(ranges[i]->lock);
+        ranges[i]->begin = n * i / threads;
+        ranges[i]->end = n * (i + 1) / threads;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        body = &fn;
+        busy = (int)workers.size();
+        generation++;
+    }
+    start.notify_all();
+
+    run(0);
+
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this] { return busy == 0; });
+    body = nullptr;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (workers.empty()) {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(std::move(task));
+    }
+    start.notify_one();
+}
+
+void ThreadPool::worker(int id) {
+    size_t seen = 0;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            start.wait(guard, [&] { return stopping || generation != seen || !tasks.empty(); });
+            if (stopping) {
+                return;
+            }
+            if (generation == seen) {
+                // A parallel loop, if one is waiting, goes first
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            seen = generation;
+        }
+        if (task) {
+            task();
+            continue;
+        }
+
+        run(id);
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            busy--;
+        }
+        done.notify_one();
+    }
+}
+
+void ThreadPool::run(int id) {
+    size_t index;
+    while (take(id, index)) {
+        (*body)(index);
+    }
+}
+
+// Takes the next index from this thread's range, stealing half of another
+// thread's remaining range when this one is empty.
+bool ThreadPool::take(int id, size_t& index) {
+    Range& own = *ranges[id];
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.begin < own.end) {
+            index = own.begin++;
+            return true;
+        }
+    }
+
+    size_t threads = ranges.size();
+    for (size_t i = 1; i < threads; i++) {
+        Range& victim = *ranges[(id + i) % threads];
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.begin >= victim.end) {
+                continue;
+            }
+            end = victim.end;
+            begin = victim.begin + (victim.end - victim.begin) / 2; // Leave the victim the front half
+            victim.end = begin;
+        }
+        // The victim may have been left with nothing if it had one index
+        // left, in which case the thief takes that index.
+        std::lock_guard<std::mutex> guard(own.lock);
+        index = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of threads that run parallel loops with work stealing.
+ *
+ * parallel_for() splits its index range evenly across the threads. Each
+ * thread takes indices from the front of its own range. A thread that runs
+ * out steals the back half of the range of another thread that still has
+ * work, so uneven work per index still keeps every thread busy.
+ *
+ * submit() instead queues one task for the worker threads and returns at
+ * once, for a caller that must not wait (see Server).
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Starts the pool.
+     * @param threads Total number of threads, including the caller of parallel_for().
+     */
+    explicit ThreadPool(int threads);
+
+    /**
+     * @brief Stops and joins the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Calls body(i) for every i in [0, n) and waits for all of them.
+     *
+     * The calling thread takes part in the work. Calls may run in any order
+     * and on any thread, so body must be safe to run concurrently and must
+     * not throw.
+     *
+     * @param n Number of indices.
+     * @param body The loop body.
+     */
+    void parallel_for(size_t n, const std::function<void(size_t)>& body);
+
+    /**
+     * @brief Queues a task to run on a worker thread, without waiting for it.
+     *
+     * Tasks start in the order queued, each on the next free worker; a
+     * parallel_for() waits for workers that are running a task. In a pool
+     * with no workers (one thread), the task runs at once on the caller.
+     * Tasks still queued when the pool is destroyed never run.
+     *
+     * @param task The task; it must not throw.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Total number of threads, including the caller.
+     */
+    int size() const;
+
+private:
+    struct Range {
+        std::mutex lock;
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Range>> ranges; // One per thread; 0 is the caller
+
+    std::mutex lock;
+    std::condition_variable start;
+    std::condition_variable done;
+    std::deque<std::function<void()>> tasks;    // Queued by submit(), next one first
+    const std::function<void(size_t)>* body;
+    size_t generation;                          // Incremented for every parallel_for
+    int busy;                                   // Workers still running the current loop
+    bool stopping;
+
+    void worker(int id);
+    void run(int id);
+    bool take(int id, size_t& index);
+};
+
+#endif // THREAD_POOL_H
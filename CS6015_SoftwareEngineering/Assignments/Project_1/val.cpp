@@ -12,14 +12,68 @@
 #include "expr.h" // Include expr.h for Expr and NumExpr
 #include "parse.hpp"
 #include <stdexcept> // For std::runtime_error
+#include <climits>   // For INT_MAX, INT_MIN
 #include "pointer.h"
+#include "memo.h"
+#include <vector>
+
+// ====================== Checked arithmetic ======================
+
+int checked_add(int a, int b) {
+    // Check for overflow in addition
+    if (b > 0 && a > INT_MAX - b) {
+        throw std::runtime_error("arithmetic overflow");
+    }
+    if (b < 0 && a < INT_MIN - b) {
+        throw std::runtime_error("arithmetic overflow");
+    }
+    return a + b;
+}
+
+int checked_mult(int a, int b) {
+    // Check for overflow in multiplication
+    if (a > 0) {
+        if (b > 0 && a > INT_MAX / b) {
+            throw std::runtime_error("arithmetic overflow");
+        }
+        if (b < 0 && b < INT_MIN / a) {
+            throw std::runtime_error("arithmetic overflow");
+        }
+    } else if (a < 0) {
+        if (b > 0 && a < INT_MIN / b) {
+            throw std::runtime_error("arithmetic overflow");
+        }
+        if (b < 0 && b < INT_MAX / a) {
+            throw std::runtime_error("arithmetic overflow");
+        }
+    }
+    return a * b;
+}
 
 // ====================== NumVal Implementation ======================
 
-NumVal::NumVal(int value) : value(value) {}
+NumVal::NumVal(int value) : Val(val_num), value(value) {}
+
+PTR(NumVal) NumVal::make(int value) {
+    // Built on first use; the objects live for the whole program and are
+    // handed out without an owner, so no reference count is ever touched.
+    static std::vector<NumVal>* small = [] {
+        std::vector<NumVal>* table = new std::vector<NumVal>();
+        table->reserve(small_max - small_min + 1);
+        for (int i = small_min; i <= small_max; i++) {
+            table->emplace_back(i);
+        }
+        return table;
+    }();
+
+    if (value >= small_min && value <= small_max) {
+        return UNOWNED(NumVal)(&(*small)[value - small_min]);
+    }
+    return NEW(NumVal)(value);
+}
 
 bool NumVal::equals(PTR(Val) other) {
-    PTR(NumVal) otherNum = CAST(NumVal)(other);
+    NumVal* otherNum = val_cast<NumVal>(other);
     return otherNum && value == otherNum->value;
 }
 
@@ -31,20 +85,50 @@ std::string NumVal::to_string() {
     return std::to_string(value); // Convert NumVal to string
 }
 
+PTR(Val) NumVal::add(int a, int b) {
+    if (!BigInt::enabled) {
+        return NumVal::make(checked_add(a, b));
+    }
+    int64_t sum = (int64_t)a + b; // Cannot overflow in 64 bits
+    if (sum >= INT_MIN && sum <= INT_MAX) {
+        return NumVal::make((int)sum);
+    }
+    return NEW(BigNumVal)(BigInt(sum));
+}
+
+PTR(Val) NumVal::mult(int a, int b) {
+    if (!BigInt::enabled) {
+        return NumVal::make(checked_mult(a, b));
+    }
+    int64_t product = (int64_t)a * b; // Cannot overflow in 64 bits
+    if (product >= INT_MIN && product <= INT_MAX) {
+        return NumVal::make((int)product);
+    }
+    return NEW(BigNumVal)(BigInt(product));
+}
+
 PTR(Val) NumVal::add_to(PTR(Val) other) {
-    PTR(NumVal) otherNum = CAST(NumVal)(other);
-    if (!otherNum) {
+    NumVal* otherNum = val_cast<NumVal>(other);
+    if (otherNum) {
+        return add(value, otherNum->value);
+    }
+    BigInt big;
+    if (!BigNumVal::to_big(other, big)) {
         throw std::runtime_error("Cannot add non-numeric values");
     }
-    return NEW(NumVal)(value + otherNum->value);
+    return BigNumVal::make(BigInt(value) + big);
 }
 
 PTR(Val) NumVal::mult_with(PTR(Val) other) {
-    PTR(NumVal) otherNum = CAST(NumVal)(other);
-    if (!otherNum) {
+    NumVal* otherNum = val_cast<NumVal>(other);
+    if (otherNum) {
+        return mult(value, otherNum->value);
+    }
+    BigInt big;
+    if (!BigNumVal::to_big(other, big)) {
         throw std::runtime_error("Cannot multiply non-numeric values");
     }
-    return NEW(NumVal)(value * otherNum->value);
+    return BigNumVal::make(BigInt(value) * big);
 }
 
 bool NumVal::is_true() {
@@ -56,9 +140,76 @@ PTR(Val) NumVal::call(PTR(Val) actual_arg) {
     throw std::runtime_error("Cannot call a number as a function");
 }
 
+// ====================== BigNumVal Implementation ======================
+
+BigNumVal::BigNumVal(const BigInt& value) : Val(val_big_num), value(value) {}
+
+PTR(Val) BigNumVal::make(const BigInt& value) {
+    if (value.fits_int()) {
+        return NumVal::make(value.to_int());
+    }
+    return NEW(BigNumVal)(value);
+}
+
+bool BigNumVal::to_big(PTR(Val) const& v, BigInt& out) {
+    if (NumVal* n = val_cast<NumVal>(v)) {
+        out = BigInt(n->value);
+        return true;
+    }
+    if (BigNumVal* b = val_cast<BigNumVal>(v)) {
+        out = b->value;
+        return true;
+    }
+    return false;
+}
+
+bool BigNumVal::equals(PTR(Val) other) {
+    BigNumVal* otherBig = val_cast<BigNumVal>(other);
+    return otherBig && value == otherBig->value;
+}
+
+PTR(Expr) BigNumVal::to_expr() {
+    return NEW(BigNumExpr)(value);
+}
+
+std::string BigNumVal::to_string() {
+    return value.to_string();
+}
+
+PTR(Val) BigNumVal::add_to(PTR(Val) other) {
+    BigInt big;
+    if (!to_big(other, big)) {
+        throw std::runtime_error("Cannot add non-numeric values");
+    }
+    return make(value + big);
+}
+
+PTR(Val) BigNumVal::mult_with(PTR(Val) other) {
+    BigInt big;
+    if (!to_big(other, big)) {
+        throw std::runtime_error("Cannot multiply non-numeric values");
+    }
+    return make(value * big);
+}
+
+bool BigNumVal::is_true() {
+    throw std::runtime_error("Cannot use a numeric value as a boolean");
+}
+
+PTR(Val) BigNumVal::call(PTR(Val) actual_arg) {
+    (void)actual_arg; // Mark as unused
+    throw std::runtime_error("Cannot call a number as a function");
+}
+
 // ====================== BoolVal Implementation ======================
 
-BoolVal::BoolVal(bool value) : value(value) {}
+BoolVal::BoolVal(bool value) : Val(val_bool), value(value) {}
+
+PTR(BoolVal) BoolVal::make(bool value) {
+    static BoolVal true_val(true);
+    static BoolVal false_val(false);
+    return UNOWNED(BoolVal)(value ? &true_val : &false_val);
+}
 
 bool BoolVal::is_true() {
     return value;
@@ -79,7 +230,7 @@ PTR(Val) BoolVal::mult_with(PTR(Val) other) {
 }
 
 bool BoolVal::equals(PTR(Val) other) {
-    PTR(BoolVal) otherBool = CAST(BoolVal)(other);
+    BoolVal* otherBool = val_cast<BoolVal>(other);
     return otherBool && value == otherBool->value;
 }
 
@@ -94,16 +245,27 @@ PTR(Val) BoolVal::call(PTR(Val) actual_arg) {
 
 // ====================== FunVal ======================
 
-FunVal::FunVal(const std::string& formal_arg, PTR(Expr) body, PTR(Env) env)
-    : formal_arg(formal_arg), body(body), env(env) {}
+FunVal::FunVal(Symbol formal_arg, PTR(Expr) body, PTR(Env) env, int frame_size,
+               PTR(Expr) source)
+    : Val(val_fun), formal_arg(formal_arg), body(body), env(env), frame_size(frame_size),
+      source(source ? source : body) {}
 
 bool FunVal::equals(PTR(Val) other) {
-    PTR(FunVal) f = CAST(FunVal)(other);
-    return f && formal_arg == f->formal_arg && body->equals(f->body);
+    FunVal* f = val_cast<FunVal>(other);
+    return f && formal_arg == f->formal_arg && source->equals(f->source);
+}
+
+void FunVal::capture(PTR(Val) val) {
+    if (captured < inline_captures) {
+        first_captured[captured] = val;
+    } else {
+        more_captured.push_back(val);
+    }
+    captured++;
 }
 
 PTR(Expr) FunVal::to_expr() {
-    return NEW(FunExpr)(formal_arg, body);
+    return NEW(FunExpr)(formal_arg, body, frame_size, source);
 }
 
 std::string FunVal::to_string() {
@@ -124,7 +286,40 @@ bool FunVal::is_true() {
     throw std::runtime_error("Cannot use function as boolean");
 }
 
+int FunVal::max_depth = 5000;
+
+PTR(Env) FunVal::frame_for(PTR(Val) actual_arg) {
+    if (frame_size > 0) {
+        // Resolved body: the argument lives in slot 0 of a fresh frame, which
+        // reads the captured variables from this FunVal
+        PTR(Env) frame = NEW(FrameEnv)(frame_size, env, captured == 0 ? nullptr : THIS);
+        frame->bind(0, actual_arg);
+        return frame;
+    }
+    return NEW(ExtendedEnv)(formal_arg, actual_arg, env);
+}
+
+Expr* FunVal::enter(PTR(Val) actual_arg, PTR(Env)& body_env) {
+    if (Profiler::active || CallCache::current()) {
+        return nullptr;
+    }
+    body_env = frame_for(actual_arg);
+    return &*body;
+}
+
 PTR(Val) FunVal::call(PTR(Val) actual_arg) {
-    PTR(Env) new_env = NEW(ExtendedEnv)(formal_arg, actual_arg, env);
-    return body->interp(new_env);
+    CallCache* cache = CallCache::current(); // nullptr unless --memoize
+    PTR(Val) result;
+    if (cache && cache->find(this, actual_arg, result)) {
+        return result;
+    }
+
+    CallDepth depth; // Throws instead of overflowing the native stack
+    ProfileCall profile(&*body);
+    result = body->interp(frame_for(actual_arg));
+
+    if (cache) {
+        cache->insert(THIS, actual_arg, result);
+    }
+    return result;
 }
\ No newline at end of file
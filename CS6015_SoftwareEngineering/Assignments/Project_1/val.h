@@ -12,12 +12,26 @@
 #define VAL_H
 
 #include <string>
+#include <vector>
 #include <stdexcept> // For std::runtime_error
 #include "pointer.h"
-#include "expr.h"
-#include "val.h"
-#include "parse.hpp"
-#include "env.h"
+#include "bignum.h"
+#include "profile.h"
+#include "symbol.h"
+#include "stack_guard.h"
+
+class Expr;
+class Env;
+
+/**
+ * @brief The concrete class of a Val, stored in every value (see val_cast).
+ */
+typedef enum {
+    val_num,
+    val_big_num,
+    val_bool,
+    val_fun
+} val_t;
 
 /**
  * @class Val
@@ -28,6 +42,12 @@
  */
 CLASS(Val) {
 public:
+    const val_t type; ///< Which subclass this is; each one's tag.
+
+    explicit Val(val_t type) : type(type) {
+        Profiler::count_allocation(); // Does nothing unless --profile
+    }
+
     virtual ~Val() = default;
 
     /**
@@ -80,6 +100,35 @@ public:
 
 };
 
+/**
+ * @brief Downcasts a value by comparing its type tag, without RTTI.
+ *
+ * Unlike CAST, the result is a plain pointer, so in shared_ptr mode no
+ * reference count is touched; it stays valid as long as v does.
+ *
+ * @tparam T A Val subclass.
+ * @param v Any value, or null.
+ * @return v as a T, or nullptr if v is null or not a T.
+ */
+template <class T>
+T* val_cast(PTR(Val) const& v) {
+    return v && v->type == T::tag ? static_cast<T*>(&*v) : nullptr;
+}
+
+/**
+ * @brief Adds two integers, reporting overflow instead of wrapping.
+ *
+ * @throws std::runtime_error("arithmetic overflow") if the sum does not fit in an int.
+ */
+int checked_add(int a, int b);
+
+/**
+ * @brief Multiplies two integers, reporting overflow instead of wrapping.
+ *
+ * @throws std::runtime_error("arithmetic overflow") if the product does not fit in an int.
+ */
+int checked_mult(int a, int b);
+
 /**
  * @class NumVal
  * @brief Represents a numeric value.
@@ -89,6 +138,8 @@ public:
 class NumVal : public Val {
 
 public:
+    static constexpr val_t tag = val_num; ///< This class's Val::type.
+
 
     int value; // The numeric value
 
@@ -100,6 +151,36 @@ public:
      */
     NumVal(int value);
 
+    /**
+     * @brief Returns a NumVal for the given integer.
+     *
+     * Integers from small_min to small_max come from a preallocated table,
+     * so most arithmetic never allocates; other values are created with NEW.
+     *
+     * @param value The integer value.
+     * @return A NumVal holding value.
+     */
+    static PTR(NumVal) make(int value);
+
+    static const int small_min = -1024; ///< Smallest preallocated integer.
+    static const int small_max = 1023;  ///< Largest preallocated integer.
+
+    /**
+     * @brief Adds two integers.
+     *
+     * @return The sum; with --bignum, a BigNumVal if it does not fit in an int.
+     * @throws std::runtime_error("arithmetic overflow") if it does not fit and --bignum is off.
+     */
+    static PTR(Val) add(int a, int b);
+
+    /**
+     * @brief Multiplies two integers.
+     *
+     * @return The product; with --bignum, a BigNumVal if it does not fit in an int.
+     * @throws std::runtime_error("arithmetic overflow") if it does not fit and --bignum is off.
+     */
+    static PTR(Val) mult(int a, int b);
+
     /**
      * @brief Checks if this NumVal is equal to another Val object.
      *
@@ -151,6 +232,75 @@ public:
     PTR(Val) call(PTR(Val) actual_arg) override;
 };
 
+/**
+ * @class BigNumVal
+ * @brief Represents an integer that does not fit in an int (--bignum).
+ *
+ * Numbers that fit in an int are always NumVals, so a BigNumVal never
+ * equals a NumVal and arithmetic on ints keeps its allocation-free path.
+ */
+class BigNumVal : public Val {
+
+public:
+    static constexpr val_t tag = val_big_num; ///< This class's Val::type.
+
+
+    BigInt value; // The numeric value, outside the range of an int
+
+    /**
+     * @brief Constructs a BigNumVal; use make() unless value is known not to fit in an int.
+     */
+    BigNumVal(const BigInt& value);
+
+    /**
+     * @brief Returns a number value for any integer.
+     * @return A NumVal if value fits in an int, otherwise a BigNumVal.
+     */
+    static PTR(Val) make(const BigInt& value);
+
+    /**
+     * @brief Reads a NumVal or BigNumVal as a BigInt.
+     * @param v Any value.
+     * @param out Set to the number if v is one.
+     * @return true if v is a number.
+     */
+    static bool to_big(PTR(Val) const& v, BigInt& out);
+
+    /**
+     * @brief Checks if this BigNumVal holds the same number as another value.
+     */
+    bool equals(PTR(Val) other) override;
+
+    /**
+     * @brief Converts this BigNumVal to a BigNumExpr object.
+     */
+    PTR(Expr) to_expr() override;
+
+    /**
+     * @brief Converts this BigNumVal to its decimal representation.
+     */
+    std::string to_string() override;
+
+    /**
+     * @brief Adds a number to this one.
+     * @throws std::runtime_error If the other object is not a number.
+     */
+    PTR(Val) add_to(PTR(Val) other) override;
+
+    /**
+     * @brief Multiplies this number by another.
+     * @throws std::runtime_error If the other object is not a number.
+     */
+    PTR(Val) mult_with(PTR(Val) other) override;
+
+    /**
+     * @brief Throws an exception since numeric values cannot be used as booleans.
+     */
+    bool is_true() override;
+
+    PTR(Val) call(PTR(Val) actual_arg) override;
+};
+
 /**
  * @class BoolVal
  * @brief Represents a boolean value.
@@ -161,6 +311,8 @@ class BoolVal : public Val {
     bool value; // The boolean value
 
 public:
+    static constexpr val_t tag = val_bool; ///< This class's Val::type.
+
 
     /**
      * @brief Constructs a BoolVal object with the given boolean value.
@@ -169,6 +321,14 @@ public:
      */
     BoolVal(bool value);
 
+    /**
+     * @brief Returns the shared, preallocated BoolVal for _true or _false.
+     *
+     * @param value The boolean value.
+     * @return A BoolVal holding value; never allocates.
+     */
+    static PTR(BoolVal) make(bool value);
+
     /**
      * @brief Checks if this boolean value is true.
      *
@@ -226,23 +386,58 @@ public:
  * function's formal argument and body expression for later application.
  */
 class FunVal : public Val {
-    std::string formal_arg; ///< The name of the function's formal parameter
+    Symbol formal_arg;         ///< The name of the function's formal parameter
     PTR(Expr) body;            ///< The function's body expression (unevaluated)
-    PTR(Env) env;
+    PTR(Env) env;              ///< Where free names are looked up; for an unresolved body, every variable
+    int frame_size;            ///< Slots in a call's FrameEnv, or 0 if the body is unresolved
+    PTR(Expr) source;          ///< The body as written, compared by equals()
+
+    static constexpr int inline_captures = 2; ///< Most closures capture one or two variables
+
+    PTR(Val) first_captured[inline_captures]; ///< Captured variables 0 and 1, without another allocation
+    std::vector<PTR(Val)> more_captured;      ///< Captured variables from 2 on
+    int captured = 0;                         ///< Number of captured variables
 public:
+    static constexpr val_t tag = val_fun; ///< This class's Val::type.
+
     /**
      * @brief Constructs a function value.
      *
      * @param formal_arg The name of the formal parameter for this function.
      * @param body The expression representing the function body.
+     * @param env The environment captured when the function was created.
+     * @param frame_size Frame size of a resolved body (0 binds the argument in an ExtendedEnv).
+     * @param source The body as written, if body was optimized (nullptr: body itself).
+     */
+    FunVal(Symbol formal_arg, PTR(Expr) body, PTR(Env) env, int frame_size = 0,
+           PTR(Expr) source = nullptr);
+
+    /**
+     * @brief Adds the next variable that a resolved body uses from outside the function.
+     *
+     * Captured variables are in the order of the FunExpr's captures, and the
+     * body reads variable i at depth 1, slot i (see Resolver).
      */
-    FunVal(const std::string& formal_arg, PTR(Expr) body, PTR(Env) env);
+    void capture(PTR(Val) val);
+
+    /**
+     * @brief Reads captured variable i.
+     * @return false if there is no such variable (a closure rebuilt by
+     *         to_expr() or the VM captures nothing; its FrameEnv looks it up by name).
+     */
+    bool captured_at(int i, PTR(Val)& val) const {
+        if (i < captured) {
+            val = i < inline_captures ? first_captured[i] : more_captured[i - inline_captures];
+            return true;
+        }
+        return false;
+    }
 
     /**
      * @brief Checks if this function value equals another value.
      *
      * Two function values are considered equal if they have the same formal
-     * argument name and their bodies are structurally equal.
+     * argument name and their bodies, as written, are structurally equal.
      *
      * @param other The value to compare with this function value.
      * @return true if the values represent the same function, false otherwise.
@@ -298,8 +493,66 @@ public:
      *
      * @param actual_arg The value to apply the function to.
      * @return The result of evaluating the function body with the argument substituted.
+     * With --memoize (see CallCache), a call seen before returns the cached
+     * result without evaluating the body again.
+     *
+     * @throws std::runtime_error("maximum call depth exceeded") (see CallDepth).
      */
     PTR(Val) call(PTR(Val) actual_arg) override;
+
+    /**
+     * @brief Sets up a call without evaluating the body, for the tail-call loop of CallExpr::interp.
+     *
+     * @param actual_arg The value to apply the function to.
+     * @param body_env Set to the environment the body runs in.
+     * @return The body to evaluate next, or nullptr if the call must go
+     *         through call() (with --memoize or while profiling, which see every call).
+     */
+    Expr* enter(PTR(Val) actual_arg, PTR(Env)& body_env);
+
+    /**
+     * @brief Most nested calls the tree-walking interpreter allows (--max-depth).
+     *
+     * Every nested call that is not a tail call uses native stack, so the
+     * default stays well inside an 8 MB thread stack; CallDepth also stops
+     * short of the end of a smaller one. Tail calls do not nest. Deeper
+     * recursion belongs on the VM (vm.h), which keeps its call stack on the heap.
+     */
+    static int max_depth;
+
+private:
+    PTR(Env) frame_for(PTR(Val) actual_arg); // The environment a call's body runs in
+};
+
+/**
+ * @class CallDepth
+ * @brief Counts one active call of the tree-walking interpreter for as long as it lives.
+ *
+ * A chain of tail calls counts as one call. Each thread counts its own.
+ *
+ * @throws std::runtime_error("maximum call depth exceeded") if FunVal::max_depth
+ *         calls are already active on this thread, or its native stack is nearly
+ *         used up (see StackGuard).
+ */
+class CallDepth {
+public:
+    CallDepth() {
+        if (depth >= FunVal::max_depth) {
+            throw std::runtime_error("maximum call depth exceeded");
+        }
+        StackGuard::check(StackGuard::call_reserve, "maximum call depth exceeded");
+        depth++;
+    }
+
+    ~CallDepth() {
+        depth--;
+    }
+
+    CallDepth(const CallDepth&) = delete;
+    CallDepth& operator=(const CallDepth&) = delete;
+
+private:
+    static inline thread_local int depth = 0; ///< Calls currently active on this thread.
 };
 
 #endif // VAL_H
\ No newline at end of file
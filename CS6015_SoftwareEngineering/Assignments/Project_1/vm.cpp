@@ -0,0 +1,334 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "vm.h"
+#include "env.h"
+#include <stdexcept>
+
+// ====================== Compiler ======================
+
+PTR(Bytecode) Compiler::compile(PTR(Expr) e) {
+    Compiler c;
+    c.program = NEW(Bytecode)();
+    c.program->protos.push_back(FunProto{"", e, e, {}, 0, 0, {}, {}});
+    c.scopes.push_back(Scope{0, -1, {}});
+    e->compile(c);
+    c.emit(op_return);
+    c.mark_tail_calls();
+    return c.program;
+}
+
+FunProto& Compiler::current() {
+    return program->protos[scopes.back().proto];
+}
+
+int Compiler::emit(opcode_t op, int arg) {
+    std::vector<Instr>& code = current().code;
+    code.push_back(Instr{op, arg});
+    return (int)code.size() - 1;
+}
+
+void Compiler::patch_to_here(int at) {
+    std::vector<Instr>& code = current().code;
+    code[at].arg = (int)code.size();
+}
+
+// Finds `name` in the given scope. Locals are searched innermost first;
+// anything else is captured from the enclosing function, which adds it to
+// this function's capture list the first time it is seen.
+int Compiler::resolve(int scope, Symbol name, bool& is_local) {
+    Scope& s = scopes[scope];
+    for (int i = (int)s.locals.size() - 1; i >= 0; i--) {
+        if (s.locals[i] == name) {
+            is_local = true;
+            return i;
+        }
+    }
+
+    FunProto& proto = program->protos[s.proto];
+    for (size_t i = 0; i < proto.capture_names.size(); i++) {
+        if (proto.capture_names[i] == name) {
+            is_local = false;
+            return (int)i;
+        }
+    }
+
+    if (s.enclosing < 0) {
+        return -1; // Not bound anywhere: a free variable
+    }
+
+    bool outer_is_local;
+    int outer = resolve(s.enclosing, name, outer_is_local);
+    if (outer < 0) {
+        return -1;
+    }
+
+    proto.captures.push_back(Capture{outer_is_local, outer});
+    proto.capture_names.push_back(name);
+    is_local = false;
+    return (int)proto.captures.size() - 1;
+}
+
+void Compiler::emit_var(Symbol name) {
+    bool is_local;
+    int index = resolve((int)scopes.size() - 1, name, is_local);
+    if (index < 0) {
+        // Free variables are only an error if they are actually evaluated,
+        // exactly like Env::lookup during interp.
+        program->names.push_back(name);
+        emit(op_free, (int)program->names.size() - 1);
+    } else {
+        emit(is_local ? op_local : op_captured, index);
+    }
+}
+
+void Compiler::begin_let(Symbol name) {
+    Scope& s = scopes.back();
+    int slot = (int)s.locals.size();
+    emit(op_set_local, slot);
+    s.locals.push_back(name);
+    if ((int)s.locals.size() > current().num_locals) {
+        current().num_locals = (int)s.locals.size();
+    }
+}
+
+void Compiler::end_let() {
+    scopes.back().locals.pop_back();
+}
+
+void Compiler::emit_fun(Symbol formal_arg, PTR(Expr) body, int frame_size, PTR(Expr) source) {
+    int proto = (int)program->protos.size();
+    program->protos.push_back(FunProto{formal_arg, body, source, {}, 1, frame_size, {}, {}});
+    scopes.push_back(Scope{proto, (int)scopes.size() - 1, {formal_arg}});
+    body->compile(*this);
+    emit(op_return);
+    mark_tail_calls();
+    scopes.pop_back();
+    emit(op_closure, proto);
+}
+
+// A call is in tail position if the function returns its result directly:
+// the next instruction is op_return, possibly after jumps (the end of an
+// _if branch). _let scopes emit no code when they end, so calls at the end
+// of a _let body are found too.
+void Compiler::mark_tail_calls() {
+    std::vector<Instr>& code = current().code;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i].op != op_call) {
+            continue;
+        }
+        size_t next = i + 1;
+        while (code[next].op == op_jump) {
+            next = code[next].arg;
+        }
+        if (code[next].op == op_return) {
+            code[i].op = op_tail_call;
+        }
+    }
+}
+
+// ====================== VM ======================
+
+int VM::max_depth = 10000000;
+
+struct VMClosure;
+
+// A VM value is unboxed: numbers and booleans never allocate.
+struct VMValue {
+    enum { num, boolean, closure } tag;
+    int n;                 // Number, or 0/1 for booleans
+    PTR(VMClosure) fun;    // Only set for closures
+};
+
+struct VMClosure {
+    int proto;
+    std::vector<VMValue> captured;
+};
+
+struct Frame {
+    const FunProto* proto;
+    int pc;
+    size_t base;           // First local slot of this frame
+    PTR(VMClosure) closure;
+};
+
+static bool vm_equals(const Bytecode& code, const VMValue& a, const VMValue& b) {
+    if (a.tag != b.tag) {
+        return false;
+    }
+    if (a.tag != VMValue::closure) {
+        return a.n == b.n;
+    }
+    // Same rule as FunVal::equals: same argument name and same body
+    const FunProto& pa = code.protos[a.fun->proto];
+    const FunProto& pb = code.protos[b.fun->proto];
+    return pa.formal_arg == pb.formal_arg && pa.source->equals(pb.source);
+}
+
+static PTR(Val) to_val(const Bytecode& code, const VMValue& v) {
+    switch (v.tag) {
+        case VMValue::num:
+            return NumVal::make(v.n);
+        case VMValue::boolean:
+            return BoolVal::make(v.n != 0);
+        default: {
+            // Rebuild the closure's environment from its captured variables
+            const FunProto& proto = code.protos[v.fun->proto];
+            PTR(Env) env = Env::empty;
+            for (size_t i = 0; i < v.fun->captured.size(); i++) {
+                env = NEW(ExtendedEnv)(proto.capture_names[i], to_val(code, v.fun->captured[i]), env);
+            }
+            return NEW(FunVal)(proto.formal_arg, proto.body, env, proto.frame_size, proto.source);
+        }
+    }
+}
+
+PTR(Val) VM::run(PTR(Bytecode) code) {
+    std::vector<VMValue> stack;
+    std::vector<VMValue> locals(code->protos[0].num_locals);
+    std::vector<Frame> frames;
+    frames.push_back(Frame{&code->protos[0], 0, 0, nullptr});
+
+    while (true) {
+        Frame& f = frames.back();
+        const Instr& in = f.proto->code[f.pc++];
+
+        switch (in.op) {
+            case op_num:
+                stack.push_back(VMValue{VMValue::num, in.arg, nullptr});
+                break;
+
+            case op_bool:
+                stack.push_back(VMValue{VMValue::boolean, in.arg != 0, nullptr});
+                break;
+
+            case op_local:
+                stack.push_back(locals[f.base + in.arg]);
+                break;
+
+            case op_captured:
+                stack.push_back(f.closure->captured[in.arg]);
+                break;
+
+            case op_free:
+                throw std::runtime_error("Free variable: " + code->names[in.arg].str());
+
+            case op_set_local:
+                locals[f.base + in.arg] = stack.back();
+                stack.pop_back();
+                break;
+
+            case op_add: {
+                VMValue rhs = stack.back();
+                stack.pop_back();
+                VMValue& lhs = stack.back();
+                if (lhs.tag != VMValue::num || rhs.tag != VMValue::num) {
+                    throw std::runtime_error("Cannot add non-numeric values");
+                }
+                lhs.n = checked_add(lhs.n, rhs.n);
+                break;
+            }
+
+            case op_mult: {
+                VMValue rhs = stack.back();
+                stack.pop_back();
+                VMValue& lhs = stack.back();
+                if (lhs.tag != VMValue::num || rhs.tag != VMValue::num) {
+                    throw std::runtime_error("Cannot multiply non-numeric values");
+                }
+                lhs.n = checked_mult(lhs.n, rhs.n);
+                break;
+            }
+
+            case op_eq: {
+                VMValue rhs = stack.back();
+                stack.pop_back();
+                VMValue lhs = stack.back();
+                stack.back() = VMValue{VMValue::boolean, vm_equals(*code, lhs, rhs), nullptr};
+                break;
+            }
+
+            case op_jump:
+                f.pc = in.arg;
+                break;
+
+            case op_jump_if_false: {
+                VMValue cond = stack.back();
+                stack.pop_back();
+                if (cond.tag != VMValue::boolean) {
+                    throw std::runtime_error("Condition must be a boolean");
+                }
+                if (!cond.n) {
+                    f.pc = in.arg;
+                }
+                break;
+            }
+
+            case op_closure: {
+                const FunProto& proto = code->protos[in.arg];
+                PTR(VMClosure) closure = NEW(VMClosure)();
+                closure->proto = in.arg;
+                closure->captured.reserve(proto.captures.size());
+                for (const Capture& cap : proto.captures) {
+                    closure->captured.push_back(cap.from_local
+                                                ? locals[f.base + cap.index]
+                                                : f.closure->captured[cap.index]);
+                }
+                stack.push_back(VMValue{VMValue::closure, 0, closure});
+                break;
+            }
+
+            case op_call:
+            case op_tail_call: {
+                VMValue arg = stack.back();
+                stack.pop_back();
+                VMValue fun = stack.back();
+                stack.pop_back();
+                if (fun.tag == VMValue::num) {
+                    throw std::runtime_error("Cannot call a number as a function");
+                }
+                if (fun.tag == VMValue::boolean) {
+                    throw std::runtime_error("Cannot call a boolean as a function");
+                }
+                const FunProto* proto = &code->protos[fun.fun->proto];
+                if (in.op == op_tail_call) {
+                    // Closures copied what they captured, so the caller's slots can be reused
+                    locals.resize(f.base + proto->num_locals);
+                    locals[f.base] = arg;
+                    f.proto = proto;
+                    f.pc = 0;
+                    f.closure = fun.fun;
+                    break;
+                }
+                if ((int)frames.size() >= max_depth) {
+                    throw std::runtime_error("maximum call depth exceeded");
+                }
+                size_t base = locals.size();
+                locals.resize(base + proto->num_locals);
+                locals[base] = arg;
+                frames.push_back(Frame{proto, 0, base, fun.fun}); // invalidates f
+                break;
+            }
+
+            case op_return:
+                // The result stays on top of the operand stack
+                locals.resize(f.base);
+                frames.pop_back();
+                if (frames.empty()) {
+                    return to_val(*code, stack.back());
+                }
+                break;
+        }
+    }
+}
+
+PTR(Val) vm_interp(PTR(Expr) e) {
+    return VM::run(Compiler::compile(e));
+}
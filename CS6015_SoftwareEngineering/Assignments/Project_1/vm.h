@@ -0,0 +1,184 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VM_H
+#define VM_H
+
+#include <string>
+#include <vector>
+#include "pointer.h"
+#include "expr.h"
+#include "val.h"
+
+/**
+ * @enum opcode_t
+ * @brief Instructions understood by the stack VM.
+ */
+typedef enum {
+    op_num,            ///< Push the number in arg.
+    op_bool,           ///< Push _true (arg != 0) or _false.
+    op_local,          ///< Push local slot arg of the current frame.
+    op_captured,       ///< Push captured variable arg of the current closure.
+    op_free,           ///< Throw "Free variable: " + names[arg].
+    op_set_local,      ///< Pop into local slot arg of the current frame.
+    op_add,            ///< Pop two numbers, push their sum.
+    op_mult,           ///< Pop two numbers, push their product.
+    op_eq,             ///< Pop two values, push whether they are equal.
+    op_jump,           ///< Continue at instruction arg.
+    op_jump_if_false,  ///< Pop a boolean, continue at arg if it is _false.
+    op_closure,        ///< Push a closure over function prototype arg.
+    op_call,           ///< Pop an argument and a function, call the function.
+    op_tail_call,      ///< Like op_call followed by op_return, reusing the current frame.
+    op_return          ///< Return the top of the stack to the caller.
+} opcode_t;
+
+/**
+ * @struct Instr
+ * @brief A single bytecode instruction: an opcode and one integer operand.
+ */
+struct Instr {
+    opcode_t op; ///< The operation to perform.
+    int arg;     ///< Operand; its meaning depends on op.
+};
+
+/**
+ * @struct Capture
+ * @brief Describes where a closure finds one of its captured variables
+ *        at the moment the closure is created.
+ */
+struct Capture {
+    bool from_local; ///< true: local slot of the enclosing frame, false: enclosing capture.
+    int index;       ///< Slot or capture index in the enclosing function.
+};
+
+/**
+ * @struct FunProto
+ * @brief Compiled form of one FunExpr (or of the top-level expression).
+ */
+struct FunProto {
+    Symbol formal_arg;                      ///< Formal argument name (empty for the top level).
+    PTR(Expr) body;                         ///< Source body, kept for to_val().
+    PTR(Expr) source;                       ///< The body as written, for equals().
+    std::vector<Instr> code;                ///< Bytecode for the body.
+    int num_locals;                         ///< Frame size: the argument plus nested _let slots.
+    int frame_size;                         ///< The FunExpr's resolved frame size, for to_val().
+    std::vector<Capture> captures;          ///< How to fill the closure when it is created.
+    std::vector<Symbol> capture_names;      ///< Variable names of the captures, in order.
+};
+
+/**
+ * @class Bytecode
+ * @brief The result of compiling an expression: a table of function prototypes.
+ *
+ * Prototype 0 is the top-level expression.
+ */
+class Bytecode {
+public:
+    std::vector<FunProto> protos;   ///< All compiled functions, top level first.
+    std::vector<Symbol> names;      ///< Names referenced by op_free.
+};
+
+/**
+ * @class Compiler
+ * @brief Translates an Expr tree into Bytecode.
+ *
+ * Each Expr subclass emits its own instructions through Expr::compile; the
+ * Compiler tracks which variables are bound in which function so that every
+ * variable reference becomes a slot index instead of a name lookup.
+ */
+class Compiler {
+public:
+    /**
+     * @brief Compiles an expression into a fresh Bytecode program.
+     * @param e The expression to compile.
+     * @return The compiled program.
+     */
+    static PTR(Bytecode) compile(PTR(Expr) e);
+
+    /**
+     * @brief Appends an instruction to the function being compiled.
+     * @return The index of the new instruction (for patching jumps).
+     */
+    int emit(opcode_t op, int arg = 0);
+
+    /**
+     * @brief Sets the operand of a previously emitted jump to the next instruction.
+     * @param at The index returned by emit().
+     */
+    void patch_to_here(int at);
+
+    /**
+     * @brief Emits the instruction that loads a variable by name.
+     */
+    void emit_var(Symbol name);
+
+    /**
+     * @brief Binds a _let variable in the current function and emits the store.
+     */
+    void begin_let(Symbol name);
+
+    /**
+     * @brief Ends the scope of the innermost _let variable.
+     */
+    void end_let();
+
+    /**
+     * @brief Compiles a function body into a new prototype and emits op_closure.
+     */
+    void emit_fun(Symbol formal_arg, PTR(Expr) body, int frame_size, PTR(Expr) source);
+
+private:
+    struct Scope {
+        int proto;                       // Index into program->protos
+        int enclosing;                   // Index into scopes, or -1 for the top level
+        std::vector<Symbol> locals;      // Active bindings; position == slot
+    };
+
+    PTR(Bytecode) program;
+    std::vector<Scope> scopes;
+
+    FunProto& current();
+    int resolve(int scope, Symbol name, bool& is_local);
+    void mark_tail_calls();
+};
+
+/**
+ * @class VM
+ * @brief Executes Bytecode with an explicit operand stack and call stack.
+ *
+ * Calls never recurse on the native stack, and a call in tail position
+ * replaces the caller's frame, so tail-recursive loops run in constant
+ * space. Other recursion is limited only by max_depth.
+ */
+class VM {
+public:
+    /**
+     * @brief Runs a compiled program.
+     * @param code The program produced by Compiler::compile.
+     * @return The resulting value, converted to the Val hierarchy.
+     * @throws std::runtime_error with the same messages Expr::interp reports,
+     *         or "maximum call depth exceeded" past max_depth nested calls.
+     */
+    static PTR(Val) run(PTR(Bytecode) code);
+
+    /**
+     * @brief Most nested (non-tail) calls a program may make (--max-depth).
+     */
+    static int max_depth;
+};
+
+/**
+ * @brief Compiles and runs an expression on the VM.
+ *
+ * Equivalent to e->interp(Env::empty).
+ */
+PTR(Val) vm_interp(PTR(Expr) e);
+
+#endif // VM_H
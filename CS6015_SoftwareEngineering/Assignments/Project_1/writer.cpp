@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "writer.h"
+#include <cerrno>
+#include <charconv>
+#include <stdexcept>
+#include <unistd.h>
+
+Writer::Writer() : fd(-1), flushed(0) {}
+
+Writer::Writer(int fd) : fd(fd), flushed(0) {
+    buf.reserve(flush_size);
+}
+
+Writer::~Writer() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Nothing useful to do about a failed write while unwinding
+    }
+}
+
+Writer& Writer::operator<<(std::string_view s) {
+    buf.append(s.data(), s.size());
+    maybe_flush();
+    return *this;
+}
+
+Writer& Writer::operator<<(char c) {
+    buf.push_back(c);
+    maybe_flush();
+    return *this;
+}
+
+Writer& Writer::operator<<(int n) {
+    char digits[16];
+    char* end = std::to_chars(digits, digits + sizeof digits, n).ptr;
+    buf.append(digits, end - digits);
+    maybe_flush();
+    return *this;
+}
+
+Writer& Writer::repeat(char c, size_t n) {
+    buf.append(n, c);
+    maybe_flush();
+    return *this;
+}
+
+size_t Writer::position() const {
+    return flushed + buf.size();
+}
+
+const std::string& Writer::str() const {
+    return buf;
+}
+
+std::string Writer::take() {
+    flushed += buf.size();
+    std::string out;
+    out.swap(buf);
+    return out;
+}
+
+void Writer::flush() {
+    if (fd < 0) {
+        return;
+    }
+    const char* p = buf.data();
+    size_t left = buf.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            flushed += buf.size();
+            buf.clear();
+            throw std::runtime_error("write failed");
+        }
+        p += n;
+        left -= n;
+    }
+    flushed += buf.size();
+    buf.clear();
+}
+
+void Writer::maybe_flush() {
+    if (fd >= 0 && buf.size() >= flush_size) {
+        flush();
+    }
+}
@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @class Writer
+ * @brief Append-only text output for the printers.
+ *
+ * A Writer appends into a growable buffer that is reused for its whole
+ * life. One made with a file descriptor writes the buffer to it whenever
+ * it fills, and when flushed or destroyed; one made without keeps
+ * everything, for str() and take().
+ *
+ * position() counts every byte written so far, flushed or not, so the
+ * pretty printer can measure columns without a seekable stream.
+ */
+class Writer {
+public:
+    /**
+     * @brief Creates a Writer that collects its output in memory.
+     */
+    Writer();
+
+    /**
+     * @brief Creates a Writer that writes to a file descriptor.
+     * @param fd The file descriptor, e.g. STDOUT_FILENO. It is not closed.
+     */
+    explicit Writer(int fd);
+
+    /**
+     * @brief Flushes any buffered output, ignoring write errors.
+     */
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    /**
+     * @brief Appends text.
+     */
+    Writer& operator<<(std::string_view s);
+
+    /**
+     * @brief Appends one character.
+     */
+    Writer& operator<<(char c);
+
+    /**
+     * @brief Appends an integer in decimal.
+     */
+    Writer& operator<<(int n);
+
+    /**
+     * @brief Appends n copies of c.
+     */
+    Writer& repeat(char c, size_t n);
+
+    /**
+     * @brief Number of bytes written since the Writer was created.
+     */
+    size_t position() const;
+
+    /**
+     * @brief The output collected so far (for an in-memory Writer).
+     */
+    const std::string& str() const;
+
+    /**
+     * @brief Moves the collected output out, leaving the Writer empty.
+     *
+     * position() keeps counting from where it was.
+     */
+    std::string take();
+
+    /**
+     * @brief Writes the buffered output to the file descriptor, if any.
+     * @throws std::runtime_error("write failed") if the descriptor rejects it.
+     */
+    void flush();
+
+private:
+    std::string buf;
+    int fd;          // -1 for an in-memory Writer
+    size_t flushed;  // Bytes no longer in buf
+
+    static const size_t flush_size = 64 * 1024;
+
+    void maybe_flush();
+};
+
+#endif // WRITER_H
@@ -11,6 +11,7 @@
 #include "expr.h"       // Include the header file for expression classes
 #include <stdexcept>    // For std::runtime_error
 #include <sstream>      // For std::stringstream
+#include <climits>      // For INT_MAX and INT_MIN
 #include "val.h"        // Include val.h for Val and NumVal
 #include "pointer.h"
 
@@ -75,6 +76,10 @@ bool AddExpr::equals(const PTR(Expr) e) {
 PTR(Val) AddExpr::interp(PTR(Env) env) {
     PTR(Val) lhsVal = lhs->interp(env);
     PTR(Val) rhsVal = rhs->interp(env);
+    return add(lhsVal, rhsVal);
+}
+
+PTR(Val) AddExpr::add(PTR(Val) lhsVal, PTR(Val) rhsVal) {
     PTR(NumVal) lhsNum = CAST(NumVal)(lhsVal);
     PTR(NumVal) rhsNum = CAST(NumVal)(rhsVal);
 
@@ -134,6 +139,10 @@ bool MultExpr::equals(const PTR(Expr) e) {
 PTR(Val) MultExpr::interp(PTR(Env) env) {
     PTR(Val) lhsVal = lhs->interp(env);
     PTR(Val) rhsVal = rhs->interp(env);
+    return multiply(lhsVal, rhsVal);
+}
+
+PTR(Val) MultExpr::multiply(PTR(Val) lhsVal, PTR(Val) rhsVal) {
     PTR(NumVal) lhsNum = CAST(NumVal)(lhsVal);
     PTR(NumVal) rhsNum = CAST(NumVal)(rhsVal);
 
@@ -339,21 +348,25 @@ bool IfExpr::equals(const PTR(Expr) e) {
 PTR(Val) IfExpr::interp(PTR(Env) env) {
     // 1. Evaluate the condition in the current environment
     PTR(Val) condVal = condition->interp(env);
-    PTR(BoolVal) boolVal = CAST(BoolVal)(condVal);
-
-    // 2. Verify it's a boolean value
-    if (!boolVal) {
-        throw std::runtime_error("Condition must be a boolean");
-    }
 
-    // 3. Evaluate the appropriate branch in the same environment
-    if (boolVal->is_true()) {
+    // 2. Evaluate the appropriate branch in the same environment
+    if (is_taken(condVal)) {
         return then_branch->interp(env);
     } else {
         return else_branch->interp(env);
     }
 }
 
+bool IfExpr::is_taken(PTR(Val) condVal) {
+    PTR(BoolVal) boolVal = CAST(BoolVal)(condVal);
+
+    // Verify it's a boolean value
+    if (!boolVal) {
+        throw std::runtime_error("Condition must be a boolean");
+    }
+    return boolVal->is_true();
+}
+
 //PTR(Expr) IfExpr::subst(const std::string& var, PTR(Expr) replacement) {
 //    return NEW(IfExpr)(condition->subst(var, replacement),
 //                      then_branch->subst(var, replacement),
@@ -137,6 +137,8 @@ public:
      * @param ot The output stream to print to.
      */
     void printExp(std::ostream& ot) override;
+
+    friend class IncrementalEngine;
 };
 
 /**
@@ -171,6 +173,14 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Adds two values as interp does, checking for non-numbers and overflow.
+     * @param lhs The value of the left-hand side.
+     * @param rhs The value of the right-hand side.
+     * @return A NumVal holding the sum.
+     */
+    static PTR(Val) add(PTR(Val) lhs, PTR(Val) rhs);
+
     /**
      * @brief Substitutes a variable with a replacement expression in both sub-expressions.
      * @param var The variable to substitute.
@@ -193,6 +203,7 @@ public:
      */
     void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
 
+    friend class IncrementalEngine;
 };
 
 /**
@@ -227,6 +238,14 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Multiplies two values as interp does, checking for non-numbers and overflow.
+     * @param lhs The value of the left-hand side.
+     * @param rhs The value of the right-hand side.
+     * @return A NumVal holding the product.
+     */
+    static PTR(Val) multiply(PTR(Val) lhs, PTR(Val) rhs);
+
     /**
      * @brief Substitutes a variable with a replacement expression in both sub-expressions.
      * @param var The variable to substitute.
@@ -248,6 +267,8 @@ public:
      * @param last_newline_pos The position of the last newline in the output stream.
      */
     void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+
+    friend class IncrementalEngine;
 };
 
 /**
@@ -293,6 +314,8 @@ public:
      * @param ot The output stream to print to.
      */
     void printExp(std::ostream& ot) override;
+
+    friend class IncrementalEngine;
 };
 
 class LetExpr : public Expr {
@@ -351,6 +374,8 @@ public:
      * @param last_newline_pos The position of the last newline in the output stream.
      */
     void pretty_print_at(std::ostream& ot, precedence_t prec, std::streampos& last_newline_pos) override;
+
+    friend class IncrementalEngine;
 };
 
 /**
@@ -410,6 +435,8 @@ public:
 
 private:
     bool value; // The boolean value (true or false).
+
+    friend class IncrementalEngine;
 };
 
 /**
@@ -444,6 +471,14 @@ public:
      */
     PTR(Val) interp(PTR(Env) env) override;
 
+    /**
+     * @brief Checks a condition's value as interp does.
+     * @param condition The value of the condition.
+     * @return Whether the then branch is taken.
+     * @throws std::runtime_error if the value is not a boolean.
+     */
+    static bool is_taken(PTR(Val) condition);
+
     /**
      * @brief Substitutes a variable with a replacement expression in the if-then-else expression.
      *
@@ -481,6 +516,8 @@ private:
     PTR(Expr) condition;    // The condition expression.
     PTR(Expr) then_branch;  // The expression to evaluate if the condition is true.
     PTR(Expr) else_branch;  // The expression to evaluate if the condition is false.
+
+    friend class IncrementalEngine;
 };
 
 /**
@@ -542,6 +579,8 @@ public:
 private:
     PTR(Expr) lhs; // The left-hand side expression.
     PTR(Expr) rhs; // The right-hand side expression.
+
+    friend class IncrementalEngine;
 };
 
 /**
@@ -598,6 +637,8 @@ public:
      * @param ot The output stream to print to.
      */
     void printExp(std::ostream& ot) override;
+
+    friend class IncrementalEngine;
 };
 
 /**
@@ -654,6 +695,8 @@ public:
      * @param ot The output stream to print to.
      */
     void printExp(std::ostream& ot) override;
+
+    friend class IncrementalEngine;
 };
 
 #endif // EXPR_H
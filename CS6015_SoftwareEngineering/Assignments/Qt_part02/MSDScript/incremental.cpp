@@ -0,0 +1,422 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#include "incremental.h"
+#include "expr.h"
+#include "val.h"
+#include "env.h"
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+static const size_t max_free = 16; // Free variables tracked per node
+
+enum {
+    kind_num,
+    kind_add,
+    kind_mult,
+    kind_var,
+    kind_let,
+    kind_bool,
+    kind_if,
+    kind_eq,
+    kind_fun,
+    kind_call
+};
+
+IncrementalEngine::IncrementalEngine()
+    : current(true), live_after_sweep(0), edit_begin(0), edit_old_end(0), edit_new_end(0), reused_bytes(0) {
+    error = "bad input"; // What parse_str says about an empty program
+}
+
+IncrementalEngine::~IncrementalEngine() = default;
+
+// ====================== Source ======================
+
+void IncrementalEngine::set_text(const std::string& text) {
+    if (text != source) {
+        source = text;
+        current = false;
+    }
+}
+
+void IncrementalEngine::edit(size_t offset, size_t removed, const std::string& inserted) {
+    source.replace(offset, removed, inserted);
+    current = false;
+}
+
+const std::string& IncrementalEngine::text() const {
+    return source;
+}
+
+const IncrementalEngine::Stats& IncrementalEngine::stats() const {
+    return counts;
+}
+
+PTR(Expr) IncrementalEngine::expr() {
+    update();
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    return root->expr;
+}
+
+PTR(Val) IncrementalEngine::interp() {
+    PTR(Expr) e = expr();
+    counts.cached_values = 0;
+    scope.clear(); // A failed evaluation may have left bindings behind
+    return eval(e, Env::empty);
+}
+
+// ====================== Parsing ======================
+
+void IncrementalEngine::update() {
+    if (current) {
+        return;
+    }
+    current = true;
+    counts = Stats();
+
+    // Everything between the common prefix and suffix of the last text that
+    // parsed and this one counts as edited
+    size_t old_size = root ? parsed_source.size() : 0;
+    size_t prefix = 0;
+    if (root) {
+        size_t limit = std::min(old_size, source.size());
+        while (prefix < limit && parsed_source[prefix] == source[prefix]) {
+            prefix++;
+        }
+        size_t suffix = 0;
+        while (suffix < limit - prefix &&
+               parsed_source[old_size - 1 - suffix] == source[source.size() - 1 - suffix]) {
+            suffix++;
+        }
+        edit_old_end = old_size - suffix;
+        edit_new_end = source.size() - suffix;
+    } else {
+        edit_old_end = 0;
+        edit_new_end = source.size();
+    }
+    edit_begin = prefix;
+    reused_bytes = 0;
+
+    // The outermost frame holds the old tree, and collects the new one
+    Region old_top = {old_size, nullptr, {}};
+    if (root) {
+        old_top.children.push_back(Child{0, root});
+    }
+    frames.clear();
+    frames.push_back(Frame{&old_top, 0, 0, std::make_shared<Region>(Region{source.size(), nullptr, {}}), 0});
+
+    std::istringstream in(source);
+    try {
+        parse_observed(in, *this);
+        root = frames[0].fresh->children[0].region;
+        parsed_source = source;
+        error.clear();
+        counts.parsed_bytes = root->length - reused_bytes;
+    } catch (std::runtime_error& e) {
+        error = e.what(); // The last tree that parsed is kept for the next edit
+    }
+    frames.clear();
+    replaced.clear();
+    if (error.empty()) {
+        sweep();
+    }
+}
+
+PTR(Expr) IncrementalEngine::enter(std::streamoff offset, std::streamoff& end) {
+    size_t begin = (size_t)offset;
+    Frame& parent = frames.back();
+
+    // The text from `begin` on is unchanged if it starts before the edit or
+    // after it; find the old region that read it, among the parent's
+    const Region* old = nullptr;
+    size_t old_begin = 0;
+    bool unchanged = begin < edit_begin || begin >= edit_new_end;
+    if (unchanged && parent.old) {
+        size_t wanted = begin < edit_begin ? begin : begin - edit_new_end + edit_old_end;
+        const std::vector<Child>& children = parent.old->children;
+        while (parent.next < children.size() && parent.old_begin + children[parent.next].begin < wanted) {
+            parent.next++;
+        }
+        if (parent.next < children.size() && parent.old_begin + children[parent.next].begin == wanted) {
+            old = children[parent.next].region.get();
+            old_begin = wanted;
+        }
+    }
+
+    // parse_expr peeks at the character after its text, so a region is kept
+    // only if that character was not edited either
+    if (old && (old_begin + old->length < edit_begin || old_begin >= edit_old_end)) {
+        parent.fresh->children.push_back(Child{begin - parent.begin, parent.old->children[parent.next].region});
+        counts.reused_regions++;
+        reused_bytes += old->length;
+        end = (std::streamoff)(begin + old->length);
+        return old->expr;
+    }
+
+    frames.push_back(Frame{old, old_begin, 0, std::make_shared<Region>(Region{0, nullptr, {}}), begin});
+    return nullptr;
+}
+
+void IncrementalEngine::leave(std::streamoff end, PTR(Expr) e) {
+    Frame done = std::move(frames.back());
+    frames.pop_back();
+    done.fresh->length = (size_t)end - done.begin;
+    done.fresh->expr = intern(e);
+    Frame& parent = frames.back();
+    parent.fresh->children.push_back(Child{done.begin - parent.begin, std::move(done.fresh)});
+}
+
+// ====================== Hash-consing ======================
+
+IncrementalEngine::Shape IncrementalEngine::shape_of(PTR(Expr) e) {
+    // Plain casts: this runs for every new node, and CAST copies the pointer
+    Expr* x = &*e;
+    Shape s = {kind_num, "", 0, 0, {nullptr, nullptr, nullptr}};
+    if (NumExpr* n = dynamic_cast<NumExpr*>(x)) {
+        s.value = n->value;
+    } else if (LetExpr* l = dynamic_cast<LetExpr*>(x)) {
+        s = {kind_let, l->var, 0, 2, {l->rhs, l->body, nullptr}};
+    } else if (VarExpr* v = dynamic_cast<VarExpr*>(x)) {
+        s = {kind_var, v->name, 0, 0, {nullptr, nullptr, nullptr}};
+    } else if (AddExpr* a = dynamic_cast<AddExpr*>(x)) {
+        s = {kind_add, "", 0, 2, {a->lhs, a->rhs, nullptr}};
+    } else if (MultExpr* m = dynamic_cast<MultExpr*>(x)) {
+        s = {kind_mult, "", 0, 2, {m->lhs, m->rhs, nullptr}};
+    } else if (CallExpr* c = dynamic_cast<CallExpr*>(x)) {
+        s = {kind_call, "", 0, 2, {c->to_be_called, c->actual_arg, nullptr}};
+    } else if (FunExpr* f = dynamic_cast<FunExpr*>(x)) {
+        s = {kind_fun, f->formal_arg, 0, 1, {f->body, nullptr, nullptr}};
+    } else if (IfExpr* i = dynamic_cast<IfExpr*>(x)) {
+        s = {kind_if, "", 0, 3, {i->condition, i->then_branch, i->else_branch}};
+    } else if (EqExpr* q = dynamic_cast<EqExpr*>(x)) {
+        s = {kind_eq, "", 0, 2, {q->lhs, q->rhs, nullptr}};
+    } else if (BoolExpr* b = dynamic_cast<BoolExpr*>(x)) {
+        s = {kind_bool, "", b->value, 0, {nullptr, nullptr, nullptr}};
+    } else {
+        throw std::runtime_error("unknown expression");
+    }
+    return s;
+}
+
+// Points a freshly parsed node, which nothing else shares yet, at the
+// hash-consed copies of its children
+void IncrementalEngine::set_kids(PTR(Expr) e, const Shape& s) {
+    Expr* x = &*e;
+    switch (s.kind) {
+        case kind_add:
+            static_cast<AddExpr*>(x)->lhs = s.kids[0];
+            static_cast<AddExpr*>(x)->rhs = s.kids[1];
+            break;
+        case kind_mult:
+            static_cast<MultExpr*>(x)->lhs = s.kids[0];
+            static_cast<MultExpr*>(x)->rhs = s.kids[1];
+            break;
+        case kind_let:
+            static_cast<LetExpr*>(x)->rhs = s.kids[0];
+            static_cast<LetExpr*>(x)->body = s.kids[1];
+            break;
+        case kind_if:
+            static_cast<IfExpr*>(x)->condition = s.kids[0];
+            static_cast<IfExpr*>(x)->then_branch = s.kids[1];
+            static_cast<IfExpr*>(x)->else_branch = s.kids[2];
+            break;
+        case kind_eq:
+            static_cast<EqExpr*>(x)->lhs = s.kids[0];
+            static_cast<EqExpr*>(x)->rhs = s.kids[1];
+            break;
+        case kind_fun:
+            static_cast<FunExpr*>(x)->body = s.kids[0];
+            break;
+        case kind_call:
+            static_cast<CallExpr*>(x)->to_be_called = s.kids[0];
+            static_cast<CallExpr*>(x)->actual_arg = s.kids[1];
+            break;
+        default:
+            break; // Leaves have no children
+    }
+}
+
+// Children are compared by address: they are already hash-consed
+bool IncrementalEngine::same(const Shape& a, const Shape& b) {
+    if (a.kind != b.kind || a.name != b.name || a.value != b.value) {
+        return false;
+    }
+    for (int i = 0; i < a.arity; i++) {
+        if (a.kids[i] != b.kids[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t IncrementalEngine::hash_of(const Shape& s) {
+    size_t h = std::hash<int>()(s.kind) ^ std::hash<std::string>()(s.name) * 31 ^ std::hash<int>()(s.value) * 131;
+    for (int i = 0; i < s.arity; i++) {
+        h = h * 1000003 ^ std::hash<const Expr*>()(&*s.kids[i]);
+    }
+    return h;
+}
+
+PTR(Expr) IncrementalEngine::intern(PTR(Expr) e) {
+    if (nodes.count(&*e)) {
+        return e;
+    }
+    auto was = replaced.find(&*e);
+    if (was != replaced.end()) {
+        return was->second.second;
+    }
+
+    Shape s = shape_of(e);
+    bool changed = false;
+    for (int i = 0; i < s.arity; i++) {
+        PTR(Expr) kid = intern(s.kids[i]);
+        changed = changed || kid != s.kids[i];
+        s.kids[i] = kid;
+    }
+
+    size_t h = hash_of(s);
+    auto range = by_hash.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (same(nodes.at(&*it->second).shape, s)) {
+            replaced[&*e] = std::make_pair(e, it->second); // Keeps e alive, so its address is not reused
+            counts.shared_nodes++;
+            return it->second;
+        }
+    }
+
+    // Free variables: a variable's name, less what a _let or _fun binds
+    Node node = {s, h, {}, false, nullptr, false};
+    if (s.kind == kind_var) {
+        node.free.push_back(s.name);
+    }
+    for (int i = 0; i < s.arity; i++) {
+        const Node& kid = nodes.at(&*s.kids[i]);
+        node.too_many = node.too_many || kid.too_many;
+        for (const std::string& name : kid.free) {
+            bool bound = (s.kind == kind_let && i == 1) || s.kind == kind_fun;
+            if (!(bound && name == s.name)) {
+                node.free.push_back(name);
+            }
+        }
+    }
+    std::sort(node.free.begin(), node.free.end());
+    node.free.erase(std::unique(node.free.begin(), node.free.end()), node.free.end());
+    if (node.too_many || node.free.size() > max_free) {
+        node.too_many = true;
+        node.free.clear();
+    }
+
+    if (changed) {
+        set_kids(e, s);
+    }
+    nodes.emplace(&*e, std::move(node));
+    by_hash.emplace(h, e);
+    return e;
+}
+
+// Forgets nodes the current tree no longer uses, once there are as many
+// of them as there are nodes in use
+void IncrementalEngine::sweep() {
+    if (nodes.size() < 2 * live_after_sweep + 1024) {
+        return;
+    }
+    std::vector<PTR(Expr)> pending = {root->expr};
+    while (!pending.empty()) {
+        PTR(Expr) e = pending.back();
+        pending.pop_back();
+        Node& node = nodes.at(&*e);
+        if (node.marked) {
+            continue;
+        }
+        node.marked = true;
+        for (int i = 0; i < node.shape.arity; i++) {
+            pending.push_back(node.shape.kids[i]);
+        }
+    }
+    for (auto it = by_hash.begin(); it != by_hash.end();) {
+        Node& node = nodes.at(&*it->second);
+        if (node.marked) {
+            ++it;
+        } else {
+            nodes.erase(&*it->second);
+            it = by_hash.erase(it);
+        }
+    }
+    for (auto& entry : nodes) {
+        entry.second.marked = false;
+    }
+    live_after_sweep = nodes.size();
+}
+
+// ====================== Evaluation ======================
+
+// interp, except that a closed node's value is computed once
+PTR(Val) IncrementalEngine::eval(PTR(Expr) e, PTR(Env) env) {
+    Node& node = nodes.at(&*e);
+    bool closed = !node.too_many && node.free.empty();
+    if (closed && node.value) {
+        counts.cached_values++;
+        return node.value;
+    }
+
+    // Nothing is interned while evaluating, so node stays put
+    const Shape& s = node.shape;
+    PTR(Val) v;
+    switch (s.kind) {
+        case kind_add: {
+            PTR(Val) lhs = eval(s.kids[0], env);
+            v = AddExpr::add(lhs, eval(s.kids[1], env));
+            break;
+        }
+        case kind_mult: {
+            PTR(Val) lhs = eval(s.kids[0], env);
+            v = MultExpr::multiply(lhs, eval(s.kids[1], env));
+            break;
+        }
+        case kind_var: {
+            auto bound = scope.find(s.name);
+            if (bound == scope.end() || bound->second.empty()) {
+                return env->lookup(s.name); // Throws, as interp does
+            }
+            v = bound->second.back();
+            break;
+        }
+        case kind_let: {
+            PTR(Val) rhs = eval(s.kids[0], env);
+            scope[s.name].push_back(rhs);
+            v = eval(s.kids[1], NEW(ExtendedEnv)(s.name, rhs, env));
+            scope[s.name].pop_back();
+            break;
+        }
+        case kind_if:
+            v = IfExpr::is_taken(eval(s.kids[0], env)) ? eval(s.kids[1], env) : eval(s.kids[2], env);
+            break;
+        case kind_eq: {
+            PTR(Val) lhs = eval(s.kids[0], env);
+            v = NEW(BoolVal)(lhs->equals(eval(s.kids[1], env)));
+            break;
+        }
+        case kind_call: {
+            PTR(Val) fun = eval(s.kids[0], env);
+            v = fun->call(eval(s.kids[1], env));
+            break;
+        }
+        default:
+            v = e->interp(env); // Numbers, booleans and functions
+    }
+    if (closed) {
+        node.value = v;
+    }
+    return v;
+}
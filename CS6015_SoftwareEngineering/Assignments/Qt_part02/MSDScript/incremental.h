@@ -0,0 +1,182 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "pointer.h"
+#include "parse.hpp"
+
+/**
+ * @class IncrementalEngine
+ * @brief Keeps a program parsed and evaluated while its source is edited.
+ *
+ * The engine remembers where every parse_expr call of the last successful
+ * parse started and ended (a region). After an edit it parses the text
+ * again with parse_observed(), but hands back the old tree of every region
+ * that lies wholly before or after the edited span, so only the regions
+ * around the edit (for a chain of `_let`s, the `_let` lines above it) are
+ * read again.
+ *
+ * Every tree node is hash-consed: a newly parsed subtree that is equal to
+ * one the engine already has is replaced by the existing node. The value
+ * of a closed subtree (one without free variables) never changes, so it is
+ * cached on that node; evaluating after an edit reuses the values of every
+ * closed subtree the edit did not touch. Variables are looked up in a
+ * table of the names in scope rather than by walking the Env chain. Calls
+ * run the function body with interp, without either.
+ *
+ * The engine is not thread-safe.
+ */
+class IncrementalEngine : private ParseObserver {
+public:
+    /**
+     * @brief What the last update did, for reporting.
+     */
+    struct Stats {
+        size_t parsed_bytes = 0;   ///< Bytes of source read by the parser.
+        size_t reused_regions = 0; ///< Regions whose old tree was kept without parsing.
+        size_t shared_nodes = 0;   ///< Parsed nodes replaced by an equal existing node.
+        size_t cached_values = 0;  ///< Values taken from the cache by the last interp().
+    };
+
+    IncrementalEngine();
+    ~IncrementalEngine();
+
+    IncrementalEngine(const IncrementalEngine&) = delete;
+    IncrementalEngine& operator=(const IncrementalEngine&) = delete;
+
+    /**
+     * @brief Replaces the whole source; only the span that differs is treated as edited.
+     * @param text The new source.
+     */
+    void set_text(const std::string& text);
+
+    /**
+     * @brief Replaces part of the source.
+     * @param offset Byte offset of the first replaced byte.
+     * @param removed Number of bytes replaced.
+     * @param inserted The bytes replacing them.
+     */
+    void edit(size_t offset, size_t removed, const std::string& inserted);
+
+    /**
+     * @brief The current source.
+     */
+    const std::string& text() const;
+
+    /**
+     * @brief The current program, parsed as parse_str would.
+     * @throws std::runtime_error with the parser's message if the source does not parse.
+     */
+    PTR(Expr) expr();
+
+    /**
+     * @brief Evaluates the current program, as expr()->interp(Env::empty) would.
+     * @throws std::runtime_error if it does not parse or its evaluation fails.
+     */
+    PTR(Val) interp();
+
+    /**
+     * @brief What the last update and interp() did.
+     */
+    const Stats& stats() const;
+
+private:
+    struct Region;
+
+    // Where a region starts, relative to the start of the enclosing one; so
+    // a region and everything in it is kept as it is when the text before
+    // it changes. Regions are never modified once built, and a kept region
+    // is shared between the old and the new tree
+    struct Child {
+        size_t begin;
+        std::shared_ptr<const Region> region;
+    };
+
+    // The text one parse_expr call read
+    struct Region {
+        size_t length;
+        PTR(Expr) expr;
+        std::vector<Child> children; // In source order
+    };
+
+    // A node's kind and fields, with its children separately
+    struct Shape {
+        int kind;
+        std::string name;
+        int value;
+        int arity;
+        PTR(Expr) kids[3];
+    };
+
+    // What the engine knows about a hash-consed node
+    struct Node {
+        Shape shape;
+        size_t hash;
+        std::vector<std::string> free; // Free variables, sorted, unless too_many
+        bool too_many;                 // More free variables than are tracked
+        PTR(Val) value;                // Cached value of a closed node
+        bool marked;                   // Reached from the current tree, while sweeping
+    };
+
+    // An open parse_expr call of the parse in progress
+    struct Frame {
+        const Region* old;  // The old region read from the same text, if any
+        size_t old_begin;   // Its absolute offset in the old text
+        size_t next;        // Its first child not yet passed by the parse
+        std::shared_ptr<Region> fresh;
+        size_t begin;       // Absolute offset in the new text
+    };
+
+    std::string source;
+    std::string parsed_source;            // The text `root` was parsed from
+    std::shared_ptr<const Region> root;   // Null until the text first parses; it starts at 0
+    std::string error;                    // Why `source` does not parse, or empty
+    bool current;                         // Whether `root` and `error` are up to date
+    Stats counts;
+
+    std::unordered_map<const Expr*, Node> nodes;
+    std::unordered_multimap<size_t, PTR(Expr)> by_hash;
+    size_t live_after_sweep;
+
+    // The parse in progress: the edited span in old and new offsets, the
+    // open calls, and parsed nodes that turned out equal to existing ones
+    size_t edit_begin;
+    size_t edit_old_end;
+    size_t edit_new_end;
+    size_t reused_bytes;
+    std::vector<Frame> frames;
+    std::unordered_map<const Expr*, std::pair<PTR(Expr), PTR(Expr)>> replaced;
+
+    // While evaluating: the values bound to each name, innermost last.
+    // Env::lookup walks the whole chain, which makes a long _let chain
+    // quadratic; the chain is still built for the closures
+    std::unordered_map<std::string, std::vector<PTR(Val)>> scope;
+
+    void update();
+    PTR(Expr) enter(std::streamoff begin, std::streamoff& end) override;
+    void leave(std::streamoff end, PTR(Expr) e) override;
+
+    static Shape shape_of(PTR(Expr) e);
+    static void set_kids(PTR(Expr) e, const Shape& s);
+    static bool same(const Shape& a, const Shape& b);
+    static size_t hash_of(const Shape& s);
+    PTR(Expr) intern(PTR(Expr) e);
+    void sweep();
+    PTR(Val) eval(PTR(Expr) e, PTR(Env) env);
+};
+
+#endif // INCREMENTAL_H
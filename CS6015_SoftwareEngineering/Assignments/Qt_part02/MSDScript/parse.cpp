@@ -91,11 +91,7 @@ PTR(Expr) parse_var(std::istream& in) {
 }
 
 PTR(Expr) parse_let(std::istream& in) {
-    skip_whitespace(in);
-    consume(in, '_'); // Consume '_'
-    consume(in, 'l'); // Consume 'l'
-    consume(in, 'e'); // Consume 'e'
-    consume(in, 't'); // Consume 't'
+    // parse_inner has already consumed the "_let" keyword
     skip_whitespace(in);
 
     // Parse the variable name
@@ -160,7 +156,50 @@ PTR(Expr) parse_addend(std::istream& in) {
     return lhs;
 }
 
+// The observer of parse_observed while it runs, or nullptr
+static ParseObserver* observer = nullptr;
+
+// The offset of the next character; tellg fails once a peek has hit the end
+static std::streamoff offset_of(std::istream& in) {
+    if (!in.eof()) {
+        return in.tellg();
+    }
+    in.clear();
+    std::streamoff offset = in.tellg();
+    in.setstate(std::ios::eofbit);
+    return offset;
+}
+
+static PTR(Expr) parse_sum(std::istream& in);
+
 PTR(Expr) parse_expr(std::istream& in) {
+    if (!observer) {
+        return parse_sum(in);
+    }
+    std::streamoff begin = offset_of(in);
+    std::streamoff end;
+    PTR(Expr) reused = observer->enter(begin, end);
+    if (reused) {
+        in.clear();
+        in.seekg(end); // Skip the text the observer already has a tree for
+        return reused;
+    }
+    PTR(Expr) e = parse_sum(in);
+    observer->leave(offset_of(in), e);
+    return e;
+}
+
+PTR(Expr) parse_observed(std::istream& in, ParseObserver& o) {
+    // Restores the previous observer however parsing ends
+    struct Restore {
+        ParseObserver* saved;
+        ~Restore() { observer = saved; }
+    } restore = {observer};
+    observer = &o;
+    return parse_expr(in);
+}
+
+static PTR(Expr) parse_sum(std::istream& in) {
     PTR(Expr) lhs = parse_addend(in);
     skip_whitespace(in);
 
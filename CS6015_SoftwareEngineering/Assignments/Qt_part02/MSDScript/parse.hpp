@@ -50,7 +50,7 @@ PTR(Expr) parse_num(std::istream& in);
 PTR(Expr) parse_var(std::istream& in);
 
 /**
- * @brief Parses a _let expression from the input stream.
+ * @brief Parses a _let expression from the input stream, after its `_let` keyword.
  *
  * @param in The input stream.
  * @return A pointer to a LetExpr object representing the parsed _let expression.
@@ -83,6 +83,47 @@ PTR(Expr) parse_addend(std::istream& in);
  */
 PTR(Expr) parse_expr(std::istream& in);
 
+/**
+ * @class ParseObserver
+ * @brief Sees every parse_expr call made by parse_observed(), with its source offsets.
+ *
+ * parse_expr is the only rule called wherever a complete expression may
+ * start, and what it returns depends only on the text from its start
+ * offset. An observer can therefore record where each expression came
+ * from, and hand back a tree it kept from an earlier parse of the same
+ * text instead of having it parsed again (see IncrementalEngine).
+ */
+class ParseObserver {
+public:
+    virtual ~ParseObserver() = default;
+
+    /**
+     * @brief Called when parse_expr starts.
+     * @param begin Offset of the stream when parse_expr was called.
+     * @param end Set to the offset to continue from when a tree is returned.
+     * @return A tree for the expression at begin, which is then not parsed
+     *         (and leave() is not called for it), or nullptr to parse it.
+     */
+    virtual PTR(Expr) enter(std::streamoff begin, std::streamoff& end) = 0;
+
+    /**
+     * @brief Called when a parse_expr that enter() did not skip returns.
+     * @param end Offset after the expression and the whitespace that follows it.
+     * @param e The parsed expression.
+     */
+    virtual void leave(std::streamoff end, PTR(Expr) e) = 0;
+};
+
+/**
+ * @brief Parses an expression like parse(), reporting each parse_expr call to an observer.
+ *
+ * @param in The input stream; it must support tellg and seekg.
+ * @param observer Sees every parse_expr call, the outermost one last.
+ * @return A pointer to an Expr object representing the parsed expression.
+ * @throws std::runtime_error if the input is invalid.
+ */
+PTR(Expr) parse_observed(std::istream& in, ParseObserver& observer);
+
 /**
  * @brief Parses a boolean value (`_true` or `_false`) from the input stream.
  *
@@ -0,0 +1,208 @@
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Author: Brandon Mountan
+//
+// Date:   10/18/2026
+//
+// Class: CS 6015 - Software Engineering
+//
+//////////////////////////////////////////////////////////////////////////////////
+
+// Tests for IncrementalEngine, without Qt (see test_incremental.pro).
+//
+// Every check compares the engine with parsing and evaluating the whole
+// text from scratch: after each of many random edits to generated
+// programs, expr() must print and interp() must evaluate exactly as
+// parse_str and interp do, including their error messages.
+//
+//   test_incremental [seed]
+
+#include "incremental.h"
+#include "parse.hpp"
+#include "expr.h"
+#include "val.h"
+#include "env.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+static int checks = 0;
+static int failures = 0;
+
+// Reports a failed check, with the text it was about
+static void check(bool ok, const std::string& what, const std::string& text) {
+    checks++;
+    if (ok)
+        return;
+    if (failures++ < 5)
+        std::cerr << "FAILED: " << what << "\n" << text.substr(0, 400) << "\n";
+}
+
+// The program printed, and its value if evaluate, as parsing from scratch gives them
+static std::string from_scratch(const std::string& text, bool evaluate) {
+    try {
+        PTR(Expr) e = parse_str(text);
+        std::string s = e->to_string();
+        if (evaluate)
+            s += " => " + e->interp(Env::empty)->to_string();
+        return s;
+    } catch (std::runtime_error& e) {
+        return std::string("error: ") + e.what();
+    }
+}
+
+// The same, as the engine gives them
+static std::string from_engine(IncrementalEngine& engine, bool evaluate) {
+    try {
+        std::string s = engine.expr()->to_string();
+        if (evaluate)
+            s += " => " + engine.interp()->to_string();
+        return s;
+    } catch (std::runtime_error& e) {
+        return std::string("error: ") + e.what();
+    }
+}
+
+// Checks the engine against parsing from scratch; returns whether its text parsed
+static bool check_same(IncrementalEngine& engine, bool evaluate, const std::string& what) {
+    std::string got = from_engine(engine, evaluate);
+    check(got == from_scratch(engine.text(), evaluate), what, engine.text());
+    return got.compare(0, 6, "error:") != 0;
+}
+
+// A chain of _let lines like the ones typed into the window
+static std::string script(int lines, std::mt19937& rng) {
+    std::ostringstream o;
+    o << "_let sq = _fun (x) x * x _in\n";
+    for (int i = 0; i < lines; i++) {
+        o << "_let v" << char('a' + i % 26) << " = ";
+        switch (rng() % 4) {
+            case 0: o << "(" << rng() % 100 << " + " << rng() % 100 << ") * 2"; break;
+            case 1: o << "sq(" << rng() % 100 << ")"; break;
+            case 2: o << "_if " << rng() % 10 << " == 3 _then 1 _else 2"; break;
+            default: o << (i ? std::string("v") + char('a' + (i - 1) % 26) + " + 1" : "1"); break;
+        }
+        o << " _in\n";
+    }
+    o << "vb + 1\n";
+    return o.str();
+}
+
+// An edit that keeps the program parsing: a changed digit, or a term added
+// to or removed from the start of a right-hand side
+static std::string valid_edit(const std::string& text, std::mt19937& rng) {
+    std::string t = text;
+    size_t digit = t.find_first_of("0123456789", rng() % (t.size() + 1));
+    size_t rhs = t.find("= ", rng() % (t.size() + 1));
+    if (rng() % 3 && digit != std::string::npos) {
+        t.replace(digit, 1, std::to_string(rng() % 10));
+    } else if (rhs != std::string::npos && rng() % 2) {
+        t.insert(rhs + 2, rng() % 2 ? "1 + " : "(2 * 3) == ");
+    } else if (rhs != std::string::npos) {
+        size_t added = t.find("= 1 + ", rhs);
+        if (added != std::string::npos)
+            t.erase(added + 2, 4);
+    }
+    return t;
+}
+
+// Random edits, most of which break the program for a while, through both
+// edit() and set_text()
+static void test_random_edits(std::mt19937& rng) {
+    const char* pieces[] = {"1", "x", " ", "+", "*", "(", ")", "_in", "_let y = 2 _in ", "==", "_if",
+                            "_true", "9", "\n", "vb", "sq(3)", "_fun (z) z"};
+    int parsed = 0;
+    for (int doc = 0; doc < 200; doc++) {
+        IncrementalEngine engine;
+        engine.set_text(script(1 + rng() % 30, rng));
+        for (int step = 0; step < 60; step++) {
+            parsed += check_same(engine, rng() % 2, "random edits");
+            if (rng() % 2) {
+                engine.set_text(valid_edit(engine.text(), rng));
+                continue;
+            }
+            if (rng() % 8)
+                continue;
+            size_t at = rng() % (engine.text().size() + 1);
+            size_t removed = rng() % 3 == 0 ? std::min<size_t>(rng() % 4, engine.text().size() - at) : 0;
+            std::string inserted = rng() % 4 == 0 ? "" : pieces[rng() % (sizeof pieces / sizeof *pieces)];
+            if (rng() % 2) {
+                engine.edit(at, removed, inserted);
+            } else {
+                std::string t = engine.text();
+                t.replace(at, removed, inserted);
+                engine.set_text(t);
+            }
+        }
+    }
+    // Otherwise the comparisons above would mostly be of two parse errors
+    check(parsed > 2000, "most random edits leave a program that parses", std::to_string(parsed));
+}
+
+// A long session on one document, long enough for unused nodes to be swept
+static void test_long_session(std::mt19937& rng) {
+    IncrementalEngine engine;
+    engine.set_text(script(300, rng));
+    for (int step = 0; step < 3000; step++) {
+        engine.set_text(valid_edit(engine.text(), rng));
+        check_same(engine, true, "long session");
+    }
+}
+
+// An edit to a long program reads again only the regions around it (the
+// _let lines above it) and reuses the values of everything else
+static void test_reuse(std::mt19937& rng) {
+    IncrementalEngine engine;
+    std::string text = script(2000, rng);
+    engine.set_text(text);
+    check_same(engine, true, "first parse");
+
+    size_t at = text.find("= ", text.find("_let v")) + 2;
+    engine.edit(at, 0, "(7) + ");
+    check(check_same(engine, true, "edit near the start"), "an edit near the start evaluates", engine.text());
+    const IncrementalEngine::Stats& stats = engine.stats();
+    check(stats.parsed_bytes < 100, "an edit near the start reads only its line",
+          std::to_string(stats.parsed_bytes) + " of " + std::to_string(engine.text().size()) + " bytes");
+    check(stats.reused_regions > 0, "an edit near the start keeps the rest", "");
+    check(stats.cached_values > 1000, "an edit near the start reuses the values after it",
+          std::to_string(stats.cached_values));
+
+    at = engine.text().rfind("_let v");
+    engine.edit(engine.text().find("= ", at) + 2, 0, "(8) + ");
+    check(check_same(engine, true, "edit near the end"), "an edit near the end evaluates", engine.text());
+    check(engine.stats().parsed_bytes < engine.text().size(), "an edit near the end keeps some regions",
+          std::to_string(engine.stats().parsed_bytes));
+}
+
+// Errors come back as from parse_str and interp, and the engine recovers
+// once the text is fixed
+static void test_errors() {
+    IncrementalEngine engine;
+    check_same(engine, true, "empty program");
+    engine.set_text("_let f = _fun (f) _fun (n) f(f)(n) _in f(f)(5)");
+    check(from_engine(engine, true) == "error: maximum call depth exceeded", "runaway recursion",
+          engine.text());
+    engine.set_text("_let x = 1 _in x + ");
+    check_same(engine, true, "incomplete program");
+    engine.edit(engine.text().size(), 0, "2");
+    check(from_engine(engine, true) == "(_let x=1 _in (x+2)) => 3", "fixed program", engine.text());
+    engine.set_text("_if 1 _then 2 _else 3");
+    check_same(engine, true, "non-boolean condition");
+}
+
+int main(int argc, char* argv[]) {
+    std::mt19937 rng(argc > 1 ? std::atoi(argv[1]) : 1);
+    test_errors();
+    test_reuse(rng);
+    test_random_edits(rng);
+    test_long_session(rng);
+    if (failures) {
+        std::cerr << failures << " of " << checks << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All " << checks << " checks passed\n";
+    return 0;
+}
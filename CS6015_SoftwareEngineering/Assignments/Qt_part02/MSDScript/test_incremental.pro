@@ -0,0 +1,20 @@
+# Tests for IncrementalEngine, as a console program without Qt:
+#   qmake test_incremental.pro && make && ./test_incremental
+TEMPLATE = app
+TARGET = test_incremental
+CONFIG += console c++11
+CONFIG -= qt app_bundle
+
+SOURCES += test_incremental.cpp \
+           env.cpp \
+           expr.cpp \
+           incremental.cpp \
+           parse.cpp \
+           val.cpp
+
+HEADERS += env.h \
+           expr.h \
+           incremental.h \
+           parse.hpp \
+           pointer.h \
+           val.h
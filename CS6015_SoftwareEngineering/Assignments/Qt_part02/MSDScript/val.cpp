@@ -123,7 +123,24 @@ bool FunVal::is_true() {
     throw std::runtime_error("Cannot use function as boolean");
 }
 
+int FunVal::max_depth = 1000;
+
+// Calls in progress on this thread
+static thread_local int call_depth = 0;
+
+// Counts a call for as long as it is in progress, even if it throws
+class CallDepth {
+public:
+    CallDepth() {
+        if (call_depth >= FunVal::max_depth)
+            throw std::runtime_error("maximum call depth exceeded");
+        call_depth++;
+    }
+    ~CallDepth() { call_depth--; }
+};
+
 PTR(Val) FunVal::call(PTR(Val) actual_arg) {
+    CallDepth depth;
     PTR(Env) new_env = NEW(ExtendedEnv)(formal_arg, actual_arg, env);
     return body->interp(new_env);
 }
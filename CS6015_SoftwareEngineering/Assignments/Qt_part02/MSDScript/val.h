@@ -293,8 +293,19 @@ public:
      *
      * @param actual_arg The value to apply the function to.
      * @return The result of evaluating the function body with the argument substituted.
+     * @throws std::runtime_error If more than max_depth calls are in progress on this thread.
      */
     PTR(Val) call(PTR(Val) actual_arg) override;
+
+    /**
+     * @brief Most calls that may be in progress at once on one thread.
+     *
+     * Every call nests the evaluator deeper on the native stack, so without a
+     * cap a runaway recursion such as _let f = _fun (f) _fun (n) f(f)(n)
+     * _in f(f)(5) would crash the program instead of reporting an error. The
+     * default leaves room on a 1 MB stack, the smallest a GUI thread gets.
+     */
+    static int max_depth;
 };
 
 #endif // VAL_H
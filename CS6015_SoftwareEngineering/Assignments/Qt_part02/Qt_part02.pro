@@ -3,16 +3,17 @@ TARGET = Qt_part02
 TEMPLATE = app
 
 SOURCES += main.cpp \
+           MSDScript/env.cpp \
            MSDScript/expr.cpp \
+           MSDScript/incremental.cpp \
            MSDScript/parse.cpp \
            MSDScript/val.cpp \
-           mainwindow.cpp \
-           msdscript/env.cpp
+           mainwindow.cpp
 
 HEADERS += mainwindow.h \
            MSDScript/env.h \
            MSDScript/expr.h \
+           MSDScript/incremental.h \
            MSDScript/parse.hpp \
-           MSDScript/val.h \
-           msdscript/env.h \
-           msdscript/parse.h
+           MSDScript/pointer.h \
+           MSDScript/val.h
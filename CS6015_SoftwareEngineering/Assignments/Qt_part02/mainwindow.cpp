@@ -3,6 +3,7 @@
 #include "MSDScript/expr.h"
 #include "MSDScript/val.h"
 #include <QMessageBox>
+#include <QElapsedTimer>
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent)
 {
@@ -31,6 +32,8 @@ void MainWindow::setupUI()
     outputEdit = new QTextEdit();
     outputEdit->setReadOnly(true);
     outputLayout->addWidget(outputEdit);
+    statusLabel = new QLabel(this);
+    outputLayout->addWidget(statusLabel);
     outputGroup->setLayout(outputLayout);
 
     // Buttons
@@ -48,6 +51,11 @@ void MainWindow::setupUI()
     mainLayout->addLayout(buttonLayout);
 
     setCentralWidget(centralWidget);
+
+    // Restarted by every edit, so a burst of keystrokes evaluates only once
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    updateTimer->setInterval(250);
 }
 
 void MainWindow::setupConnections()
@@ -55,14 +63,15 @@ void MainWindow::setupConnections()
     connect(interpretButton, &QPushButton::clicked, this, &MainWindow::interpretExpression);
     connect(printButton, &QPushButton::clicked, this, &MainWindow::printExpression);
     connect(loadButton, &QPushButton::clicked, this, &MainWindow::loadFromFile);
+    connect(inputEdit, &QTextEdit::textChanged, this, [this]() { updateTimer->start(); });
+    connect(updateTimer, &QTimer::timeout, this, &MainWindow::updateResult);
 }
 
 void MainWindow::interpretExpression()
 {
     try {
-        std::string input = inputEdit->toPlainText().toUtf8().constData();
-        PTR(Expr) e = parse_str(input);
-        PTR(Val) v = e->interp(Env::empty); // Changed to use interp() without Env parameter
+        engine.set_text(inputEdit->toPlainText().toUtf8().constData());
+        PTR(Val) v = engine.interp();
         outputEdit->setText(QString::fromStdString(v->to_string()));
     } catch (std::runtime_error &e) {
         QMessageBox::critical(this, "Error", e.what());
@@ -72,8 +81,8 @@ void MainWindow::interpretExpression()
 void MainWindow::printExpression()
 {
     try {
-        std::string input = inputEdit->toPlainText().toUtf8().constData();
-        PTR(Expr) e = parse_str(input);
+        engine.set_text(inputEdit->toPlainText().toUtf8().constData());
+        PTR(Expr) e = engine.expr();
         outputEdit->setText(QString::fromStdString(e->to_pretty_string()));
     } catch (std::runtime_error &e) {
         QMessageBox::critical(this, "Error", e.what());
@@ -94,3 +103,24 @@ void MainWindow::loadFromFile()
         }
     }
 }
+
+// Shows the result once typing pauses; errors go to the output rather than
+// a message box, since most partial edits do not parse
+void MainWindow::updateResult()
+{
+    QElapsedTimer timer;
+    timer.start();
+    engine.set_text(inputEdit->toPlainText().toUtf8().constData());
+    try {
+        PTR(Val) v = engine.interp();
+        outputEdit->setText(QString::fromStdString(v->to_string()));
+    } catch (std::runtime_error &e) {
+        outputEdit->setText(QString("Error: ") + e.what());
+    }
+    const IncrementalEngine::Stats &stats = engine.stats();
+    statusLabel->setText(QString("Updated in %1 ms (parsed %2 bytes, reused %3 subexpressions and %4 values)")
+                             .arg(timer.elapsed())
+                             .arg(stats.parsed_bytes)
+                             .arg(stats.reused_regions)
+                             .arg(stats.cached_values));
+}
@@ -9,6 +9,8 @@
 #include <QFileDialog>
 #include <QLabel>
 #include <QGroupBox>
+#include <QTimer>
+#include "MSDScript/incremental.h"
 
 class MainWindow : public QMainWindow
 {
@@ -21,6 +23,7 @@ private slots:
     void interpretExpression();
     void printExpression();
     void loadFromFile();
+    void updateResult();
 
 private:
     void setupUI();
@@ -31,6 +34,10 @@ private:
     QPushButton *interpretButton;
     QPushButton *printButton;
     QPushButton *loadButton;
+    QLabel *statusLabel;
+    QTimer *updateTimer; // Delays updateResult until typing pauses
+
+    IncrementalEngine engine; // Re-evaluates only what each edit changed
 };
 
 #endif // MAINWINDOW_H